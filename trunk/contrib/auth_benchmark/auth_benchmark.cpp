@@ -0,0 +1,1043 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <ace/ACE.h>
+#include <ace/OS_NS_sys_time.h>
+#include <ace/OS_NS_signal.h>
+#include <ace/Reactor.h>
+#include <ace/Reactor_Impl.h>
+#include <ace/Select_Reactor.h>
+#include <ace/Dev_Poll_Reactor.h>
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/SOCK_Connector.h>
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "Auth/BigNumber.h"
+#include "Auth/Sha1.h"
+#include "Auth/AuthCrypt.h"
+#include "Opcodes.h"
+#include "SharedDefines.h"
+
+//=======================================================
+/**
+Load generator for realmd and mangosd logins. Each simulated client does the logon challenge/proof
+SRP6 exchange and requests the realm list from realmd, then connects to mangosd and does the
+CMSG_AUTH_SESSION handshake with the session key. Optionally it logs in a character (created if
+the account has none) and sends idle (ping), movement or chat traffic.
+
+All clients are driven by one reactor thread, the given number of logins are in progress at once.
+*/
+
+enum BenchTraffic
+{
+    TRAFFIC_NONE,                                           // disconnect after world handshake
+    TRAFFIC_IDLE,                                           // only ping
+    TRAFFIC_MOVEMENT,
+    TRAFFIC_CHAT
+};
+
+struct BenchConfig
+{
+    std::string realmAddress;
+    std::string worldAddress;                               // empty: realmd logins only
+    std::string accountPrefix;
+    std::string password;
+    uint32 firstAccount;
+    uint32 clientCount;
+    uint32 concurrency;
+    uint16 build;
+    BenchTraffic traffic;
+    uint32 duration;                                        // steady state traffic, in seconds
+};
+
+static BenchConfig g_config;
+
+uint64 getTimeUs()
+{
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    return uint64(now.sec()) * 1000000 + now.usec();
+}
+
+//=======================================================
+// results
+
+enum BenchStage
+{
+    STAGE_REALM_CONNECT,
+    STAGE_REALM_CHALLENGE,
+    STAGE_REALM_PROOF,
+    STAGE_REALM_LIST,
+    STAGE_WORLD_CONNECT,
+    STAGE_WORLD_CHALLENGE,
+    STAGE_WORLD_AUTH,
+    STAGE_CHAR_ENUM,
+    STAGE_CHAR_CREATE,
+    STAGE_PLAYER_LOGIN,
+    STAGE_IN_WORLD,
+    STAGE_DONE,
+    MAX_BENCH_STAGE
+};
+
+static char const* g_stageNames[MAX_BENCH_STAGE] =
+{
+    "realm connect", "realm challenge", "realm proof", "realm list", "world connect", "world challenge",
+    "world auth", "char enum", "char create", "player login", "in world", "done"
+};
+
+struct BenchStats
+{
+    std::vector<uint32> realmLogin;                         // connect to realm list received, us
+    std::vector<uint32> worldLogin;                         // world connect to AUTH_OK, us
+    std::vector<uint32> enterWorld;                         // AUTH_OK to SMSG_LOGIN_VERIFY_WORLD, us
+    std::vector<uint32> pingRtt;                            // CMSG_PING to SMSG_PONG in steady state, us
+    uint32 failed[MAX_BENCH_STAGE];
+    uint64 firstLoginStart;
+    uint64 lastLoginEnd;
+    uint64 sentPackets;
+    uint64 receivedPackets;
+    uint64 receivedBytes;
+};
+
+static BenchStats g_stats;
+
+void printLatency(char const* name, std::vector<uint32>& times)
+{
+    if(times.empty())
+    {
+        printf("%-14s no samples\n", name);
+        return;
+    }
+
+    std::sort(times.begin(), times.end());
+
+    uint64 total = 0;
+    for(size_t i = 0; i < times.size(); ++i)
+        total += times[i];
+
+    printf("%-14s %8u samples, avg %8.2f ms, p50 %8.2f ms, p90 %8.2f ms, p99 %8.2f ms, max %8.2f ms\n", name,
+        uint32(times.size()), double(total) / times.size() / 1000.0,
+        times[times.size() * 50 / 100] / 1000.0, times[times.size() * 90 / 100] / 1000.0,
+        times[times.size() * 99 / 100] / 1000.0, times.back() / 1000.0);
+}
+
+//=======================================================
+// client
+
+#define REALM_CHALLENGE_RESPONSE_SIZE 119
+#define REALM_PROOF_RESPONSE_SIZE 32
+#define MOVEMENTFLAG_FORWARD 0x00000001                     // see Unit.h
+
+class BenchClient : public ACE_Event_Handler
+{
+    public:
+        BenchClient(uint32 index, ACE_Reactor* reactor);
+        ~BenchClient();
+
+        bool StartLogin();
+        void Update(uint64 now);
+        void Close();
+
+        BenchStage GetStage() const { return m_stage; }
+        bool IsLoginFinished() const { return m_stage >= STAGE_IN_WORLD || m_failed; }
+        bool IsFailed() const { return m_failed; }
+
+        ACE_HANDLE get_handle() const { return m_peer.get_handle(); }
+        int handle_input(ACE_HANDLE);
+
+    private:
+        bool Connect(std::string const& address);
+        void Fail(char const* reason);
+        bool Send(uint8 const* data, size_t size);
+
+        // realmd part
+        void SendLogonChallenge();
+        bool HandleRealmData();
+        bool HandleLogonChallenge();
+        bool HandleLogonProof();
+
+        // mangosd part
+        bool HandleWorldData();
+        bool HandleWorldPacket(uint16 opcode, ByteBuffer& packet);
+        void SendWorldPacket(uint32 opcode, ByteBuffer const& body);
+        void SendAuthSession(uint32 serverSeed);
+        void SendMovement(uint32 opcode);
+        void EncryptHeader(uint8* header);
+        void DecryptHeader(uint8* header);
+
+        uint32 m_index;
+        std::string m_account;
+        BenchStage m_stage;
+        bool m_failed;
+        ACE_SOCK_Stream m_peer;
+        std::vector<uint8> m_inBuffer;
+
+        uint64 m_stageStart;
+        BigNumber m_a, m_A, m_B, m_K, m_M;
+
+        bool m_crypt;
+        bool m_headerDecrypted;
+        uint8 m_key[SHA_DIGEST_LENGTH];
+        uint8 m_send_i, m_send_j, m_recv_i, m_recv_j;
+
+        uint32 m_map;
+        float m_x, m_y, m_z, m_o;
+        uint32 m_moveStep;
+        uint64 m_nextAction;
+        uint64 m_nextPing;
+        uint32 m_pingSeq;
+        uint64 m_pingSent;
+};
+
+BenchClient::BenchClient(uint32 index, ACE_Reactor* reactor) : m_index(index), m_stage(STAGE_REALM_CONNECT),
+m_failed(false), m_stageStart(0), m_crypt(false), m_headerDecrypted(false),
+m_send_i(0), m_send_j(0), m_recv_i(0), m_recv_j(0),
+m_map(0), m_x(0.0f), m_y(0.0f), m_z(0.0f), m_o(0.0f), m_moveStep(0), m_nextAction(0), m_nextPing(0),
+m_pingSeq(0), m_pingSent(0)
+{
+    this->reactor(reactor);
+
+    char buf[64];
+    sprintf(buf, "%s%u", g_config.accountPrefix.c_str(), g_config.firstAccount + index);
+    m_account = buf;
+    std::transform(m_account.begin(), m_account.end(), m_account.begin(), toupper);
+}
+
+BenchClient::~BenchClient()
+{
+    Close();
+}
+
+bool BenchClient::Connect(std::string const& address)
+{
+    ACE_INET_Addr addr(address.c_str());
+    ACE_SOCK_Connector connector;
+    ACE_Time_Value timeout(10);
+    if(connector.connect(m_peer, addr, &timeout) == -1)
+    {
+        Fail("connect");
+        return false;
+    }
+
+    m_inBuffer.clear();
+    if(reactor()->register_handler(this, ACE_Event_Handler::READ_MASK) == -1)
+    {
+        Fail("register");
+        return false;
+    }
+    return true;
+}
+
+void BenchClient::Close()
+{
+    if(m_peer.get_handle() == ACE_INVALID_HANDLE)
+        return;
+
+    reactor()->remove_handler(this, ACE_Event_Handler::ALL_EVENTS_MASK | ACE_Event_Handler::DONT_CALL);
+    m_peer.close();
+}
+
+void BenchClient::Fail(char const* reason)
+{
+    if(m_failed)
+        return;
+
+    if(g_stats.failed[m_stage] < 10)
+        printf("%s failed at %s: %s\n", m_account.c_str(), g_stageNames[m_stage], reason);
+
+    ++g_stats.failed[m_stage];
+    m_failed = true;
+    Close();
+}
+
+bool BenchClient::Send(uint8 const* data, size_t size)
+{
+    if(m_peer.send_n(data, size) != ssize_t(size))
+    {
+        Fail("send");
+        return false;
+    }
+    ++g_stats.sentPackets;
+    return true;
+}
+
+bool BenchClient::StartLogin()
+{
+    m_stageStart = getTimeUs();
+    if(!g_stats.firstLoginStart)
+        g_stats.firstLoginStart = m_stageStart;
+
+    if(!Connect(g_config.realmAddress))
+        return false;
+
+    SendLogonChallenge();
+    return !m_failed;
+}
+
+int BenchClient::handle_input(ACE_HANDLE)
+{
+    uint8 buf[4096];
+    ssize_t n = m_peer.recv(buf, sizeof(buf));
+    if(n <= 0)
+    {
+        Fail(n == 0 ? "connection closed by server" : "recv");
+        return 0;
+    }
+
+    g_stats.receivedBytes += n;
+    m_inBuffer.insert(m_inBuffer.end(), buf, buf + n);
+
+    if(m_stage < STAGE_WORLD_CONNECT)
+        HandleRealmData();
+    else
+        HandleWorldData();
+    return 0;
+}
+
+//=======================================================
+// realmd part, see AuthSocket for server side
+
+void BenchClient::SendLogonChallenge()
+{
+    m_stage = STAGE_REALM_CHALLENGE;
+
+    ByteBuffer pkt;
+    pkt << uint8(0);                                        // AUTH_LOGON_CHALLENGE
+    pkt << uint8(3);
+    pkt << uint16(0);                                       // size, set below
+    pkt << uint8('W') << uint8('o') << uint8('W') << uint8(0);
+    pkt << uint8(2) << uint8(4) << uint8(3);                // version
+    pkt << uint16(g_config.build);
+    pkt << uint8('6') << uint8('8') << uint8('x') << uint8(0);
+    pkt << uint8('n') << uint8('i') << uint8('W') << uint8(0);
+    pkt << uint8('S') << uint8('U') << uint8('n') << uint8('e');
+    pkt << uint32(0);                                       // timezone bias
+    pkt << uint32(0x0100007F);                              // ip
+    pkt << uint8(m_account.size());
+    pkt.append(m_account.c_str(), m_account.size());
+    pkt.put<uint16>(2, uint16(pkt.size() - 4));
+
+    Send(pkt.contents(), pkt.size());
+}
+
+bool BenchClient::HandleRealmData()
+{
+    while(!m_failed && !m_inBuffer.empty())
+    {
+        switch(m_stage)
+        {
+            case STAGE_REALM_CHALLENGE:
+                if(m_inBuffer.size() >= 3 && m_inBuffer[2] != 0)
+                {
+                    Fail("challenge refused");
+                    return false;
+                }
+                if(m_inBuffer.size() < REALM_CHALLENGE_RESPONSE_SIZE)
+                    return true;
+                if(!HandleLogonChallenge())
+                    return false;
+                m_inBuffer.erase(m_inBuffer.begin(), m_inBuffer.begin() + REALM_CHALLENGE_RESPONSE_SIZE);
+                break;
+            case STAGE_REALM_PROOF:
+                if(m_inBuffer.size() >= 2 && m_inBuffer[1] != 0)
+                {
+                    Fail("wrong password or account");
+                    return false;
+                }
+                if(m_inBuffer.size() < REALM_PROOF_RESPONSE_SIZE)
+                    return true;
+                if(!HandleLogonProof())
+                    return false;
+                m_inBuffer.erase(m_inBuffer.begin(), m_inBuffer.begin() + REALM_PROOF_RESPONSE_SIZE);
+                break;
+            case STAGE_REALM_LIST:
+            {
+                if(m_inBuffer.size() < 3)
+                    return true;
+                size_t size = 3 + (m_inBuffer[1] | (m_inBuffer[2] << 8));
+                if(m_inBuffer.size() < size)
+                    return true;
+
+                uint64 now = getTimeUs();
+                g_stats.realmLogin.push_back(uint32(now - m_stageStart));
+                Close();
+
+                if(g_config.worldAddress.empty())
+                {
+                    g_stats.lastLoginEnd = now;
+                    m_stage = STAGE_DONE;
+                    return true;
+                }
+
+                m_stage = STAGE_WORLD_CONNECT;
+                m_stageStart = now;
+                if(Connect(g_config.worldAddress))
+                    m_stage = STAGE_WORLD_CHALLENGE;
+                return true;
+            }
+            default:
+                Fail("unexpected realm data");
+                return false;
+        }
+    }
+    return true;
+}
+
+bool BenchClient::HandleLogonChallenge()
+{
+    uint8 const* data = &m_inBuffer[0];
+
+    BigNumber g, N, s;
+    m_B.SetBinary(data + 3, 32);
+    g.SetBinary(data + 36, 1);
+    N.SetBinary(data + 38, 32);
+    s.SetBinary(data + 70, 32);
+
+    // x = H(s, H(I:P)), see AuthSocket::_SetVSFields
+    std::string password = g_config.password;
+    std::transform(password.begin(), password.end(), password.begin(), toupper);
+
+    Sha1Hash sha;
+    sha.UpdateData(m_account);
+    sha.UpdateData((uint8 const*)":", 1);
+    sha.UpdateData(password);
+    sha.Finalize();
+    uint8 passHash[SHA_DIGEST_LENGTH];
+    memcpy(passHash, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
+    sha.UpdateData(passHash, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+    m_a.SetRand(19 * 8);
+    m_A = g.ModExp(m_a, N);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&m_A, &m_B, NULL);
+    sha.Finalize();
+    BigNumber u;
+    u.SetBinary(sha.GetDigest(), 20);
+
+    // S = (B - 3 * g^x) ^ (a + u * x)
+    BigNumber k;
+    k.SetDword(3);
+    BigNumber kv = (k * g.ModExp(x, N)) % N;
+    BigNumber base = (m_B + N - kv) % N;
+    BigNumber S = base.ModExp(m_a + u * x, N);
+
+    // session key, interleaved hashes of S halves as in AuthSocket::_HandleLogonProof
+    uint8 t[32];
+    uint8 t1[16];
+    uint8 vK[40];
+    memcpy(t, S.AsByteArray(32), 32);
+    for(int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2];
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for(int i = 0; i < 20; ++i)
+        vK[i * 2] = sha.GetDigest()[i];
+    for(int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2 + 1];
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for(int i = 0; i < 20; ++i)
+        vK[i * 2 + 1] = sha.GetDigest()[i];
+    m_K.SetBinary(vK, 40);
+
+    uint8 hash[20];
+    sha.Initialize();
+    sha.UpdateBigNumbers(&N, NULL);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+    sha.Initialize();
+    sha.UpdateBigNumbers(&g, NULL);
+    sha.Finalize();
+    for(int i = 0; i < 20; ++i)
+        hash[i] ^= sha.GetDigest()[i];
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(m_account);
+    sha.Finalize();
+    uint8 t4[SHA_DIGEST_LENGTH];
+    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, NULL);
+    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+    sha.UpdateBigNumbers(&s, &m_A, &m_B, &m_K, NULL);
+    sha.Finalize();
+    m_M.SetBinary(sha.GetDigest(), 20);
+
+    ByteBuffer pkt;
+    pkt << uint8(1);                                        // AUTH_LOGON_PROOF
+    pkt.append(m_A.AsByteArray(32), 32);
+    pkt.append(sha.GetDigest(), 20);
+    for(int i = 0; i < 20; ++i)
+        pkt << uint8(0);                                    // crc hash
+    pkt << uint8(0);                                        // number of keys
+    pkt << uint8(0);
+
+    m_stage = STAGE_REALM_PROOF;
+    return Send(pkt.contents(), pkt.size());
+}
+
+bool BenchClient::HandleLogonProof()
+{
+    Sha1Hash sha;
+    sha.UpdateBigNumbers(&m_A, &m_M, &m_K, NULL);
+    sha.Finalize();
+    if(memcmp(sha.GetDigest(), &m_inBuffer[2], 20))
+    {
+        Fail("server proof mismatch");
+        return false;
+    }
+
+    uint8 pkt[5] = { 0x10, 0, 0, 0, 0 };                    // REALM_LIST
+    m_stage = STAGE_REALM_LIST;
+    return Send(pkt, sizeof(pkt));
+}
+
+//=======================================================
+// mangosd part, see WorldSocket for server side
+
+// client side of AuthCrypt: 6 bytes client headers encrypted, 4 bytes server headers decrypted
+void BenchClient::EncryptHeader(uint8* header)
+{
+    for(int t = 0; t < 6; ++t)
+    {
+        m_send_i %= SHA_DIGEST_LENGTH;
+        uint8 x = (header[t] ^ m_key[m_send_i]) + m_send_j;
+        ++m_send_i;
+        header[t] = m_send_j = x;
+    }
+}
+
+void BenchClient::DecryptHeader(uint8* header)
+{
+    for(int t = 0; t < 4; ++t)
+    {
+        m_recv_i %= SHA_DIGEST_LENGTH;
+        uint8 x = (header[t] - m_recv_j) ^ m_key[m_recv_i];
+        ++m_recv_i;
+        m_recv_j = header[t];
+        header[t] = x;
+    }
+}
+
+void BenchClient::SendWorldPacket(uint32 opcode, ByteBuffer const& body)
+{
+    std::vector<uint8> pkt(6 + body.size());
+    uint16 size = uint16(body.size() + 4);
+    pkt[0] = uint8(size >> 8);
+    pkt[1] = uint8(size);
+    pkt[2] = uint8(opcode);
+    pkt[3] = uint8(opcode >> 8);
+    pkt[4] = uint8(opcode >> 16);
+    pkt[5] = uint8(opcode >> 24);
+    if(body.size())
+        memcpy(&pkt[6], body.contents(), body.size());
+
+    if(m_crypt)
+        EncryptHeader(&pkt[0]);
+
+    Send(&pkt[0], pkt.size());
+}
+
+bool BenchClient::HandleWorldData()
+{
+    while(!m_failed && m_inBuffer.size() >= 4)
+    {
+        if(!m_headerDecrypted)
+        {
+            if(m_crypt)
+                DecryptHeader(&m_inBuffer[0]);
+            m_headerDecrypted = true;
+        }
+
+        size_t size = (m_inBuffer[0] << 8) | m_inBuffer[1];
+        if(size < 2)
+        {
+            Fail("wrong packet size");
+            return false;
+        }
+        if(m_inBuffer.size() < 2 + size)
+            return true;
+
+        uint16 opcode = m_inBuffer[2] | (m_inBuffer[3] << 8);
+        ByteBuffer packet;
+        if(size > 2)
+            packet.append(&m_inBuffer[4], size - 2);
+
+        m_inBuffer.erase(m_inBuffer.begin(), m_inBuffer.begin() + 2 + size);
+        m_headerDecrypted = false;
+        ++g_stats.receivedPackets;
+
+        if(!HandleWorldPacket(opcode, packet))
+            return false;
+    }
+    return true;
+}
+
+void BenchClient::SendAuthSession(uint32 serverSeed)
+{
+    uint32 clientSeed = rand();
+    uint32 t = 0;
+
+    Sha1Hash sha;
+    sha.UpdateData(m_account);
+    sha.UpdateData((uint8*)&t, 4);
+    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&serverSeed, 4);
+    sha.UpdateBigNumbers(&m_K, NULL);
+    sha.Finalize();
+
+    // no addon data, server skips addon packet then
+    ByteBuffer body;
+    body << uint32(g_config.build);
+    body << uint32(0);
+    body << m_account;
+    body << clientSeed;
+    body.append(sha.GetDigest(), 20);
+
+    SendWorldPacket(CMSG_AUTH_SESSION, body);
+
+    // server init crypt before its answer
+    AuthCrypt::GenerateKey(m_key, &m_K);
+    m_crypt = true;
+    m_stage = STAGE_WORLD_AUTH;
+}
+
+bool BenchClient::HandleWorldPacket(uint16 opcode, ByteBuffer& packet)
+{
+    switch(opcode)
+    {
+        case SMSG_AUTH_CHALLENGE:
+        {
+            if(m_stage != STAGE_WORLD_CHALLENGE || packet.size() < 4)
+                break;
+            uint32 seed;
+            packet >> seed;
+            SendAuthSession(seed);
+            break;
+        }
+        case SMSG_AUTH_RESPONSE:
+        {
+            if(m_stage != STAGE_WORLD_AUTH || packet.size() < 1)
+                break;
+            uint8 code;
+            packet >> code;
+            if(code == AUTH_WAIT_QUEUE)
+                break;
+            if(code != AUTH_OK)
+            {
+                Fail("auth session refused");
+                return false;
+            }
+
+            uint64 now = getTimeUs();
+            g_stats.worldLogin.push_back(uint32(now - m_stageStart));
+            g_stats.lastLoginEnd = now;
+            m_stageStart = now;
+
+            if(g_config.traffic == TRAFFIC_NONE)
+            {
+                m_stage = STAGE_DONE;
+                Close();
+                return true;
+            }
+
+            m_stage = STAGE_CHAR_ENUM;
+            SendWorldPacket(CMSG_CHAR_ENUM, ByteBuffer());
+            break;
+        }
+        case SMSG_CHAR_ENUM:
+        {
+            if(m_stage != STAGE_CHAR_ENUM || packet.size() < 1)
+                break;
+            uint8 count;
+            packet >> count;
+            if(count && packet.size() >= 9)
+            {
+                uint64 guid;
+                packet >> guid;
+
+                ByteBuffer body;
+                body << guid;
+                m_stage = STAGE_PLAYER_LOGIN;
+                SendWorldPacket(CMSG_PLAYER_LOGIN, body);
+                break;
+            }
+
+            // player name allow only letters
+            std::string name = "Bench";
+            for(uint32 i = g_config.firstAccount + m_index; ; i /= 26)
+            {
+                name += char('a' + i % 26);
+                if(i < 26)
+                    break;
+            }
+
+            ByteBuffer body;
+            body << name;
+            body << uint8(RACE_HUMAN) << uint8(CLASS_WARRIOR) << uint8(GENDER_MALE);
+            body << uint8(0) << uint8(0) << uint8(0) << uint8(0) << uint8(0) << uint8(0);
+            m_stage = STAGE_CHAR_CREATE;
+            SendWorldPacket(CMSG_CHAR_CREATE, body);
+            break;
+        }
+        case SMSG_CHAR_CREATE:
+        {
+            if(m_stage != STAGE_CHAR_CREATE || packet.size() < 1)
+                break;
+            uint8 code;
+            packet >> code;
+            if(code != CHAR_CREATE_SUCCESS)
+            {
+                Fail("character create refused");
+                return false;
+            }
+            m_stage = STAGE_CHAR_ENUM;
+            SendWorldPacket(CMSG_CHAR_ENUM, ByteBuffer());
+            break;
+        }
+        case SMSG_LOGIN_VERIFY_WORLD:
+        {
+            if(m_stage != STAGE_PLAYER_LOGIN || packet.size() < 20)
+                break;
+            packet >> m_map >> m_x >> m_y >> m_z >> m_o;
+
+            uint64 now = getTimeUs();
+            g_stats.enterWorld.push_back(uint32(now - m_stageStart));
+            m_stage = STAGE_IN_WORLD;
+
+            // spread traffic of clients
+            m_nextAction = now + (rand() % 1000) * 1000;
+            m_nextPing = now + (rand() % 30000) * 1000;
+            break;
+        }
+        case SMSG_PONG:
+            if(m_pingSent)
+            {
+                g_stats.pingRtt.push_back(uint32(getTimeUs() - m_pingSent));
+                m_pingSent = 0;
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+void BenchClient::SendMovement(uint32 opcode)
+{
+    ByteBuffer body;
+    body << uint32(opcode == MSG_MOVE_STOP ? 0 : MOVEMENTFLAG_FORWARD);
+    body << uint8(0);
+    body << uint32(getTimeUs() / 1000);
+    body << m_x << m_y << m_z << m_o;
+    body << uint32(0);                                      // fall time
+
+    SendWorldPacket(opcode, body);
+}
+
+// traffic of clients in world, walk forth and back or say something in intervals, ping for latency
+void BenchClient::Update(uint64 now)
+{
+    if(m_failed || m_stage != STAGE_IN_WORLD)
+        return;
+
+    if(now >= m_nextPing && !m_pingSent)
+    {
+        ByteBuffer body;
+        body << uint32(++m_pingSeq);
+        body << uint32(0);                                  // latency
+        m_pingSent = now;
+        m_nextPing = now + 30 * 1000000;
+        SendWorldPacket(CMSG_PING, body);
+    }
+
+    if(now < m_nextAction)
+        return;
+
+    switch(g_config.traffic)
+    {
+        case TRAFFIC_MOVEMENT:
+        {
+            // heartbeat each 500 ms at run speed, turn around after 10 steps
+            uint32 step = m_moveStep++ % 12;
+            if(step == 0)
+                SendMovement(MSG_MOVE_START_FORWARD);
+            else if(step < 11)
+            {
+                m_x += 3.5f * cos(m_o);
+                m_y += 3.5f * sin(m_o);
+                SendMovement(MSG_MOVE_HEARTBEAT);
+            }
+            else
+            {
+                SendMovement(MSG_MOVE_STOP);
+                m_o = m_o < 3.14f ? m_o + 3.14159f : m_o - 3.14159f;
+            }
+            m_nextAction = now + 500000;
+            break;
+        }
+        case TRAFFIC_CHAT:
+        {
+            ByteBuffer body;
+            body << uint32(CHAT_MSG_SAY);
+            body << uint32(LANG_UNIVERSAL);
+            body << std::string("auth_benchmark chat traffic");
+            SendWorldPacket(CMSG_MESSAGECHAT, body);
+            m_nextAction = now + 5 * 1000000;
+            break;
+        }
+        default:
+            m_nextAction = now + 30 * 1000000;
+            break;
+    }
+}
+
+//=======================================================
+
+static bool g_stop = false;
+
+void onSignal(int)
+{
+    g_stop = true;
+}
+
+void usage()
+{
+    printf("Usage: auth_benchmark sql <account prefix> <count> [password] [first]\n");
+    printf("       auth_benchmark run [options]\n");
+    printf("  -r host:port   realmd address (default 127.0.0.1:3724)\n");
+    printf("  -w host:port   mangosd address, without it only realmd logins done\n");
+    printf("  -a prefix      account name prefix (default BENCH)\n");
+    printf("  -p password    password of all accounts (default BENCH)\n");
+    printf("  -o first       number of first account (default 1)\n");
+    printf("  -n count       number of clients (default 1000)\n");
+    printf("  -c count       logins in progress at once (default 100)\n");
+    printf("  -b build       client build (default 8606)\n");
+    printf("  -t traffic     none|idle|movement|chat after world login (default none)\n");
+    printf("  -d seconds     traffic duration after all logins (default 60)\n");
+}
+
+// accounts for run, sha_pass_hash as set by account create command
+int printAccountsSql(int argc, char** argv)
+{
+    if(argc < 4)
+    {
+        usage();
+        return 1;
+    }
+
+    std::string prefix = argv[2];
+    uint32 count = atoi(argv[3]);
+    std::string password = argc > 4 ? argv[4] : "BENCH";
+    uint32 first = argc > 5 ? atoi(argv[5]) : 1;
+    std::transform(prefix.begin(), prefix.end(), prefix.begin(), toupper);
+    std::transform(password.begin(), password.end(), password.begin(), toupper);
+
+    for(uint32 i = first; i < first + count; ++i)
+    {
+        char name[64];
+        sprintf(name, "%s%u", prefix.c_str(), i);
+
+        Sha1Hash sha;
+        sha.UpdateData(std::string(name));
+        sha.UpdateData((uint8 const*)":", 1);
+        sha.UpdateData(password);
+        sha.Finalize();
+
+        printf("INSERT IGNORE INTO account (username, sha_pass_hash, expansion) VALUES ('%s', '", name);
+        for(int j = 0; j < SHA_DIGEST_LENGTH; ++j)
+            printf("%02X", sha.GetDigest()[j]);
+        printf("', 1);\n");
+    }
+    return 0;
+}
+
+bool parseOptions(int argc, char** argv)
+{
+    g_config.realmAddress = "127.0.0.1:3724";
+    g_config.accountPrefix = "BENCH";
+    g_config.password = "BENCH";
+    g_config.firstAccount = 1;
+    g_config.clientCount = 1000;
+    g_config.concurrency = 100;
+    g_config.build = 8606;
+    g_config.traffic = TRAFFIC_NONE;
+    g_config.duration = 60;
+
+    for(int i = 2; i < argc; i += 2)
+    {
+        if(argv[i][0] != '-' || i + 1 >= argc)
+            return false;
+
+        char const* value = argv[i + 1];
+        switch(argv[i][1])
+        {
+            case 'r': g_config.realmAddress = value; break;
+            case 'w': g_config.worldAddress = value; break;
+            case 'a': g_config.accountPrefix = value; break;
+            case 'p': g_config.password = value; break;
+            case 'o': g_config.firstAccount = atoi(value); break;
+            case 'n': g_config.clientCount = atoi(value); break;
+            case 'c': g_config.concurrency = std::max(1, atoi(value)); break;
+            case 'b': g_config.build = atoi(value); break;
+            case 'd': g_config.duration = atoi(value); break;
+            case 't':
+                if(!strcmp(value, "none"))
+                    g_config.traffic = TRAFFIC_NONE;
+                else if(!strcmp(value, "idle"))
+                    g_config.traffic = TRAFFIC_IDLE;
+                else if(!strcmp(value, "movement"))
+                    g_config.traffic = TRAFFIC_MOVEMENT;
+                else if(!strcmp(value, "chat"))
+                    g_config.traffic = TRAFFIC_CHAT;
+                else
+                    return false;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    // character traffic need world login
+    if(g_config.worldAddress.empty())
+        g_config.traffic = TRAFFIC_NONE;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc > 1 && !strcmp(argv[1], "sql"))
+        return printAccountsSql(argc, argv);
+
+    if(argc < 2 || strcmp(argv[1], "run") || !parseOptions(argc, argv))
+    {
+        usage();
+        return 1;
+    }
+
+    ACE::set_handle_limit(-1);
+    ACE_OS::signal(SIGINT, (ACE_SignalHandler)onSignal);
+    srand(uint32(time(NULL)));
+    memset(&g_stats.failed, 0, sizeof(g_stats.failed));
+    g_stats.firstLoginStart = g_stats.lastLoginEnd = 0;
+    g_stats.sentPackets = g_stats.receivedPackets = g_stats.receivedBytes = 0;
+
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+    ACE_Reactor_Impl* reactorImpl = new ACE_Dev_Poll_Reactor();
+#else
+    ACE_Reactor_Impl* reactorImpl = new ACE_Select_Reactor();
+#endif
+    ACE_Reactor reactor(reactorImpl, 1);
+
+    printf("%u clients, %u logins at once, realmd %s, mangosd %s\n", g_config.clientCount, g_config.concurrency,
+        g_config.realmAddress.c_str(), g_config.worldAddress.empty() ? "not used" : g_config.worldAddress.c_str());
+
+    std::vector<BenchClient*> clients;
+    clients.reserve(g_config.clientCount);
+
+    // login storm: keep given number of logins in progress until all clients logged in
+    uint32 finished = 0;
+    while(!g_stop && finished < g_config.clientCount)
+    {
+        uint32 inProgress = 0;
+        finished = 0;
+        uint64 now = getTimeUs();
+        for(size_t i = 0; i < clients.size(); ++i)
+        {
+            if(clients[i]->IsLoginFinished())
+                ++finished;
+            else
+                ++inProgress;
+            clients[i]->Update(now);
+        }
+
+        while(inProgress < g_config.concurrency && clients.size() < g_config.clientCount)
+        {
+            BenchClient* client = new BenchClient(clients.size(), &reactor);
+            clients.push_back(client);
+            if(client->StartLogin())
+                ++inProgress;
+        }
+
+        ACE_Time_Value interval(0, 10000);
+        reactor.handle_events(interval);
+    }
+
+    uint64 loginTime = g_stats.lastLoginEnd > g_stats.firstLoginStart ? g_stats.lastLoginEnd - g_stats.firstLoginStart : 0;
+
+    // steady state traffic of clients in world
+    uint32 inWorld = 0;
+    uint64 trafficTime = 0;
+    if(g_config.traffic != TRAFFIC_NONE && !g_stop)
+    {
+        g_stats.sentPackets = g_stats.receivedPackets = g_stats.receivedBytes = 0;
+        g_stats.pingRtt.clear();
+
+        uint64 trafficStart = getTimeUs();
+        uint64 trafficEnd = trafficStart + uint64(g_config.duration) * 1000000;
+        uint64 now = trafficStart;
+        while(!g_stop && now < trafficEnd)
+        {
+            for(size_t i = 0; i < clients.size(); ++i)
+                clients[i]->Update(now);
+
+            ACE_Time_Value interval(0, 10000);
+            reactor.handle_events(interval);
+            now = getTimeUs();
+        }
+        trafficTime = now - trafficStart;
+
+        for(size_t i = 0; i < clients.size(); ++i)
+            if(clients[i]->GetStage() == STAGE_IN_WORLD && !clients[i]->IsFailed())
+                ++inWorld;
+    }
+
+    for(size_t i = 0; i < clients.size(); ++i)
+        delete clients[i];
+
+    printf("\nLogin storm: %u clients started in %.2f s\n", uint32(clients.size()), loginTime / 1000000.0);
+    if(loginTime)
+    {
+        printf("  realmd logins per second:  %.1f\n", g_stats.realmLogin.size() * 1000000.0 / loginTime);
+        if(!g_config.worldAddress.empty())
+            printf("  mangosd logins per second: %.1f\n", g_stats.worldLogin.size() * 1000000.0 / loginTime);
+    }
+    printLatency("realm login", g_stats.realmLogin);
+    if(!g_config.worldAddress.empty())
+        printLatency("world login", g_stats.worldLogin);
+    if(g_config.traffic != TRAFFIC_NONE)
+        printLatency("enter world", g_stats.enterWorld);
+
+    for(int i = 0; i < MAX_BENCH_STAGE; ++i)
+        if(g_stats.failed[i])
+            printf("  failed at %s: %u\n", g_stageNames[i], g_stats.failed[i]);
+
+    if(trafficTime)
+    {
+        printf("\nSteady state: %u clients in world for %.2f s\n", inWorld, trafficTime / 1000000.0);
+        printf("  sent %.1f packets/s, received %.1f packets/s, %.1f KB/s\n",
+            g_stats.sentPackets * 1000000.0 / trafficTime, g_stats.receivedPackets * 1000000.0 / trafficTime,
+            g_stats.receivedBytes * 1000000.0 / 1024 / trafficTime);
+        printLatency("ping", g_stats.pingRtt);
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <map>
+#include <vector>
+
+#include "Utilities/EventProcessor.h"
+
+//=======================================================
+/**
+Compares the timing wheel EventProcessor with the former std::multimap based event queue.
+Every event re-adds itself with a random delay, so the number of queued events stays constant.
+*/
+
+// former implementation, kept here for comparison
+class MultimapEventProcessor
+{
+    public:
+        MultimapEventProcessor() : m_time(0) {}
+        ~MultimapEventProcessor()
+        {
+            for(std::multimap<uint64, BasicEvent*>::iterator i = m_events.begin(); i != m_events.end(); ++i)
+                delete i->second;
+        }
+
+        void Update(uint32 p_time)
+        {
+            m_time += p_time;
+
+            std::multimap<uint64, BasicEvent*>::iterator i;
+            while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+            {
+                BasicEvent* Event = i->second;
+                m_events.erase(i);
+                if (Event->Execute(m_time, p_time))
+                    delete Event;
+            }
+        }
+        void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true)
+        {
+            if (set_addtime) Event->m_addTime = m_time;
+            Event->m_execTime = e_time;
+            m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+        }
+        uint64 CalculateTime(uint64 t_offset) { return m_time + t_offset; }
+
+    private:
+        uint64 m_time;
+        std::multimap<uint64, BasicEvent*> m_events;
+};
+
+static uint32 g_seed = 1;
+static uint32 g_executed = 0;
+
+uint32 nextRandom()
+{
+    g_seed = g_seed * 1103515245 + 12345;
+    return (g_seed >> 8) & 0xFFFFFF;
+}
+
+template<class P>
+class RepeatEvent : public BasicEvent
+{
+    public:
+        RepeatEvent(P& processor, uint32 maxDelay) : m_processor(processor), m_maxDelay(maxDelay) {}
+
+        bool Execute(uint64 e_time, uint32 /*p_time*/)
+        {
+            ++g_executed;
+            m_processor.AddEvent(this, e_time + 1 + nextRandom() % m_maxDelay, false);
+            return false;
+        }
+
+    private:
+        P& m_processor;
+        uint32 m_maxDelay;
+};
+
+//=======================================================
+
+template<class P>
+double runConcurrent(uint32 pEventCount, uint32 pMaxDelay, uint32 pUpdates, uint32 pDiff)
+{
+    g_seed = 1;
+    g_executed = 0;
+
+    clock_t start = clock();
+    {
+        P processor;
+        for(uint32 i=0; i<pEventCount; ++i)
+            processor.AddEvent(new RepeatEvent<P>(processor, pMaxDelay), processor.CalculateTime(1 + nextRandom() % pMaxDelay));
+
+        for(uint32 i=0; i<pUpdates; ++i)
+            processor.Update(pDiff);
+    }
+    return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+template<class P>
+double runIdle(uint32 pProcessorCount, uint32 pUpdates, uint32 pDiff)
+{
+    std::vector<P> processors(pProcessorCount);
+
+    clock_t start = clock();
+    for(uint32 i=0; i<pUpdates; ++i)
+        for(uint32 j=0; j<pProcessorCount; ++j)
+            processors[j].Update(pDiff);
+    return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+//=======================================================
+
+int main(int argc, char** argv)
+{
+    uint32 eventCount = argc > 1 ? atoi(argv[1]) : 100000;
+    uint32 updates = argc > 2 ? atoi(argv[2]) : 1000;
+    uint32 const diff = 50;
+    uint32 const maxDelay = 10000;
+
+    printf("%u concurrent events, delay up to %u ms, %u updates of %u ms\n", eventCount, maxDelay, updates, diff);
+
+    double mapTime = runConcurrent<MultimapEventProcessor>(eventCount, maxDelay, updates, diff);
+    uint32 mapExecuted = g_executed;
+    double wheelTime = runConcurrent<EventProcessor>(eventCount, maxDelay, updates, diff);
+    uint32 wheelExecuted = g_executed;
+
+    printf("multimap:     %8.3f s, %u events executed\n", mapTime, mapExecuted);
+    printf("timing wheel: %8.3f s, %u events executed\n", wheelTime, wheelExecuted);
+
+    uint32 const idleCount = 10000;
+    printf("\n%u idle processors, %u updates\n", idleCount, updates);
+    printf("multimap:     %8.3f s\n", runIdle<MultimapEventProcessor>(idleCount, updates, diff));
+    printf("timing wheel: %8.3f s\n", runIdle<EventProcessor>(idleCount, updates, diff));
+
+    return 0;
+}
@@ -12,8 +12,10 @@
 
 #include "dbcfile.h"
 #include "mpq_libmpq.h"
+#include "adt.h"
 
 extern unsigned int iRes;
+extern int mapFormat;
 extern ArchiveSet gOpenArchives;
 
 bool ConvertADT(char*,char*);
@@ -23,10 +25,6 @@ typedef struct{
     unsigned int id;
 }map_id;
 
-typedef unsigned char uint8;
-typedef unsigned short uint16;
-typedef unsigned int uint32;
-
 map_id * map_ids;
 uint16 * areas;
 char output_path[128]=".";
@@ -66,7 +64,7 @@ bool FileExists( const char* FileName )
 
 void Usage(char* prg)
 {
-    printf("Usage:\n%s -[var] [value]\n-i set input path\n-o set output path\n-r set resolution\n-e extract only MAP(1)/DBC(2) - standard: both(3)\nExample: %s -r 256 -i \"c:\\games\\game\"",
+    printf("Usage:\n%s -[var] [value]\n-i set input path\n-o set output path\n-r set resolution\n-e extract only MAP(1)/DBC(2) - standard: both(3)\n-f map file format: raw(1)/compact(2) - standard: compact(2)\nExample: %s -r 256 -i \"c:\\games\\game\"",
     prg,prg);
     exit(1);
 }
@@ -79,6 +77,7 @@ void HandleArgs(int argc, char * arg[])
         //o - output path
         //r - resolution, array of (r * r) heights will be created
         //e - extract only MAP(1)/DBC(2) - standard both(3)
+        //f - map file format raw(1)/compact(2) - standard compact(2)
         if(arg[c][0] != '-')
             Usage(arg[0]);
 
@@ -112,6 +111,16 @@ void HandleArgs(int argc, char * arg[])
                 else
                     Usage(arg[0]);
                 break;
+            case 'f':
+                if(c+1<argc)//all ok
+                {
+                    mapFormat=atoi(arg[(c++) +1]);
+                    if(mapFormat != MAP_FORMAT_RAW && mapFormat != MAP_FORMAT_COMPACT)
+                        Usage(arg[0]);
+                }
+                else
+                    Usage(arg[0]);
+                break;
         }
     }
 }
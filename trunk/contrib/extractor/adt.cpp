@@ -211,6 +211,10 @@ void LoadMapChunk(MPQFile & mf, chunk*_chunk)
     _chunk->area_id =header.areaid ;
     _chunk->flag =0;
 
+    for(int i=0;i<9;i++)
+        for(int j=0;j<9;j++)
+            _chunk->waterlevel[i][j]=-999999;               // no liquid/water until MCLQ found
+
     float xbase = header.xpos;
     float ybase = header.ypos;
     float zbase = header.zpos;
@@ -419,7 +423,97 @@ void TransformData()
     delete mcells;
 }
 
-const char MAP_MAGIC[] = "MAP_2.00";
+const char MAP_MAGIC_RAW[]     = "MAP_2.00";
+const char MAP_MAGIC_COMPACT[] = "MAP_3.00";
+
+// see GridMapFileHeader in src/game/Map.h
+#define MAP_FLAG_FLAT_HEIGHT    0x01
+#define MAP_FLAG_NO_LIQUID      0x02
+#define MAP_LIQUID_NO_BLOCK     0xFFFF
+#define MAP_LIQUID_NO_WATER     (-999999.0f)
+
+typedef struct
+{
+    char   magic[8];
+    uint32 flags;
+    float  heightMin;
+    float  heightMax;
+    uint32 liquidBlocks;
+}map_header;
+
+int mapFormat = MAP_FORMAT_COMPACT;
+
+uint16 map_areaflags[16][16];
+uint8  map_terrain[16][16];
+float  map_liquid[128][128];
+
+void WriteRawMap(FILE *output, float const* heights)
+{
+    fwrite(MAP_MAGIC_RAW,1,8,output);
+    fwrite(map_areaflags,1,sizeof(map_areaflags),output);
+    fwrite(map_terrain,1,sizeof(map_terrain),output);
+    fwrite(map_liquid,1,sizeof(map_liquid),output);
+    fwrite(heights,sizeof(float),iRes*iRes,output);
+}
+
+void WriteCompactMap(FILE *output, float const* heights)
+{
+    map_header header;
+    memcpy(header.magic,MAP_MAGIC_COMPACT,8);
+    header.flags = 0;
+    header.liquidBlocks = 0;
+
+    header.heightMin = heights[0];
+    header.heightMax = heights[0];
+    for(unsigned int i=1;i<iRes*iRes;i++)
+    {
+        if(header.heightMin > heights[i]) header.heightMin = heights[i];
+        if(header.heightMax < heights[i]) header.heightMax = heights[i];
+    }
+
+    if(header.heightMax - header.heightMin < 0.001f)
+        header.flags |= MAP_FLAG_FLAT_HEIGHT;
+
+    // liquid stored only for 8x8 blocks (one per map chunk) that have any water
+    uint16 liquidIndex[16][16];
+    for(unsigned int x=0;x<16;x++)
+    {
+        for(unsigned int y=0;y<16;y++)
+        {
+            liquidIndex[x][y] = MAP_LIQUID_NO_BLOCK;
+            for(unsigned int i=0;i<64 && liquidIndex[x][y]==MAP_LIQUID_NO_BLOCK;i++)
+                if(map_liquid[x*8+i/8][y*8+i%8] > MAP_LIQUID_NO_WATER)
+                    liquidIndex[x][y] = header.liquidBlocks++;
+        }
+    }
+
+    if(!header.liquidBlocks)
+        header.flags |= MAP_FLAG_NO_LIQUID;
+
+    fwrite(&header,1,sizeof(header),output);
+    fwrite(map_areaflags,1,sizeof(map_areaflags),output);
+    fwrite(map_terrain,1,sizeof(map_terrain),output);
+
+    if(!(header.flags & MAP_FLAG_FLAT_HEIGHT))
+    {
+        float step = (header.heightMax - header.heightMin) / 65535.0f;
+        for(unsigned int i=0;i<iRes*iRes;i++)
+        {
+            uint16 h = (uint16)((heights[i] - header.heightMin) / step + 0.5f);
+            fwrite(&h,1,sizeof(h),output);
+        }
+    }
+
+    if(!(header.flags & MAP_FLAG_NO_LIQUID))
+    {
+        fwrite(liquidIndex,1,sizeof(liquidIndex),output);
+        for(unsigned int x=0;x<16;x++)
+            for(unsigned int y=0;y<16;y++)
+                if(liquidIndex[x][y] != MAP_LIQUID_NO_BLOCK)
+                    for(unsigned int i=0;i<8;i++)
+                        fwrite(&map_liquid[x*8+i][y*8],sizeof(float),8,output);
+    }
+}
 
 bool ConvertADT(char * filename,char * filename2)
 {
@@ -434,9 +528,6 @@ bool ConvertADT(char * filename,char * filename2)
         return false;
     }
 
-    // write magic header
-    fwrite(MAP_MAGIC,1,8,output);
-
     for(unsigned int x=0;x<16;x++)
     {
         for(unsigned int y=0;y<16;y++)
@@ -446,40 +537,42 @@ bool ConvertADT(char * filename,char * filename2)
                 if(areas[mcells->ch[y][x].area_id]==0xffff)
                     printf("\nCan't find area flag for areaid %u.\n",mcells->ch[y][x].area_id);
 
-                fwrite(&areas[mcells->ch[y][x].area_id],1,2,output);
+                map_areaflags[x][y] = areas[mcells->ch[y][x].area_id];
             }
             else
-            {
-                uint16 flag=0xffff;
-                fwrite(&flag,1,2,output);
-            }
+                map_areaflags[x][y] = 0xffff;
         }
     }
 
     for(unsigned int x=0;x<16;x++)
         for(unsigned int y=0;y<16;y++)
-            fwrite(&mcells->ch[y][x].flag,1,1,output);
+            map_terrain[x][y] = mcells->ch[y][x].flag;
 
     TransformWaterData();
 
     for(unsigned int x=0;x<128;x++)
         for(unsigned int y=0;y<128;y++)
-            fwrite(&cell->v9[y][x],1,sizeof(float),output);
+            map_liquid[x][y] = cell->v9[y][x];
 
     delete cell;
     TransformData();
 
+    float* heights = new float[iRes*iRes];
     for(unsigned int x=0;x<iRes;x++)
     for(unsigned int y=0;y<iRes;y++)
     {
-        float z=(float)GetZ(
+        heights[x*iRes+y]=(float)GetZ(
                     (((double)(y))*TILESIZE)/((double)(iRes-1)),
                     (((double)(x))*TILESIZE)/((double)(iRes-1)));
-
-        fwrite(&z,1,sizeof(z),output);
     }
 
+    if(mapFormat == MAP_FORMAT_RAW)
+        WriteRawMap(output,heights);
+    else
+        WriteCompactMap(output,heights);
+
     fclose(output);
+    delete [] heights;
     delete cell;
 /*
     for (std::vector<std::string>::iterator it = wmos.begin(); it != wmos.end(); ++it)
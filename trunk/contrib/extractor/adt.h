@@ -5,6 +5,12 @@
 #define CHUNKSIZE ((TILESIZE) / 16.0f)
 #define UNITSIZE (CHUNKSIZE / 8.0f)
 
+enum MapFormat
+{
+    MAP_FORMAT_RAW      = 1,                                // "MAP_2.00", plain float arrays
+    MAP_FORMAT_COMPACT  = 2                                 // "MAP_3.00", quantized heights and sparse liquid
+};
+
 typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint32;
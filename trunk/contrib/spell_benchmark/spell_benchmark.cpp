@@ -0,0 +1,236 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <list>
+#include <vector>
+
+#include "ObjectPool.h"
+
+//=======================================================
+/**
+Replays a stream of spell casts with the per cast containers of Spell and counts heap allocations.
+Each cast allocates the spell object, fills the unit/gameobject/item target lists and the
+triggered spell list, and collects area targets in a temporary unit list, once with std::allocator
+and heap allocated spell (former code) and once with PoolAllocator and pooled spell (current code).
+*/
+
+static uint64 g_allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++g_allocations;
+    void* p = malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    free(p);
+}
+
+struct CastRecord
+{
+    uint32 units;                                           // unique unit targets
+    uint32 gameobjects;                                     // unique gameobject targets
+    uint32 items;                                           // item targets
+    uint32 candidates;                                      // units found by area search
+    uint32 triggers;                                        // triggered spells
+};
+
+// same layout as Spell::TargetInfo and friends
+struct TargetInfo
+{
+    uint64 targetGUID;
+    uint64 timeDelay;
+    uint8 missCondition;
+    uint8 reflectResult;
+    uint8 effectMask;
+    bool processed;
+};
+
+struct GOTargetInfo
+{
+    uint64 targetGUID;
+    uint64 timeDelay;
+    uint8 effectMask;
+    bool processed;
+};
+
+struct ItemTargetInfo
+{
+    void* item;
+    uint8 effectMask;
+};
+
+class Unit;
+struct SpellEntry;
+
+template<template<class> class A>
+struct CastState
+{
+    std::list<TargetInfo, A<TargetInfo> > uniqueTargets;
+    std::list<GOTargetInfo, A<GOTargetInfo> > uniqueGOTargets;
+    std::list<ItemTargetInfo, A<ItemTargetInfo> > uniqueItems;
+    std::list<SpellEntry const*, A<SpellEntry const*> > triggerSpells;
+    char other[600];                                        // rest of Spell fields
+};
+
+class HeapSpell : public CastState<std::allocator>
+{
+};
+
+class PooledSpell : public CastState<PoolAllocator>
+{
+    DECLARE_POOLED_ALLOCATION(PooledSpell)
+};
+
+IMPLEMENT_POOLED_ALLOCATION(PooledSpell)
+
+template<class S, class UnitList>
+void replayCast(CastRecord const& cast, uint32& checksum)
+{
+    S* spell = new S;
+
+    // Spell::SetTargetMap area search and Spell::FillTargetMap filter
+    UnitList tmpUnitMap;
+    for(uint32 i = 0; i < cast.candidates; ++i)
+        tmpUnitMap.push_back((Unit*)(size_t)(i + 1));
+    for(typename UnitList::iterator itr = tmpUnitMap.begin(); itr != tmpUnitMap.end();)
+    {
+        if(((size_t)*itr) % 4 == 0)
+            itr = tmpUnitMap.erase(itr);
+        else
+            ++itr;
+    }
+
+    for(uint32 i = 0; i < cast.units; ++i)
+    {
+        TargetInfo target;
+        memset(&target, 0, sizeof(target));
+        target.targetGUID = i;
+        spell->uniqueTargets.push_back(target);
+    }
+    for(uint32 i = 0; i < cast.gameobjects; ++i)
+    {
+        GOTargetInfo target;
+        memset(&target, 0, sizeof(target));
+        target.targetGUID = i;
+        spell->uniqueGOTargets.push_back(target);
+    }
+    for(uint32 i = 0; i < cast.items; ++i)
+    {
+        ItemTargetInfo target;
+        target.item = NULL;
+        target.effectMask = 1;
+        spell->uniqueItems.push_back(target);
+    }
+    for(uint32 i = 0; i < cast.triggers; ++i)
+        spell->triggerSpells.push_back(NULL);
+
+    checksum += uint32(tmpUnitMap.size() + spell->uniqueTargets.size() + spell->uniqueGOTargets.size() +
+        spell->uniqueItems.size() + spell->triggerSpells.size());
+
+    delete spell;
+}
+
+template<class S, class UnitList>
+void replay(char const* name, std::vector<CastRecord> const& casts, uint32 passes)
+{
+    uint32 checksum = 0;
+
+    // first pass fill the pools, like a server running for a while
+    for(size_t i = 0; i < casts.size(); ++i)
+        replayCast<S, UnitList>(casts[i], checksum);
+
+    uint64 allocations = g_allocations;
+    clock_t start = clock();
+    for(uint32 p = 0; p < passes; ++p)
+        for(size_t i = 0; i < casts.size(); ++i)
+            replayCast<S, UnitList>(casts[i], checksum);
+    double time = double(clock() - start) / CLOCKS_PER_SEC;
+    uint64 casted = uint64(casts.size()) * passes;
+
+    printf("%-8s %8.3f s, %8.3f heap allocations per cast (checksum %u)\n", name, time,
+        double(g_allocations - allocations) / double(casted), checksum);
+}
+
+//=======================================================
+
+static uint32 g_seed = 1;
+
+uint32 nextRandom()
+{
+    g_seed = g_seed * 1103515245 + 12345;
+    return (g_seed >> 8) & 0xFFFFFF;
+}
+
+// raid and battleground like mix: mostly single target casts, some area casts
+void generateStream(std::vector<CastRecord>& casts, uint32 count)
+{
+    for(uint32 i = 0; i < count; ++i)
+    {
+        CastRecord cast;
+        memset(&cast, 0, sizeof(cast));
+        uint32 kind = nextRandom() % 100;
+        if(kind < 70)
+            cast.units = 1;
+        else if(kind < 90)
+        {
+            cast.candidates = 5 + nextRandom() % 30;
+            cast.units = cast.candidates * 3 / 4;
+        }
+        else if(kind < 95)
+            cast.gameobjects = 1;
+        else
+            cast.items = 1;
+        if(nextRandom() % 10 == 0)
+            cast.triggers = 1;
+        casts.push_back(cast);
+    }
+}
+
+bool loadStream(char const* filename, std::vector<CastRecord>& casts)
+{
+    FILE* file = fopen(filename, "r");
+    if(!file)
+        return false;
+
+    char line[256];
+    while(fgets(line, sizeof(line), file))
+    {
+        if(line[0] == '#')
+            continue;
+
+        CastRecord cast;
+        if(sscanf(line, "%u %u %u %u %u", &cast.units, &cast.gameobjects, &cast.items, &cast.candidates, &cast.triggers) == 5)
+            casts.push_back(cast);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<CastRecord> casts;
+    if(argc > 1 && strcmp(argv[1], "-") != 0)
+    {
+        if(!loadStream(argv[1], casts))
+        {
+            printf("Can't read cast stream %s\n", argv[1]);
+            return 1;
+        }
+    }
+    else
+        generateStream(casts, 100000);
+
+    uint32 passes = argc > 2 ? atoi(argv[2]) : 10;
+
+    printf("%u casts, %u passes\n", uint32(casts.size()), passes);
+    replay<HeapSpell, std::list<Unit*> >("heap:", casts, passes);
+    replay<PooledSpell, std::list<Unit*, PoolAllocator<Unit*> > >("pooled:", casts, passes);
+
+    return 0;
+}
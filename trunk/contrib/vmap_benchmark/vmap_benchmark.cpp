@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+#include <string>
+
+#include "VMapManager.h"
+#include "DebugCmdLogger.h"
+
+//=======================================================
+/**
+Replays a vmapcmd.log (written by a debug mangosd compiled with _VMAP_LOG_DEBUG)
+against the old BSP-Tree and the flattened BVH and compares time and results.
+*/
+
+struct PassResult
+{
+    G3D::Array<float> results;                              // one entry per query command
+    clock_t time[VMAP::TEST_OBJECT_HIT+1];
+    int count[VMAP::TEST_OBJECT_HIT+1];
+};
+
+//=======================================================
+
+void replay(const G3D::Array<VMAP::Command>& pCommands, const char* pVmapDir, bool pUseFlatTree, PassResult& pResult)
+{
+    VMAP::ModelContainer::setUseFlatTree(pUseFlatTree);
+    VMAP::VMapManager* vmgr = new VMAP::VMapManager();
+
+    for(int i=0; i<=VMAP::TEST_OBJECT_HIT; ++i)
+    {
+        pResult.time[i] = 0;
+        pResult.count[i] = 0;
+    }
+
+    for(int i=0; i<pCommands.size(); ++i)
+    {
+        VMAP::Command cmd = pCommands[i];
+        switch(cmd.getType())
+        {
+            case VMAP::LOAD_TILE:
+                vmgr->loadMap(pVmapDir, cmd.getInt(2), cmd.getInt(0), cmd.getInt(1));
+                break;
+            case VMAP::UNLOAD_TILE:
+                // the logger stores the map id over the x coordinate, so unload the whole map
+                vmgr->unloadMap(cmd.getInt(0));
+                break;
+            case VMAP::UNLOAD_INSTANCE:
+                vmgr->unloadMap(cmd.getInt(0));
+                break;
+            case VMAP::TEST_VIS:
+            {
+                G3D::Vector3 p1 = cmd.getVector(0);
+                G3D::Vector3 p2 = cmd.getVector(1);
+                clock_t start = clock();
+                bool res = vmgr->isInLineOfSight(cmd.getInt(1), p1.x, p1.y, p1.z, p2.x, p2.y, p2.z);
+                pResult.time[VMAP::TEST_VIS] += clock() - start;
+                ++pResult.count[VMAP::TEST_VIS];
+                pResult.results.append(res ? 1.0f : 0.0f);
+                break;
+            }
+            case VMAP::TEST_HEIGHT:
+            {
+                G3D::Vector3 p = cmd.getVector(0);
+                clock_t start = clock();
+                float res = vmgr->getHeight(cmd.getInt(0), p.x, p.y, p.z);
+                pResult.time[VMAP::TEST_HEIGHT] += clock() - start;
+                ++pResult.count[VMAP::TEST_HEIGHT];
+                pResult.results.append(res);
+                break;
+            }
+            case VMAP::TEST_OBJECT_HIT:
+            {
+                // positions are logged in internal representation
+                G3D::Vector3 p1 = cmd.getVector(0);
+                G3D::Vector3 p2 = cmd.getVector(1);
+                p1 = vmgr->convertPositionToMangosRep(p1.x, p1.y, p1.z);
+                p2 = vmgr->convertPositionToMangosRep(p2.x, p2.y, p2.z);
+                float rx, ry, rz;
+                clock_t start = clock();
+                vmgr->getObjectHitPos(cmd.getInt(1), p1.x, p1.y, p1.z, p2.x, p2.y, p2.z, rx, ry, rz, 0.0f);
+                pResult.time[VMAP::TEST_OBJECT_HIT] += clock() - start;
+                ++pResult.count[VMAP::TEST_OBJECT_HIT];
+                pResult.results.append(rx + ry + rz);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    delete vmgr;
+}
+
+//=======================================================
+
+void printPass(const char* pName, const PassResult& pResult)
+{
+    const char* names[] = { "line of sight", "height", "object hit" };
+    const int types[] = { VMAP::TEST_VIS, VMAP::TEST_HEIGHT, VMAP::TEST_OBJECT_HIT };
+
+    printf("%s:\n", pName);
+    for(int i=0; i<3; ++i)
+    {
+        int t = types[i];
+        double ms = 1000.0 * pResult.time[t] / CLOCKS_PER_SEC;
+        printf("  %-14s %8d queries %10.2f ms %8.3f us/query\n", names[i], pResult.count[t], ms,
+            pResult.count[t] ? 1000.0 * ms / pResult.count[t] : 0.0);
+    }
+}
+
+//=======================================================
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3)
+    {
+        printf("\nusage: %s <vmap dir> <vmapcmd.log> [repeat count]\n", argv[0]);
+        return 1;
+    }
+
+    int repeat = argc > 3 ? atoi(argv[3]) : 1;
+    if(repeat < 1)
+        repeat = 1;
+
+    VMAP::CommandFileRW logFile(argv[2]);
+    G3D::Array<VMAP::Command> once;
+    logFile.getNewCommands(once);
+    if(once.size() == 0)
+    {
+        printf("No commands found in %s\n", argv[2]);
+        return 1;
+    }
+
+    G3D::Array<VMAP::Command> commands;
+    for(int i=0; i<repeat; ++i)
+        commands.append(once);
+
+    PassResult bsp, flat;
+    replay(commands, argv[1], false, bsp);
+    replay(commands, argv[1], true, flat);
+
+    printPass("BSP-Tree", bsp);
+    printPass("flattened BVH", flat);
+
+    int mismatches = 0;
+    for(int i=0; i<bsp.results.size() && i<flat.results.size(); ++i)
+        if(fabs(bsp.results[i] - flat.results[i]) > 0.01f)
+            ++mismatches;
+    printf("%d of %d results differ\n", mismatches, bsp.results.size());
+
+    return mismatches ? 2 : 0;
+}
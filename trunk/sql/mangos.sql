@@ -193,10 +193,13 @@ INSERT INTO `command` VALUES
 ('cooldown',3,'Syntax: .cooldown [#spell_id]\r\n\r\nRemove all (if spell_id not provided) or #spel_id spell cooldown from selected character or you (if no selection).'),
 ('damage',3,'Syntax: .damage $damage_amount [$school [$spellid]]\r\n\r\nApply $damage to target. If not $school and $spellid provided then this flat clean melee damage without any modifiers. If $school provided then damage modified by armor reduction (if school physical), and target absorbing modifiers and result applied as melee damage to target. If spell provided then damage modified and applied as spell damage. $spellid can be shift-link.'),
 ('debug anim',2,'Syntax: .debug anim #emoteid\r\n\r\nPlay emote #emoteid for your character.'),
+('debug aurabench',3,'Syntax: .debug aurabench [#rotations]\r\n\r\nSimulate #rotations (default 1000, max 10000) spell rotations of a 25 member raid against the selected target with your character as caster, and show time of damage and healing calculations with and without cached aura modifier totals.'),
 ('debug getvalue',3,'Syntax: .debug getvalue #field #isInt\r\n\r\nGet the field #field of the selected creature. If no creature is selected, get the content of your field.\r\n\r\nUse a #isInt of value 1 if the expected field content is an integer.'),
+('debug loscache',3,'Syntax: .debug loscache\r\n\r\nShow line of sight cache usage and hit rate for the current map.'),
 ('debug playsound',1,'Syntax: .debug playsound #soundid\r\n\r\nPlay sound with #soundid.\r\nSound will be play only for you. Other players do not hear this.\r\nWarning: client may have more 5000 sounds...'),
 ('debug setvalue',3,'Syntax: .debug setvalue #field #value #isInt\r\n\r\nSet the field #field of the selected creature with value #value. If no creature is selected, set the content of your field.\r\n\r\nUse a #isInt of value 1 if #value is an integer.'),
 ('debug standstate',2,'Syntax: .debug standstate #emoteid\r\n\r\nChange the emote of your character while standing to #emoteid.'),
+('debug statupdates',3,'Syntax: .debug statupdates\r\n\r\nShow count of derived stat recalculations requested by stat modifiers, done, and avoided by deferred recalculation of modifiers applied together.'),
 ('debug update',3,'Syntax: .debug update #field #value\r\n\r\nUpdate the field #field of the selected character or creature with value #value.\r\n\r\nIf no #value is provided, display the content of field #field.'),
 ('delticket',2,'Syntax: .delticket all\r\n        .delticket #num\r\n        .delticket $character_name\r\n\rall to dalete all tickets at server, $character_name to delete ticket of this character, #num to delete ticket #num.'),
 ('demorph',2,'Syntax: .demorph\r\n\r\nDemorph the selected player.'),
@@ -354,6 +357,11 @@ INSERT INTO `command` VALUES
 ('security',3,'Syntax: .security $name #level\r\n\r\nSet the security level of player $name to a level of #level.\r\n\r\n#level may range from 0 to 5.'),
 ('sendmail',1,'Syntax: .sendmail #playername "#subject" "#text" itemid1[:count1] itemid2[:count2] ... itemidN[:countN]\r\n\r\nSend a mail to a player. Subject and mail text must be in "". If for itemid not provided related count values then expected 1, if count > max items in stack then items will be send in required amount stacks. All stacks amount in mail limited to 12.'),
 ('server info',0,'Syntax: .server info\r\n\r\nDisplay server version and the number of connected players.'),
+('server movement',3,'Syntax: .server movement [reset]\r\n\r\nShow relayed player movement packets, merged heartbeats, sent and skipped packet copies and saved bandwidth per map type (continents, instances, battlegrounds) since server start or last reset, or reset movement relay stats.'),
+('server network',3,'Syntax: .server network\r\n\r\nShow connections and send/recv socket calls and bytes of each network thread in the last second and since server start.'),
+('server opcodes',3,'Syntax: .server opcodes [#count|reset]\r\n\r\nShow #count (default 10) received opcodes with most handler time and sent opcodes with most bytes since server start or last reset, or reset opcode profiler stats.'),
+('server pools',3,'Syntax: .server pools\r\n\r\nShow usage, free blocks and reuse rate of creature, gameobject, dynamic object and update field memory pools.'),
+('server querycache',3,'Syntax: .server querycache\r\n\r\nShow count and memory of stored item, creature, gameobject, quest, npc text and page text query responses and part of queries answered from them.'),
 ('server idleshutdown',3,'Syntax: .server idleshutdown #delay|cancel\r\n\r\nShut the server down after #delay seconds if no active connections are present (no players) or cancel the restart/shutdown if cancel value is used.'),
 ('server idlerestart',3,'Syntax: .server idlerestart #delay|cancel\r\n\r\nRestart the server after #delay seconds if no active connections are present (no players) or cancel the restart/shutdown if cancel value is used.'),
 ('server restart',3,'Syntax: .server restart seconds\r\n\r\nRestart the server after given seconds and show "Restart server in X" or cancel the restart/shutdown if cancel value is used.'),
@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'debug loscache';
+INSERT INTO `command` VALUES
+('debug loscache',3,'Syntax: .debug loscache\r\n\r\nShow line of sight cache usage and hit rate for the current map.');
@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'server pools';
+INSERT INTO `command` VALUES
+('server pools',3,'Syntax: .server pools\r\n\r\nShow usage, free blocks and reuse rate of creature, gameobject, dynamic object and update field memory pools.');
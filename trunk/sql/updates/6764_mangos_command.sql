@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'debug statupdates';
+INSERT INTO `command` VALUES
+('debug statupdates',3,'Syntax: .debug statupdates\r\n\r\nShow count of derived stat recalculations requested by stat modifiers, done, and avoided by deferred recalculation of modifiers applied together.');
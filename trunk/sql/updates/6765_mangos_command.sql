@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'server querycache';
+INSERT INTO `command` VALUES
+('server querycache',3,'Syntax: .server querycache\r\n\r\nShow count and memory of stored item, creature, gameobject, quest, npc text and page text query responses and part of queries answered from them.');
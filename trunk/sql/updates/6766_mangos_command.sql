@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'server opcodes';
+INSERT INTO `command` VALUES
+('server opcodes',3,'Syntax: .server opcodes [#count|reset]\r\n\r\nShow #count (default 10) received opcodes with most handler time and sent opcodes with most bytes since server start or last reset, or reset opcode profiler stats.');
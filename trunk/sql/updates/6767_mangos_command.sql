@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'server network';
+INSERT INTO `command` VALUES
+('server network',3,'Syntax: .server network\r\n\r\nShow connections and send/recv socket calls and bytes of each network thread in the last second and since server start.');
@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'server movement';
+INSERT INTO `command` VALUES
+('server movement',3,'Syntax: .server movement [reset]\r\n\r\nShow relayed player movement packets, merged heartbeats, sent and skipped packet copies and saved bandwidth per map type (continents, instances, battlegrounds) since server start or last reset, or reset movement relay stats.');
@@ -0,0 +1,3 @@
+DELETE FROM command WHERE name = 'debug aurabench';
+INSERT INTO `command` VALUES
+('debug aurabench',3,'Syntax: .debug aurabench [#rotations]\r\n\r\nSimulate #rotations (default 1000, max 10000) spell rotations of a 25 member raid against the selected target with your character as caster, and show time of damage and healing calculations with and without cached aura modifier totals.');
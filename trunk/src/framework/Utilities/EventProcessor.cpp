@@ -18,29 +18,244 @@
 
 #include "EventProcessor.h"
 
+#include <algorithm>
+#include <new>
+#include <string.h>
+#include <vector>
+
+enum
+{
+    WHEEL_SLOT_BITS     = 6,
+    WHEEL_SLOTS         = 1 << WHEEL_SLOT_BITS,
+    WHEEL_SLOT_MASK     = WHEEL_SLOTS - 1
+};
+
+struct EventWheel
+{
+    BasicEvent* slots[EVENT_WHEEL_LEVELS][WHEEL_SLOTS];
+    uint64 occupied[EVENT_WHEEL_LEVELS];                    // bit per not empty slot
+    uint64 unordered;                                       // bit per level 0 slot with events not in add order
+};
+
+/*
+ * Free lists of event memory in 16 byte size classes and of wheels. Events are created and
+ * destroyed only from world update thread, so lists are not locked.
+ */
+namespace
+{
+    enum
+    {
+        POOL_SIZE_STEP      = 16,
+        POOL_MAX_SIZE       = 256,                          // bigger events use global heap
+        POOL_SIZE_CLASSES   = POOL_MAX_SIZE / POOL_SIZE_STEP,
+        POOL_WHEEL_CLASS    = POOL_SIZE_CLASSES,
+        POOL_MAX_FREE       = 4096                          // free blocks kept per size class
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    FreeBlock* s_freeBlocks[POOL_SIZE_CLASSES + 1];
+    uint32 s_freeCounts[POOL_SIZE_CLASSES + 1];
+
+    void* AllocateBlock(uint32 sizeClass, size_t size)
+    {
+        if (FreeBlock* block = s_freeBlocks[sizeClass])
+        {
+            s_freeBlocks[sizeClass] = block->next;
+            --s_freeCounts[sizeClass];
+            return block;
+        }
+        return ::operator new(size);
+    }
+
+    void ReleaseBlock(uint32 sizeClass, void* p)
+    {
+        if (s_freeCounts[sizeClass] >= POOL_MAX_FREE)
+        {
+            ::operator delete(p);
+            return;
+        }
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = s_freeBlocks[sizeClass];
+        s_freeBlocks[sizeClass] = block;
+        ++s_freeCounts[sizeClass];
+    }
+
+    inline bool SeqBefore(uint32 a, uint32 b) { return int32(a - b) < 0; }
+
+    // index of lowest set bit, mask must not be 0
+    inline uint32 LowestBit(uint64 mask)
+    {
+        uint32 index = 0;
+        if (!(mask & 0xFFFFFFFF)) { mask >>= 32; index += 32; }
+        if (!(mask & 0xFFFF))     { mask >>= 16; index += 16; }
+        if (!(mask & 0xFF))       { mask >>= 8;  index += 8;  }
+        if (!(mask & 0xF))        { mask >>= 4;  index += 4;  }
+        if (!(mask & 0x3))        { mask >>= 2;  index += 2;  }
+        if (!(mask & 0x1))        { index += 1; }
+        return index;
+    }
+}
+
+void* BasicEvent::operator new(size_t size)
+{
+    if (size > POOL_MAX_SIZE)
+        return ::operator new(size);
+    return AllocateBlock((size - 1) / POOL_SIZE_STEP, ((size - 1) / POOL_SIZE_STEP + 1) * POOL_SIZE_STEP);
+}
+
+void BasicEvent::operator delete(void* p, size_t size)
+{
+    if (!p)
+        return;
+    if (size > POOL_MAX_SIZE)
+    {
+        ::operator delete(p);
+        return;
+    }
+    ReleaseBlock((size - 1) / POOL_SIZE_STEP, p);
+}
+
+bool EventProcessor::ExecutesBefore(BasicEvent const* a, BasicEvent const* b)
+{
+    if (a->m_execTime != b->m_execTime)
+        return a->m_execTime < b->m_execTime;
+    return SeqBefore(a->m_seq, b->m_seq);
+}
+
+void EventProcessor::LinkEvent(BasicEvent*& head, BasicEvent* Event)
+{
+    Event->m_next = NULL;
+    if (!head)
+    {
+        Event->m_prev = Event;
+        head = Event;
+        return;
+    }
+
+    Event->m_prev = head->m_prev;
+    head->m_prev->m_next = Event;
+    head->m_prev = Event;
+}
+
+// links event into list ordered by execution time and add order, searching from tail
+void EventProcessor::LinkEventByTime(BasicEvent*& head, BasicEvent* Event)
+{
+    BasicEvent* after = head ? head->m_prev : NULL;
+    while (after && ExecutesBefore(Event, after))
+        after = after == head ? NULL : after->m_prev;
+
+    if (!after)
+    {
+        Event->m_next = head;
+        Event->m_prev = head ? head->m_prev : Event;
+        if (head)
+            head->m_prev = Event;
+        head = Event;
+    }
+    else
+    {
+        Event->m_prev = after;
+        Event->m_next = after->m_next;
+        if (after->m_next)
+            after->m_next->m_prev = Event;
+        else
+            head->m_prev = Event;
+        after->m_next = Event;
+    }
+}
+
+void EventProcessor::SortEvents(BasicEvent*& head)
+{
+    static std::vector<BasicEvent*> events;
+
+    for (BasicEvent* Event = head; Event; Event = Event->m_next)
+        events.push_back(Event);
+
+    std::sort(events.begin(), events.end(), &EventProcessor::ExecutesBefore);
+
+    head = NULL;
+    for (std::vector<BasicEvent*>::const_iterator i = events.begin(); i != events.end(); ++i)
+        LinkEvent(head, *i);
+
+    events.clear();
+}
+
+void EventProcessor::UnlinkEvent(BasicEvent*& head, BasicEvent* Event)
+{
+    BasicEvent* next = Event->m_next;
+    if (Event == head)
+    {
+        head = next;
+        if (next)
+            next->m_prev = Event->m_prev;
+    }
+    else
+    {
+        Event->m_prev->m_next = next;
+        if (next)
+            next->m_prev = Event->m_prev;
+        else
+            head->m_prev = Event->m_prev;
+    }
+    Event->m_prev = NULL;
+    Event->m_next = NULL;
+}
+
 EventProcessor::EventProcessor()
 {
     m_time = 0;
     m_aborting = false;
+    m_wheel = NULL;
+    m_lateEvents = NULL;
+    m_overflowEvents = NULL;
+    m_wheelTime = 0;
+    m_eventCount = 0;
+    m_nextSeq = 0;
+    m_processing = false;
 }
 
 EventProcessor::~EventProcessor()
 {
     KillAllEvents();
+    ReleaseWheel();
 }
 
-void EventProcessor::Update(uint32 p_time)
+void EventProcessor::ProcessEvents(uint32 p_time)
 {
-    // update time
-    m_time += p_time;
+    m_processing = true;
 
     // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    while (m_eventCount)
     {
+        // events added with already passed time go first, they are before any wheel event
+        BasicEvent* Event = m_lateEvents;
+        if (!Event)
+        {
+            if (m_wheelTime > m_time)
+                break;
+
+            uint32 slot = uint32(m_wheelTime & WHEEL_SLOT_MASK);
+            Event = m_wheel->slots[0][slot];
+            if (!Event)
+            {
+                AdvanceWheel();
+                continue;
+            }
+
+            if (m_wheel->unordered & (uint64(1) << slot))
+            {
+                m_wheel->unordered &= ~(uint64(1) << slot);
+                SortEvents(m_wheel->slots[0][slot]);
+                Event = m_wheel->slots[0][slot];
+            }
+        }
+
         // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        DequeueEvent(Event);
 
         if (!Event->to_Abort)
         {
@@ -56,6 +271,133 @@ void EventProcessor::Update(uint32 p_time)
             delete Event;
         }
     }
+
+    m_processing = false;
+
+    if (!m_eventCount)
+    {
+        ReleaseWheel();
+        m_wheelTime = m_time + 1;
+    }
+}
+
+// move wheel time to next level 0 slot with events, to next 64 ms block start or to m_time + 1
+void EventProcessor::AdvanceWheel()
+{
+    uint32 index = uint32(m_wheelTime & WHEEL_SLOT_MASK);
+    uint64 step = WHEEL_SLOTS - index;
+    if (index + 1 < WHEEL_SLOTS)
+        if (uint64 later = m_wheel->occupied[0] >> (index + 1))
+            step = LowestBit(later) + 1;
+
+    if (m_wheelTime + step > m_time + 1)
+        step = m_time + 1 - m_wheelTime;
+
+    m_wheelTime += step;
+    if (!(m_wheelTime & WHEEL_SLOT_MASK))
+        CascadeWheel();
+}
+
+// at block start move events of higher level slot for the block down to lower levels
+void EventProcessor::CascadeWheel()
+{
+    for (uint32 level = 1; level < EVENT_WHEEL_LEVELS; ++level)
+    {
+        uint32 slot = uint32((m_wheelTime >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK);
+        if (BasicEvent* list = m_wheel->slots[level][slot])
+        {
+            m_wheel->slots[level][slot] = NULL;
+            m_wheel->occupied[level] &= ~(uint64(1) << slot);
+            RequeueEvents(list);
+        }
+
+        if (slot)
+            return;
+    }
+
+    // all levels wrapped, events from overflow can fit now
+    BasicEvent* list = m_overflowEvents;
+    m_overflowEvents = NULL;
+    RequeueEvents(list);
+}
+
+void EventProcessor::RequeueEvents(BasicEvent* list)
+{
+    while (list)
+    {
+        BasicEvent* Event = list;
+        list = list->m_next;
+        QueueEvent(Event);
+    }
+}
+
+void EventProcessor::QueueEvent(BasicEvent* Event)
+{
+    uint64 e_time = Event->m_execTime;
+    if (e_time < m_wheelTime)
+    {
+        Event->m_queue = EVENT_QUEUE_LATE;
+        LinkEventByTime(m_lateEvents, Event);
+        return;
+    }
+
+    // level selected by distance, so level 0 slot contain events of one execution time only
+    uint64 delta = e_time - m_wheelTime;
+    for (uint32 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+    {
+        if (delta < (uint64(1) << ((level + 1) * WHEEL_SLOT_BITS)))
+        {
+            uint32 slot = uint32((e_time >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK);
+            Event->m_queue = uint8(level);
+            Event->m_slot = uint8(slot);
+            BasicEvent*& head = m_wheel->slots[level][slot];
+            if (!level && head && SeqBefore(Event->m_seq, head->m_prev->m_seq))
+                m_wheel->unordered |= uint64(1) << slot;
+            LinkEvent(head, Event);
+            m_wheel->occupied[level] |= uint64(1) << slot;
+            return;
+        }
+    }
+
+    Event->m_queue = EVENT_QUEUE_OVERFLOW;
+    LinkEvent(m_overflowEvents, Event);
+}
+
+void EventProcessor::DequeueEvent(BasicEvent* Event)
+{
+    switch (Event->m_queue)
+    {
+        case EVENT_QUEUE_LATE:
+            UnlinkEvent(m_lateEvents, Event);
+            break;
+        case EVENT_QUEUE_OVERFLOW:
+            UnlinkEvent(m_overflowEvents, Event);
+            break;
+        default:
+        {
+            BasicEvent*& head = m_wheel->slots[Event->m_queue][Event->m_slot];
+            UnlinkEvent(head, Event);
+            if (!head)
+            {
+                m_wheel->occupied[Event->m_queue] &= ~(uint64(1) << Event->m_slot);
+                if (!Event->m_queue)
+                    m_wheel->unordered &= ~(uint64(1) << Event->m_slot);
+            }
+            break;
+        }
+    }
+
+    Event->m_queue = EVENT_NOT_QUEUED;
+    --m_eventCount;
+}
+
+void EventProcessor::ReleaseWheel()
+{
+    if (!m_wheel)
+        return;
+
+    ReleaseBlock(POOL_WHEEL_CLASS, m_wheel);
+    m_wheel = NULL;
 }
 
 void EventProcessor::KillAllEvents()
@@ -63,23 +405,81 @@ void EventProcessor::KillAllEvents()
     // prevent event insertions
     m_aborting = true;
 
-    // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    if (!m_eventCount)
+        return;
+
+    // collect events to abort them in execution order
+    std::vector<BasicEvent*> events;
+    events.reserve(m_eventCount);
+
+    for (BasicEvent* Event = m_lateEvents; Event; Event = Event->m_next)
+        events.push_back(Event);
+    for (BasicEvent* Event = m_overflowEvents; Event; Event = Event->m_next)
+        events.push_back(Event);
+    for (uint32 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+        for (uint32 slot = 0; slot < WHEEL_SLOTS; ++slot)
+            for (BasicEvent* Event = m_wheel->slots[level][slot]; Event; Event = Event->m_next)
+                events.push_back(Event);
+
+    std::sort(events.begin(), events.end(), &EventProcessor::ExecutesBefore);
+
+    // clear queues
+    m_lateEvents = NULL;
+    m_overflowEvents = NULL;
+    memset(m_wheel, 0, sizeof(EventWheel));
+    m_eventCount = 0;
+
+    // abort all existing events
+    for (std::vector<BasicEvent*>::const_iterator i = events.begin(); i != events.end(); ++i)
     {
-        i->second->to_Abort = true;
-        i->second->Abort(m_time);
-        delete i->second;
+        BasicEvent* Event = *i;
+        Event->m_prev = NULL;
+        Event->m_next = NULL;
+        Event->m_queue = EVENT_NOT_QUEUED;
+        Event->to_Abort = true;
+        Event->Abort(m_time);
+        delete Event;
     }
 
-    // clear event list
-    m_events.clear();
+    // wheel still used by running update loop
+    if (!m_processing && !m_eventCount)
+    {
+        ReleaseWheel();
+        m_wheelTime = m_time + 1;
+    }
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
 {
     if (set_addtime) Event->m_addTime = m_time;
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Event->m_seq = m_nextSeq++;
+
+    if (!m_wheel)
+    {
+        m_wheel = static_cast<EventWheel*>(AllocateBlock(POOL_WHEEL_CLASS, sizeof(EventWheel)));
+        memset(m_wheel, 0, sizeof(EventWheel));
+    }
+
+    // empty wheel can start from current time
+    if (!m_eventCount && !m_processing)
+        m_wheelTime = m_time + 1;
+
+    ++m_eventCount;
+    QueueEvent(Event);
+}
+
+void EventProcessor::AbortEvent(BasicEvent* Event)
+{
+    Event->to_Abort = true;
+
+    // event in Execute call now, abort at its re-added time if any
+    if (Event->m_queue == EVENT_NOT_QUEUED)
+        return;
+
+    DequeueEvent(Event);
+    Event->Abort(m_time);
+    delete Event;
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset)
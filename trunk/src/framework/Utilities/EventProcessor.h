@@ -21,14 +21,26 @@
 
 #include "Platform/Define.h"
 
-#include<map>
+#include <stddef.h>
 
 // Note. All times are in milliseconds here.
 
+enum EventQueueId
+{
+    // 0 .. EVENT_WHEEL_LEVELS-1 are timing wheel levels
+    EVENT_WHEEL_LEVELS      = 4,
+    EVENT_QUEUE_LATE        = EVENT_WHEEL_LEVELS,           // execution time already passed by wheel
+    EVENT_QUEUE_OVERFLOW    = EVENT_WHEEL_LEVELS + 1,       // execution time beyond top wheel level
+    EVENT_NOT_QUEUED        = 0xFF
+};
+
 class BasicEvent
 {
+    friend class EventProcessor;
+
     public:
-        BasicEvent() { to_Abort = false; }
+        BasicEvent() : to_Abort(false), m_addTime(0), m_execTime(0),
+            m_prev(NULL), m_next(NULL), m_seq(0), m_queue(EVENT_NOT_QUEUED), m_slot(0) {}
         virtual ~BasicEvent()                               // override destructor to perform some actions on event removal
         {
         };
@@ -40,29 +52,85 @@ class BasicEvent
 
         virtual void Abort(uint64 /*e_time*/) {}            // this method executes when the event is aborted
 
+        // events are created and destroyed at high rate, memory blocks are reused through size class free lists
+        static void* operator new(size_t size);
+        static void operator delete(void* p, size_t size);
+
         bool to_Abort;                                      // set by externals when the event is aborted, aborted events don't execute
         // and get Abort call when deleted
 
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+    private:
+        // intrusive links in event processor queue, for queue head m_prev point to queue tail
+        BasicEvent* m_prev;
+        BasicEvent* m_next;
+        uint32 m_seq;                                       // add order, events with same execution time executed in add order
+        uint8 m_queue;                                      // EventQueueId
+        uint8 m_slot;                                       // slot in wheel level
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+struct EventWheel;
 
+/**
+ * Event queue with hierarchical timing wheel (4 levels of 64 slots, 1 ms resolution at level 0).
+ *
+ * Events are linked intrusively into wheel slots, so adding and aborting an event not allocate
+ * and not depend on the number of queued events. Events of higher levels are moved down when the
+ * wheel passes their 64 ms (4 s, 4.4 min) block, events planned more than 4.6 hours ahead wait
+ * in an overflow list. Wheel memory is taken only while events are queued and Update of an idle
+ * processor only advances the time.
+ *
+ * Events are executed in order of execution time and for same time in add order, same as for
+ * ordered map. Slots are filled by append, a level 0 slot which got events out of add order by
+ * cascading is sorted once before its time is processed. Events added from Execute with time not after current time still execute in
+ * the same Update.
+ */
 class EventProcessor
 {
     public:
         EventProcessor();
         ~EventProcessor();
 
-        void Update(uint32 p_time);
+        void Update(uint32 p_time)
+        {
+            // update time
+            m_time += p_time;
+
+            if (m_eventCount)
+                ProcessEvents(p_time);
+        }
         void KillAllEvents();
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
+        void AbortEvent(BasicEvent* Event);                 // abort and delete queued event immediately
         uint64 CalculateTime(uint64 t_offset);
+        uint32 GetEventCount() const { return m_eventCount; }
     protected:
         uint64 m_time;
-        EventList m_events;
         bool m_aborting;
+    private:
+        void ProcessEvents(uint32 p_time);
+        void QueueEvent(BasicEvent* Event);
+        void DequeueEvent(BasicEvent* Event);
+        void AdvanceWheel();
+        void CascadeWheel();
+        void RequeueEvents(BasicEvent* list);
+        void ReleaseWheel();
+
+        static bool ExecutesBefore(BasicEvent const* a, BasicEvent const* b);
+        static void LinkEvent(BasicEvent*& head, BasicEvent* Event);
+        static void LinkEventByTime(BasicEvent*& head, BasicEvent* Event);
+        static void SortEvents(BasicEvent*& head);
+        static void UnlinkEvent(BasicEvent*& head, BasicEvent* Event);
+
+        EventWheel* m_wheel;
+        BasicEvent* m_lateEvents;                           // ordered by execution time
+        BasicEvent* m_overflowEvents;
+        uint64 m_wheelTime;                                 // first time not processed yet
+        uint32 m_eventCount;
+        uint32 m_nextSeq;
+        bool m_processing;
 };
 #endif
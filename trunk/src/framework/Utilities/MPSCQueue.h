@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MPSCQUEUE_H
+#define MANGOS_MPSCQUEUE_H
+
+#include "Platform/CompilerDefs.h"
+
+#include <stddef.h>
+
+#if COMPILER == COMPILER_MICROSOFT
+#  include <windows.h>
+#endif
+
+namespace MaNGOS
+{
+    // atomic compare and swap of pointer with full memory barrier, true if swapped
+    inline bool AtomicCompareAndSwapPtr(void* volatile* dest, void* comparand, void* exchange)
+    {
+#if COMPILER == COMPILER_MICROSOFT
+        return InterlockedCompareExchangePointer((PVOID volatile*)dest, exchange, comparand) == comparand;
+#else
+        return __sync_bool_compare_and_swap(dest, comparand, exchange);
+#endif
+    }
+
+    // atomic exchange of pointer, acquire memory barrier at least
+    inline void* AtomicExchangePtr(void* volatile* dest, void* exchange)
+    {
+#if COMPILER == COMPILER_MICROSOFT
+        return InterlockedExchangePointer((PVOID volatile*)dest, exchange);
+#else
+        return __sync_lock_test_and_set(dest, exchange);
+#endif
+    }
+}
+
+/**
+ * Lock-free intrusive multi-producer single-consumer queue.
+ *
+ * Any thread can Push, one thread takes all queued items at once by PopAll. Items are linked
+ * through their own T* member given as template parameter, so queueing not allocate memory.
+ * Push is one compare and swap (retried only at concurrent push), PopAll is one exchange and
+ * list reversal. Items pushed by one thread are returned in push order.
+ */
+template<class T, T* T::*Next>
+class MPSCQueue
+{
+    public:
+        MPSCQueue() : i_head(NULL) {}
+
+        void Push(T* item)
+        {
+            void* head;
+            do
+            {
+                head = i_head;
+                item->*Next = static_cast<T*>(head);
+            }
+            while(!MaNGOS::AtomicCompareAndSwapPtr(&i_head, head, item));
+        }
+
+        // first of all queued items in push order (linked by Next), NULL if queue empty
+        T* PopAll()
+        {
+            if(!i_head)
+                return NULL;
+
+            T* item = static_cast<T*>(MaNGOS::AtomicExchangePtr(&i_head, NULL));
+
+            // items are pushed in front, reverse list to push order
+            T* first = NULL;
+            while(item)
+            {
+                T* next = item->*Next;
+                item->*Next = first;
+                first = item;
+                item = next;
+            }
+            return first;
+        }
+
+        bool empty() const { return i_head == NULL; }
+
+    private:
+        MPSCQueue(MPSCQueue const&);
+        MPSCQueue& operator=(MPSCQueue const&);
+
+        void* volatile i_head;
+};
+
+#endif
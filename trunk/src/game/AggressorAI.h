@@ -42,6 +42,7 @@ class MANGOS_DLL_DECL AggressorAI : public CreatureAI
         bool IsVisible(Unit *) const;
 
         void UpdateAI(const uint32);
+        bool CanSleep() const { return true; }
         static int Permissible(const Creature *);
 
     private:
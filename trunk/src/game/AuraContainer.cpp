@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "AuraContainer.h"
+
+#include <assert.h>
+
+uint32 const AuraContainer::END_INDEX;
+
+size_t AuraContainer::TypeList::size() const
+{
+    size_t count = 0;
+    for(const_iterator itr = begin(); itr != end(); ++itr)
+        ++count;
+    return count;
+}
+
+AuraContainer::AuraContainer() : i_count(0)
+{
+    for(int i = 0; i < TOTAL_AURAS; ++i)
+        i_typeHead[i] = NIL_SLOT;
+}
+
+size_t AuraContainer::count(key_type const& key) const
+{
+    size_t count = 0;
+    for(std::vector<Slot>::const_iterator itr = i_slots.begin(); itr != i_slots.end(); ++itr)
+        if(itr->value.second && itr->value.first == key)
+            ++count;
+    return count;
+}
+
+AuraContainer::iterator AuraContainer::insert(value_type const& value, uint32 type)
+{
+    assert(value.second);
+
+    // free slots not reused before Compact, TypeList iterators can still point to them
+    assert(i_slots.size() < NIL_SLOT);
+    uint32 index = i_slots.size();
+    i_slots.resize(index + 1);
+
+    Slot& slot = i_slots[index];
+    slot.value = value;
+    slot.type = TOTAL_AURAS;
+    slot.prevOfType = NIL_SLOT;
+    slot.nextOfType = NIL_SLOT;
+    ++i_count;
+
+    if(type < TOTAL_AURAS)
+        LinkType(index, type);
+
+    return iterator(this, index);
+}
+
+void AuraContainer::erase(iterator const& itr)
+{
+    Slot& slot = i_slots[itr.i_index];
+    assert(slot.value.second);
+
+    // slot stays linked in its type chain until Compact
+    slot.value.second = NULL;
+    --i_count;
+}
+
+void AuraContainer::clear()
+{
+    i_slots.clear();
+    i_count = 0;
+    for(int i = 0; i < TOTAL_AURAS; ++i)
+        i_typeHead[i] = NIL_SLOT;
+}
+
+void AuraContainer::LinkType(uint16 index, uint16 type)
+{
+    Slot& slot = i_slots[index];
+    slot.type = type;
+    slot.nextOfType = NIL_SLOT;
+
+    uint16 head = i_typeHead[type];
+    if(head == NIL_SLOT)
+    {
+        slot.prevOfType = index;
+        i_typeHead[type] = index;
+        return;
+    }
+
+    // append at tail (stored as prev of head) to keep apply order
+    uint16 tail = i_slots[head].prevOfType;
+    slot.prevOfType = tail;
+    i_slots[tail].nextOfType = index;
+    i_slots[head].prevOfType = index;
+}
+
+void AuraContainer::Compact()
+{
+    if(i_count == i_slots.size())
+        return;
+
+    for(int i = 0; i < TOTAL_AURAS; ++i)
+        i_typeHead[i] = NIL_SLOT;
+
+    // slots only appended, so index order is apply order and type chains can be rebuilt from it
+    uint16 used = 0;
+    for(uint32 i = 0; i < i_slots.size(); ++i)
+    {
+        if(!i_slots[i].value.second)
+            continue;
+
+        uint16 type = i_slots[i].type;
+        if(used != i)
+            i_slots[used] = i_slots[i];
+
+        if(type < TOTAL_AURAS)
+            LinkType(used, type);
+        ++used;
+    }
+    i_slots.resize(used);
+}
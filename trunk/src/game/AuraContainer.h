@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_AURACONTAINER_H
+#define MANGOS_AURACONTAINER_H
+
+#include "Common.h"
+#include "SpellAuraDefines.h"
+
+#include <vector>
+#include <utility>
+
+class Aura;
+
+/**
+ * Flat storage of the auras applied to one unit.
+ *
+ * Auras are kept in a small vector of slots and addressed by slot index. Removing an aura only
+ * marks its slot free, free slots stay in place and in their type chain until Compact(), so
+ * iterators stay valid while auras are added or removed during iteration and loops restarted
+ * from begin() see only current auras. Added auras are always appended. Slots of auras with same
+ * aura type are linked in an intrusive per type chain, replacing a std::list per aura type.
+ *
+ * Interface is the subset of std::multimap used for Unit::AuraMap. Storage is not ordered, so
+ * lower_bound(key)..upper_bound(key) is supported only as equal key range: lower_bound return
+ * an iterator skipping all other keys and upper_bound return end().
+ * Compact() invalidate all iterators and must be called only when no iteration is in progress.
+ */
+class MANGOS_DLL_SPEC AuraContainer
+{
+    public:
+        typedef std::pair<uint32, uint8> key_type;
+        typedef std::pair<key_type, Aura*> value_type;
+
+        enum { NIL_SLOT = 0xFFFF };
+        static uint32 const END_INDEX = 0xFFFFFFFF;
+
+        template<class C, class V>
+        class iterator_base
+        {
+            template<class C2, class V2> friend class iterator_base;
+            friend class AuraContainer;
+
+            public:
+                iterator_base() : i_container(NULL), i_index(END_INDEX), i_filtered(false) {}
+                iterator_base(C* container, uint32 index) : i_container(container), i_index(index), i_filtered(false) {}
+                iterator_base(C* container, uint32 index, key_type const& key) : i_container(container), i_index(index), i_key(key), i_filtered(true) {}
+
+                template<class C2, class V2>
+                iterator_base(iterator_base<C2, V2> const& i) : i_container(i.i_container), i_index(i.i_index), i_key(i.i_key), i_filtered(i.i_filtered) {}
+
+                V& operator*() const { return i_container->i_slots[i_index].value; }
+                V* operator->() const { return &i_container->i_slots[i_index].value; }
+
+                iterator_base& operator++()
+                {
+                    if(i_index != END_INDEX)
+                        i_index = i_container->NextUsedSlot(i_index + 1, i_filtered ? &i_key : NULL);
+                    return *this;
+                }
+
+                iterator_base operator++(int)
+                {
+                    iterator_base tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+
+                template<class C2, class V2>
+                bool operator==(iterator_base<C2, V2> const& i) const { return i_index == i.i_index; }
+                template<class C2, class V2>
+                bool operator!=(iterator_base<C2, V2> const& i) const { return i_index != i.i_index; }
+
+            private:
+                C* i_container;
+                uint32 i_index;                             // END_INDEX for end(), stable at slot vector grow
+                key_type i_key;
+                bool i_filtered;
+        };
+
+        typedef iterator_base<AuraContainer, value_type> iterator;
+        typedef iterator_base<AuraContainer const, value_type const> const_iterator;
+
+        // auras of one aura type in apply order, light view into the container
+        class TypeList
+        {
+            public:
+                class const_iterator
+                {
+                    public:
+                        const_iterator() : i_container(NULL), i_slot(NIL_SLOT) {}
+                        const_iterator(AuraContainer const* container, uint16 slot) : i_container(container), i_slot(slot) { SkipFree(); }
+
+                        Aura* operator*() const { return i_container->i_slots[i_slot].value.second; }
+
+                        // free slots stay linked until Compact, so current aura can be removed before increment
+                        const_iterator& operator++() { i_slot = i_container->i_slots[i_slot].nextOfType; SkipFree(); return *this; }
+                        const_iterator operator++(int) { const_iterator tmp = *this; ++*this; return tmp; }
+
+                        bool operator==(const_iterator const& i) const { return i_slot == i.i_slot; }
+                        bool operator!=(const_iterator const& i) const { return i_slot != i.i_slot; }
+
+                    private:
+                        void SkipFree()
+                        {
+                            while(i_slot != NIL_SLOT && !i_container->i_slots[i_slot].value.second)
+                                i_slot = i_container->i_slots[i_slot].nextOfType;
+                        }
+
+                        AuraContainer const* i_container;
+                        uint16 i_slot;
+                };
+                typedef const_iterator iterator;
+
+                TypeList(AuraContainer const* container, uint32 type) : i_container(container), i_type(type) {}
+
+                // chain head read at each call, list can be kept over aura add/remove
+                const_iterator begin() const { return const_iterator(i_container, i_type < TOTAL_AURAS ? i_container->i_typeHead[i_type] : uint16(NIL_SLOT)); }
+                const_iterator end() const { return const_iterator(i_container, NIL_SLOT); }
+                bool empty() const { return begin() == end(); }
+                Aura* front() const { return *begin(); }
+                size_t size() const;
+
+            private:
+                AuraContainer const* i_container;
+                uint32 i_type;
+        };
+
+        AuraContainer();
+
+        iterator begin() { return iterator(this, NextUsedSlot(0, NULL)); }
+        iterator end() { return iterator(this, END_INDEX); }
+        const_iterator begin() const { return const_iterator(this, NextUsedSlot(0, NULL)); }
+        const_iterator end() const { return const_iterator(this, END_INDEX); }
+
+        size_t size() const { return i_count; }
+        bool empty() const { return i_count == 0; }
+
+        iterator find(key_type const& key) { return iterator(this, NextUsedSlot(0, &key)); }
+        const_iterator find(key_type const& key) const { return const_iterator(this, NextUsedSlot(0, &key)); }
+        size_t count(key_type const& key) const;
+
+        iterator lower_bound(key_type const& key) { return iterator(this, NextUsedSlot(0, &key), key); }
+        iterator upper_bound(key_type const& /*key*/) { return end(); }
+        const_iterator lower_bound(key_type const& key) const { return const_iterator(this, NextUsedSlot(0, &key), key); }
+        const_iterator upper_bound(key_type const& /*key*/) const { return end(); }
+
+        // type >= TOTAL_AURAS for auras not listed by type
+        iterator insert(value_type const& value, uint32 type);
+        void erase(iterator const& itr);
+        void clear();
+
+        TypeList GetByType(uint32 type) const { return TypeList(this, type); }
+
+        // drop free slots, invalidate all iterators
+        void Compact();
+
+    private:
+        struct Slot
+        {
+            value_type value;                               // value.second is NULL for free slot
+            uint16 type;                                    // TOTAL_AURAS if not linked in type chain
+            uint16 prevOfType;                              // for chain head: chain tail
+            uint16 nextOfType;
+        };
+
+        uint32 NextUsedSlot(uint32 index, key_type const* key) const
+        {
+            for(; index < i_slots.size(); ++index)
+                if(i_slots[index].value.second && (!key || i_slots[index].value.first == *key))
+                    return index;
+            return END_INDEX;
+        }
+
+        void LinkType(uint16 slot, uint16 type);
+
+        std::vector<Slot> i_slots;
+        uint32 i_count;
+        uint16 i_typeHead[TOTAL_AURAS];
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "AuraModifierCache.h"
+
+bool AuraModifierCache::s_enabled = true;
+
+AuraModifierCache::AuraModifierCache() : i_entries(NULL)
+{
+    memset(i_cachedTypes, 0, sizeof(i_cachedTypes));
+}
+
+AuraModifierCache::~AuraModifierCache()
+{
+    delete[] i_entries;
+}
+
+uint32 AuraModifierCache::Index(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue)
+{
+    uint32 h = (uint32(type) * 2654435761U) ^ (uint32(filterValue) * 40503U) ^ (uint32(aggregate) << 3) ^ (uint32(filter) << 5);
+    return (h ^ (h >> 16)) & (CACHE_SIZE - 1);
+}
+
+AuraModifierCache::Entry const* AuraModifierCache::Find(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue) const
+{
+    if(!i_entries || !s_enabled)
+        return NULL;
+
+    Entry const& entry = i_entries[Index(type, aggregate, filter, filterValue)];
+    if(entry.filter != filter || entry.type != type || entry.aggregate != aggregate || entry.filterValue != filterValue)
+        return NULL;
+
+    return &entry;
+}
+
+AuraModifierCache::Entry& AuraModifierCache::Prepare(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue)
+{
+    if(!i_entries)
+    {
+        i_entries = new Entry[CACHE_SIZE];
+        for(int i = 0; i < CACHE_SIZE; ++i)
+            i_entries[i].filter = FREE_ENTRY;
+    }
+
+    // replaced entry can be of other type, its type bit just stay set until next invalidate
+    Entry& entry = i_entries[Index(type, aggregate, filter, filterValue)];
+    entry.filterValue = filterValue;
+    entry.type = type;
+    entry.aggregate = aggregate;
+    entry.filter = filter;
+    i_cachedTypes[type >> 5] |= 1 << (type & 31);
+    return entry;
+}
+
+bool AuraModifierCache::Lookup(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, int32& value) const
+{
+    Entry const* entry = Find(type, aggregate, filter, filterValue);
+    if(!entry)
+        return false;
+
+    value = entry->value.i;
+    return true;
+}
+
+bool AuraModifierCache::Lookup(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, float& value) const
+{
+    Entry const* entry = Find(type, aggregate, filter, filterValue);
+    if(!entry)
+        return false;
+
+    value = entry->value.f;
+    return true;
+}
+
+void AuraModifierCache::Store(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, int32 value)
+{
+    if(s_enabled && type < TOTAL_AURAS)
+        Prepare(type, aggregate, filter, filterValue).value.i = value;
+}
+
+void AuraModifierCache::Store(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, float value)
+{
+    if(s_enabled && type < TOTAL_AURAS)
+        Prepare(type, aggregate, filter, filterValue).value.f = value;
+}
+
+void AuraModifierCache::InvalidateCachedType(AuraType type)
+{
+    i_cachedTypes[type >> 5] &= ~(1 << (type & 31));
+
+    if(!i_entries)
+        return;
+
+    for(int i = 0; i < CACHE_SIZE; ++i)
+        if(i_entries[i].filter != FREE_ENTRY && i_entries[i].type == type)
+            i_entries[i].filter = FREE_ENTRY;
+}
+
+void AuraModifierCache::Clear()
+{
+    memset(i_cachedTypes, 0, sizeof(i_cachedTypes));
+
+    if(!i_entries)
+        return;
+
+    for(int i = 0; i < CACHE_SIZE; ++i)
+        i_entries[i].filter = FREE_ENTRY;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_AURAMODIFIERCACHE_H
+#define MANGOS_AURAMODIFIERCACHE_H
+
+#include "Common.h"
+#include "SpellAuraDefines.h"
+
+enum AuraAggregateType
+{
+    AURA_AGGREGATE_TOTAL        = 0,                        // sum of amounts
+    AURA_AGGREGATE_MULTIPLIER   = 1,                        // product of (100+amount)/100
+    AURA_AGGREGATE_MAX_POSITIVE = 2,
+    AURA_AGGREGATE_MAX_NEGATIVE = 3
+};
+
+enum AuraAggregateFilter
+{
+    AURA_FILTER_NONE            = 0,
+    AURA_FILTER_MISC_MASK       = 1,
+    AURA_FILTER_MISC_VALUE      = 2
+};
+
+/**
+ * Per unit cache of aggregated aura modifiers (Unit::GetTotalAuraModifier and friends).
+ *
+ * Small direct mapped table keyed by aura type, aggregate and misc mask/value, allocated
+ * at first store so units never asked for totals not pay for it. The owner must call
+ * Invalidate(type) at any change of auras of this type or their amounts (aura add/remove,
+ * Aura::ApplyModifier, absorb amount decrease); types never cached are skipped by bit test.
+ */
+class MANGOS_DLL_SPEC AuraModifierCache
+{
+    public:
+        AuraModifierCache();
+        ~AuraModifierCache();
+
+        bool Lookup(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, int32& value) const;
+        bool Lookup(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, float& value) const;
+        void Store(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, int32 value);
+        void Store(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue, float value);
+
+        void Invalidate(AuraType type)
+        {
+            if(type < TOTAL_AURAS && (i_cachedTypes[type >> 5] & (1 << (type & 31))))
+                InvalidateCachedType(type);
+        }
+        void Clear();
+
+        // used by benchmark to compare with uncached aura list walk
+        static void SetEnabled(bool enabled) { s_enabled = enabled; }
+        static bool IsEnabled() { return s_enabled; }
+
+    private:
+        enum { CACHE_SIZE = 32, FREE_ENTRY = 0xFF };
+
+        struct Entry
+        {
+            int32 filterValue;
+            uint16 type;
+            uint8 aggregate;
+            uint8 filter;                                   // FREE_ENTRY for free entry
+            union
+            {
+                int32 i;
+                float f;
+            } value;
+        };
+
+        Entry const* Find(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue) const;
+        Entry& Prepare(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue);
+        static uint32 Index(AuraType type, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue);
+        void InvalidateCachedType(AuraType type);
+
+        Entry* i_entries;
+        uint32 i_cachedTypes[(TOTAL_AURAS + 31) / 32];
+
+        static bool s_enabled;
+};
+
+#endif
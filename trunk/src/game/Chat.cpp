@@ -41,6 +41,11 @@ ChatCommand * ChatHandler::getCommandTable()
         { "idlerestart",    SEC_ADMINISTRATOR,  &ChatHandler::HandleIdleRestartCommand,         "", NULL },
         { "idleshutdown",   SEC_ADMINISTRATOR,  &ChatHandler::HandleIdleShutDownCommand,        "", NULL },
         { "info",           SEC_PLAYER,         &ChatHandler::HandleInfoCommand,                "", NULL },
+        { "movement",       SEC_ADMINISTRATOR,  &ChatHandler::HandleServerMovementCommand,      "", NULL },
+        { "network",        SEC_ADMINISTRATOR,  &ChatHandler::HandleServerNetworkCommand,       "", NULL },
+        { "opcodes",        SEC_ADMINISTRATOR,  &ChatHandler::HandleServerOpcodesCommand,       "", NULL },
+        { "pools",          SEC_ADMINISTRATOR,  &ChatHandler::HandleServerPoolsCommand,         "", NULL },
+        { "querycache",     SEC_ADMINISTRATOR,  &ChatHandler::HandleServerQueryCacheCommand,    "", NULL },
         { "restart",        SEC_ADMINISTRATOR,  &ChatHandler::HandleRestartCommand,             "", NULL },
         { "shutdown",       SEC_ADMINISTRATOR,  &ChatHandler::HandleShutDownCommand,            "", NULL },
         { NULL,             0,                  NULL,                                           "", NULL }
@@ -107,6 +112,9 @@ ChatCommand * ChatHandler::getCommandTable()
         { "Mod32Value",     SEC_ADMINISTRATOR,  &ChatHandler::HandleMod32Value,                 "", NULL },
         { "anim",           SEC_GAMEMASTER,     &ChatHandler::HandleAnimCommand,                "", NULL },
         { "lootrecipient",  SEC_GAMEMASTER,     &ChatHandler::HandleGetLootRecipient,           "", NULL },
+        { "loscache",       SEC_ADMINISTRATOR,  &ChatHandler::HandleDebugLoSCacheCommand,       "", NULL },
+        { "aurabench",      SEC_ADMINISTRATOR,  &ChatHandler::HandleDebugAuraBenchCommand,      "", NULL },
+        { "statupdates",    SEC_ADMINISTRATOR,  &ChatHandler::HandleDebugStatUpdatesCommand,    "", NULL },
         { NULL,             0,                  NULL,                                           "", NULL }
     };
 
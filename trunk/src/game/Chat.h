@@ -213,6 +213,9 @@ class ChatHandler
         bool HandleSendQuestInvalidMsgCommand(const char* args);
 
         bool HandleDebugInArcCommand(const char* args);
+        bool HandleDebugAuraBenchCommand(const char* args);
+        bool HandleDebugStatUpdatesCommand(const char* args);
+        bool HandleDebugLoSCacheCommand(const char* args);
         bool HandleDebugSpellFailCommand(const char* args);
 
         bool HandleGUIDCommand(const char* args);
@@ -254,6 +257,11 @@ class ChatHandler
         bool HandleBanInfoCommand(const char* args);
         bool HandleBanListCommand(const char* args);
         bool HandleIdleRestartCommand(const char* args);
+        bool HandleServerPoolsCommand(const char* args);
+        bool HandleServerQueryCacheCommand(const char* args);
+        bool HandleServerOpcodesCommand(const char* args);
+        bool HandleServerNetworkCommand(const char* args);
+        bool HandleServerMovementCommand(const char* args);
         bool HandleIdleShutDownCommand(const char* args);
         bool HandleShutDownCommand(const char* args);
         bool HandleRestartCommand(const char* args);
@@ -91,6 +91,8 @@ VendorItem const* VendorItemData::FindItem(uint32 item_id) const
     return NULL;
 }
 
+IMPLEMENT_POOLED_ALLOCATION(Creature)
+
 Creature::Creature() :
 Unit(), i_AI(NULL),
 lootForPickPocketed(false), lootForBody(false), m_groupLootTimer(0), lootingGroupLeaderGUID(0),
@@ -98,7 +100,7 @@ m_lootMoney(0), m_lootRecipient(0),
 m_deathTimer(0), m_respawnTime(0), m_respawnDelay(25), m_corpseDelay(60), m_respawnradius(0.0f),
 m_gossipOptionLoaded(false), m_emoteState(0), m_isPet(false), m_isTotem(false),
 m_regenTimer(2000), m_defaultMovementType(IDLE_MOTION_TYPE), m_equipmentId(0),
-m_AlreadyCallAssistence(false), m_regenHealth(true), m_AI_locked(false), m_isDeadByDefault(false),
+m_AlreadyCallAssistence(false), m_regenHealth(true), m_AI_locked(false), m_isDeadByDefault(false), m_idleSleepAllowed(true),
 m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL),m_creatureInfo(NULL), m_DBTableGuid(0)
 {
     m_valuesCount = UNIT_END;
@@ -428,6 +430,71 @@ void Creature::Update(uint32 diff)
         default:
             break;
     }
+
+    UpdateSleepState();
+}
+
+void Creature::UpdateSleepState()
+{
+    m_sleeping = false;
+
+    if(!m_idleSleepAllowed || !sWorld.getConfig(CONFIG_CREATURE_IDLE_SLEEP))
+        return;
+
+    if(m_deathState != ALIVE || m_isDeadByDefault || !i_AI || !i_AI->CanSleep())
+        return;
+
+    // AI update and combat related code active
+    if(isInCombat() || getVictim() || !getThreatManager().isThreatListEmpty() || IsInEvadeMode())
+        return;
+
+    // timers and objects processed in Unit::Update
+    if(m_regenTimer == 0 || m_Events.GetEventCount() || !m_gameObj.empty())
+        return;
+
+    for(uint32 i = 0; i < CURRENT_MAX_SPELL; ++i)
+        if(m_currentSpells[i])
+            return;
+
+    for(int i = 0; i < MAX_REACTIVE; ++i)
+        if(m_reactiveTimer[i])
+            return;
+
+    if(i_motionMaster.GetCurrentMovementGeneratorType() != IDLE_MOTION_TYPE)
+        return;
+
+    for(AuraMap::const_iterator itr = m_Auras.begin(); itr != m_Auras.end(); ++itr)
+        if(!itr->second->IsUpdateIdle())
+            return;
+
+    m_sleeping = true;
+}
+
+bool Creature::UpdateSleeping(uint32 diff)
+{
+    if(!m_sleeping)
+        return false;
+
+    // regeneration tick and anything started by not waking code do full update
+    if(m_regenTimer <= diff || m_Events.GetEventCount() || isInCombat() || getVictim() || !getThreatManager().isThreatListEmpty())
+    {
+        m_sleeping = false;
+        return false;
+    }
+
+    // same timer changes as Creature::Update of idle creature
+    if(m_GlobalCooldown <= diff)
+        m_GlobalCooldown = 0;
+    else
+        m_GlobalCooldown -= diff;
+
+    m_Events.Update(diff);
+
+    if(uint32 base_att = getAttackTimer(BASE_ATTACK))
+        setAttackTimer(BASE_ATTACK, (diff >= base_att ? 0 : base_att - diff) );
+
+    m_regenTimer -= diff;
+    return true;
 }
 
 void Creature::RegenerateMana()
@@ -489,6 +556,8 @@ void Creature::RegenerateHealth()
 
 bool Creature::AIM_Initialize()
 {
+    WakeUp();
+
     // make sure nothing can change the AI during AI update
     if(m_AI_locked)
     {
@@ -1458,6 +1527,8 @@ float Creature::GetAttackDistance(Unit const* pl) const
 
 void Creature::setDeathState(DeathState s)
 {
+    WakeUp();
+
     if((s == JUST_DIED && !m_isDeadByDefault)||(s == JUST_ALIVED && m_isDeadByDefault))
     {
         m_deathTimer = m_corpseDelay*1000;
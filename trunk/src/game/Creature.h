@@ -371,6 +371,8 @@ class MANGOS_DLL_SPEC Creature : public Unit
         explicit Creature();
         virtual ~Creature();
 
+        DECLARE_POOLED_ALLOCATION(Creature)
+
         void AddToWorld();
         void RemoveFromWorld();
 
@@ -383,6 +385,9 @@ class MANGOS_DLL_SPEC Creature : public Unit
         char const* GetSubName() const { return GetCreatureInfo()->SubName; }
 
         void Update( uint32 time );                         // overwrited Unit::Update
+
+        // skipped update of sleeping (idle) creature, return false if full Update call required
+        bool UpdateSleeping(uint32 diff);
         void GetRespawnCoord(float &x, float &y, float &z, float* ori = NULL, float* dist =NULL) const;
         uint32 GetEquipmentId() const { return m_equipmentId; }
 
@@ -603,6 +608,8 @@ class MANGOS_DLL_SPEC Creature : public Unit
         bool m_regenHealth;
         bool m_AI_locked;
         bool m_isDeadByDefault;
+        bool m_idleSleepAllowed;                            // false for creatures with own Update timers (pets, totems, summons)
+        void UpdateSleepState();
 
         SpellSchoolMask m_meleeDamageSchoolMask;
         uint32 m_originalEntry;
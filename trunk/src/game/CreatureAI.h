@@ -62,6 +62,9 @@ class MANGOS_DLL_SPEC CreatureAI
         // Called at World update tick
         virtual void UpdateAI(const uint32 diff ) = 0;
 
+        // UpdateAI is no-op while creature not in combat and has empty threat list, allow skip idle creature updates
+        virtual bool CanSleep() const { return false; }
+
         // Called when the creature is killed
         virtual void JustDied(Unit *) {}
 
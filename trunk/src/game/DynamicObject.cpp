@@ -31,6 +31,8 @@
 #include "CellImpl.h"
 #include "GridNotifiersImpl.h"
 
+IMPLEMENT_POOLED_ALLOCATION(DynamicObject)
+
 DynamicObject::DynamicObject() : WorldObject()
 {
     m_objectType |= TYPEMASK_DYNAMICOBJECT;
@@ -30,6 +30,8 @@ class DynamicObject : public WorldObject
         typedef std::set<Unit*> AffectedSet;
         explicit DynamicObject();
 
+        DECLARE_POOLED_ALLOCATION(DynamicObject)
+
         void AddToWorld();
         void RemoveFromWorld();
 
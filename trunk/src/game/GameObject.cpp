@@ -37,6 +37,8 @@
 #include "BattleGround.h"
 #include "Util.h"
 
+IMPLEMENT_POOLED_ALLOCATION(GameObject)
+
 GameObject::GameObject() : WorldObject()
 {
     m_objectType |= TYPEMASK_GAMEOBJECT;
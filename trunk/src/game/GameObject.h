@@ -413,6 +413,8 @@ class MANGOS_DLL_SPEC GameObject : public WorldObject
         explicit GameObject();
         ~GameObject();
 
+        DECLARE_POOLED_ALLOCATION(GameObject)
+
         void AddToWorld();
         void RemoveFromWorld();
 
@@ -22,6 +22,7 @@
 #include "Opcodes.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
+#include "QueryResponseCache.h"
 
 GossipMenu::GossipMenu()
 {
@@ -482,6 +483,13 @@ void PlayerMenu::SendQuestGiverQuestDetails( Quest const *pQuest, uint64 npcGUID
 
 void PlayerMenu::SendQuestQueryResponse( Quest const *pQuest )
 {
+    int loc_idx = pSession->GetSessionDbLocaleIndex();
+    if (WorldPacket const* cached = sQueryResponseCache.Find(QUERY_CACHE_QUEST, pQuest->GetQuestId(), loc_idx))
+    {
+        pSession->SendPacket( cached );
+        return;
+    }
+
     std::string Title,Details,Objectives,EndText;
     std::string ObjectiveText[QUEST_OBJECTIVES_COUNT];
     Title = pQuest->GetTitle();
@@ -491,7 +499,6 @@ void PlayerMenu::SendQuestQueryResponse( Quest const *pQuest )
     for (int i=0;i<QUEST_OBJECTIVES_COUNT;i++)
         ObjectiveText[i]=pQuest->ObjectiveText[i];
 
-    int loc_idx = pSession->GetSessionDbLocaleIndex();
     if (loc_idx >= 0)
     {
         QuestLocale const *ql = objmgr.GetQuestLocale(pQuest->GetQuestId());
@@ -596,6 +603,7 @@ void PlayerMenu::SendQuestQueryResponse( Quest const *pQuest )
     for (iI = 0; iI < QUEST_OBJECTIVES_COUNT; iI++)
         data << ObjectiveText[iI];
 
+    sQueryResponseCache.Store(QUERY_CACHE_QUEST, pQuest->GetQuestId(), loc_idx, data);
     pSession->SendPacket( &data );
     sLog.outDebug( "WORLD: Sent SMSG_QUEST_QUERY_RESPONSE questid=%u",pQuest->GetQuestId() );
 }
@@ -150,6 +150,44 @@ MessageDeliverer::Visit(PlayerMapType &m)
     }
 }
 
+void
+MovementMessageDeliverer::Visit(PlayerMapType &m)
+{
+    for(PlayerMapType::iterator iter=m.begin(); iter != m.end(); ++iter)
+    {
+        Player* viewer = iter->getSource();
+        if(viewer == &i_player)
+            continue;
+
+        WorldSession* session = viewer->GetSession();
+        if(!session)
+            continue;
+
+        // distant viewers get every 2nd (near tier) or 4th (far tier) heartbeat
+        if(i_heartbeat && (i_nearDistSq > 0.0f || i_farDistSq > 0.0f))
+        {
+            float dx = viewer->GetPositionX() - i_player.GetPositionX();
+            float dy = viewer->GetPositionY() - i_player.GetPositionY();
+            float distSq = dx*dx + dy*dy;
+
+            uint32 mask = 0;
+            if(i_farDistSq > 0.0f && distSq > i_farDistSq)
+                mask = 3;
+            else if(i_nearDistSq > 0.0f && distSq > i_nearDistSq)
+                mask = 1;
+
+            if(i_heartbeat & mask)
+            {
+                ++i_skipped;
+                continue;
+            }
+        }
+
+        session->SendPacket(i_message);
+        ++i_sent;
+    }
+}
+
 void
 ObjectMessageDeliverer::Visit(PlayerMapType &m)
 {
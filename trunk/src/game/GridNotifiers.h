@@ -97,6 +97,21 @@ namespace MaNGOS
         template<class SKIP> void Visit(GridRefManager<SKIP> &) {}
     };
 
+    struct MANGOS_DLL_DECL MovementMessageDeliverer
+    {
+        Player &i_player;
+        WorldPacket *i_message;
+        uint32 i_heartbeat;                                 // relayed heartbeat number of player, 0 for other movement
+        float i_nearDistSq;
+        float i_farDistSq;
+        uint32 i_sent;
+        uint32 i_skipped;
+        MovementMessageDeliverer(Player &pl, WorldPacket *msg, uint32 heartbeat, float nearDistSq, float farDistSq)
+            : i_player(pl), i_message(msg), i_heartbeat(heartbeat), i_nearDistSq(nearDistSq), i_farDistSq(farDistSq), i_sent(0), i_skipped(0) {}
+        void Visit(PlayerMapType &m);
+        template<class SKIP> void Visit(GridRefManager<SKIP> &) {}
+    };
+
     struct MANGOS_DLL_DECL ObjectMessageDeliverer
     {
         WorldPacket *i_message;
@@ -356,18 +371,29 @@ namespace MaNGOS
     };
 
     // All accepted by Check units if any
+    // std::list<Unit*> constructor kept for scripts, core code uses pooled UnitList
     template<class Check>
         struct MANGOS_DLL_DECL UnitListSearcher
     {
-        std::list<Unit*> &i_objects;
+        UnitList* i_objects;
+        std::list<Unit*>* i_plainObjects;
         Check& i_check;
 
-        UnitListSearcher(std::list<Unit*> &objects, Check & check) : i_objects(objects),i_check(check) {}
+        UnitListSearcher(UnitList &objects, Check & check) : i_objects(&objects),i_plainObjects(NULL),i_check(check) {}
+        UnitListSearcher(std::list<Unit*> &objects, Check & check) : i_objects(NULL),i_plainObjects(&objects),i_check(check) {}
 
         void Visit(PlayerMapType &m);
         void Visit(CreatureMapType &m);
 
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
+
+        void AddUnit(Unit* u)
+        {
+            if(i_objects)
+                i_objects->push_back(u);
+            else
+                i_plainObjects->push_back(u);
+        }
     };
 
     // Creature searchers
@@ -42,7 +42,7 @@ inline void
 MaNGOS::ObjectUpdater::Visit(CreatureMapType &m)
 {
     for(CreatureMapType::iterator iter=m.begin(); iter != m.end(); ++iter)
-        if(!iter->getSource()->isSpiritService())
+        if(!iter->getSource()->isSpiritService() && !iter->getSource()->UpdateSleeping(i_timeDiff))
             iter->getSource()->Update(i_timeDiff);
 }
 
@@ -421,7 +421,7 @@ void MaNGOS::UnitListSearcher<Check>::Visit(PlayerMapType &m)
 {
     for(PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
         if(i_check(itr->getSource()))
-            i_objects.push_back(itr->getSource());
+            AddUnit(itr->getSource());
 }
 
 template<class Check>
@@ -429,7 +429,7 @@ void MaNGOS::UnitListSearcher<Check>::Visit(CreatureMapType &m)
 {
     for(CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
         if(i_check(itr->getSource()))
-            i_objects.push_back(itr->getSource());
+            AddUnit(itr->getSource());
 }
 
 // Creature searchers
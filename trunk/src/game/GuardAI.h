@@ -43,6 +43,7 @@ class MANGOS_DLL_DECL GuardAI : public CreatureAI
         bool IsVisible(Unit *) const;
 
         void UpdateAI(const uint32);
+        bool CanSleep() const { return true; }
         static int Permissible(const Creature *);
 
     private:
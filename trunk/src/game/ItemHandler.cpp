@@ -27,6 +27,7 @@
 #include "Item.h"
 #include "UpdateData.h"
 #include "ObjectAccessor.h"
+#include "QueryResponseCache.h"
 
 void WorldSession::HandleSplitItemOpcode( WorldPacket & recv_data )
 {
@@ -257,6 +258,9 @@ void WorldSession::HandleItemQuerySingleOpcode( WorldPacket & recv_data )
 {
     CHECK_PACKET_SIZE(recv_data, 4);
 
+    // called in network thread, see QueryResponseCache
+    ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getReadLock());
+
     //sLog.outDebug("WORLD: CMSG_ITEM_QUERY_SINGLE");
     uint32 item;
     recv_data >> item;
@@ -266,10 +270,16 @@ void WorldSession::HandleItemQuerySingleOpcode( WorldPacket & recv_data )
     ItemPrototype const *pProto = objmgr.GetItemPrototype( item );
     if( pProto )
     {
+        int loc_idx = GetSessionDbLocaleIndex();
+        if ( WorldPacket const* cached = sQueryResponseCache.Find(QUERY_CACHE_ITEM, item, loc_idx) )
+        {
+            SendPacket( cached );
+            return;
+        }
+
         std::string Name        = pProto->Name1;
         std::string Description = pProto->Description;
 
-        int loc_idx = GetSessionDbLocaleIndex();
         if ( loc_idx >= 0 )
         {
             ItemLocale const *il = objmgr.GetItemLocale(pProto->ItemId);
@@ -400,6 +410,7 @@ void WorldSession::HandleItemQuerySingleOpcode( WorldPacket & recv_data )
         data << pProto->RequiredDisenchantSkill;
         data << pProto->ArmorDamageModifier;
         data << uint32(0);                                  // added in 2.4.2.8209, duration (seconds)
+        sQueryResponseCache.Store(QUERY_CACHE_ITEM, item, loc_idx, data);
         SendPacket( &data );
     }
     else
@@ -48,6 +48,11 @@
 #include "ItemEnchantmentMgr.h"
 #include "InstanceSaveMgr.h"
 #include "InstanceData.h"
+#include "QueryResponseCache.h"
+#include "OpcodeProfiler.h"
+#include "WorldSocket.h"
+#include "WorldSocketMgr.h"
+#include "MovementRelay.h"
 
 //reload commands
 bool ChatHandler::HandleReloadCommand(const char* arg)
@@ -242,6 +247,7 @@ bool ChatHandler::HandleReloadQuestTemplateCommand(const char*)
 {
     sLog.outString( "Re-Loading Quest Templates..." );
     objmgr.LoadQuests();
+    sQueryResponseCache.Clear(QUERY_CACHE_QUEST);
     SendGlobalSysMessage("DB table `quest_template` (quest definitions) reloaded.");
     return true;
 }
@@ -419,6 +425,7 @@ bool ChatHandler::HandleReloadSpellElixirCommand(const char*)
 {
     sLog.outString( "Re-Loading Spell Elixir types..." );
     spellmgr.LoadSpellElixirs();
+    spellmgr.LoadSpellClassifications();                    // spell specific depends from elixir types
     SendGlobalSysMessage("DB table `spell_elixir` (spell exlixir types) reloaded.");
     return true;
 }
@@ -474,7 +481,11 @@ bool ChatHandler::HandleReloadSpellPetAurasCommand(const char*)
 bool ChatHandler::HandleReloadPageTextsCommand(const char*)
 {
     sLog.outString( "Re-Loading Page Texts..." );
-    objmgr.LoadPageTexts();
+    {
+        ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getWriteLock());
+        objmgr.LoadPageTexts();
+        sQueryResponseCache.Clear(QUERY_CACHE_PAGE_TEXT);
+    }
     SendGlobalSysMessage("DB table `page_texts` reloaded.");
     return true;
 }
@@ -612,7 +623,11 @@ bool ChatHandler::HandleReloadGameTeleCommand(const char* /*arg*/)
 bool ChatHandler::HandleReloadLocalesCreatureCommand(const char* /*arg*/)
 {
     sLog.outString( "Re-Loading Locales Creature ...");
-    objmgr.LoadCreatureLocales();
+    {
+        ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getWriteLock());
+        objmgr.LoadCreatureLocales();
+        sQueryResponseCache.Clear(QUERY_CACHE_CREATURE);
+    }
     SendGlobalSysMessage("DB table `locales_creature` reloaded.");
     return true;
 }
@@ -620,7 +635,11 @@ bool ChatHandler::HandleReloadLocalesCreatureCommand(const char* /*arg*/)
 bool ChatHandler::HandleReloadLocalesGameobjectCommand(const char* /*arg*/)
 {
     sLog.outString( "Re-Loading Locales Gameobject ... ");
-    objmgr.LoadGameObjectLocales();
+    {
+        ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getWriteLock());
+        objmgr.LoadGameObjectLocales();
+        sQueryResponseCache.Clear(QUERY_CACHE_GAMEOBJECT);
+    }
     SendGlobalSysMessage("DB table `locales_gameobject` reloaded.");
     return true;
 }
@@ -628,7 +647,11 @@ bool ChatHandler::HandleReloadLocalesGameobjectCommand(const char* /*arg*/)
 bool ChatHandler::HandleReloadLocalesItemCommand(const char* /*arg*/)
 {
     sLog.outString( "Re-Loading Locales Item ... ");
-    objmgr.LoadItemLocales();
+    {
+        ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getWriteLock());
+        objmgr.LoadItemLocales();
+        sQueryResponseCache.Clear(QUERY_CACHE_ITEM);
+    }
     SendGlobalSysMessage("DB table `locales_item` reloaded.");
     return true;
 }
@@ -637,6 +660,7 @@ bool ChatHandler::HandleReloadLocalesNpcTextCommand(const char* /*arg*/)
 {
     sLog.outString( "Re-Loading Locales NPC Text ... ");
     objmgr.LoadNpcTextLocales();
+    sQueryResponseCache.Clear(QUERY_CACHE_NPC_TEXT);
     SendGlobalSysMessage("DB table `locales_npc_text` reloaded.");
     return true;
 }
@@ -644,7 +668,11 @@ bool ChatHandler::HandleReloadLocalesNpcTextCommand(const char* /*arg*/)
 bool ChatHandler::HandleReloadLocalesPageTextCommand(const char* /*arg*/)
 {
     sLog.outString( "Re-Loading Locales Page Text ... ");
-    objmgr.LoadPageTextLocales();
+    {
+        ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getWriteLock());
+        objmgr.LoadPageTextLocales();
+        sQueryResponseCache.Clear(QUERY_CACHE_PAGE_TEXT);
+    }
     SendGlobalSysMessage("DB table `locales_page_text` reloaded.");
     return true;
 }
@@ -653,6 +681,7 @@ bool ChatHandler::HandleReloadLocalesQuestCommand(const char* /*arg*/)
 {
     sLog.outString( "Re-Loading Locales Quest ... ");
     objmgr.LoadQuestLocales();
+    sQueryResponseCache.Clear(QUERY_CACHE_QUEST);
     SendGlobalSysMessage("DB table `locales_quest` reloaded.");
     return true;
 }
@@ -4450,6 +4479,151 @@ bool ChatHandler::HandleIdleRestartCommand(const char* args)
     return true;
 }
 
+bool ChatHandler::HandleServerPoolsCommand(const char* /*args*/)
+{
+    FixedSizePool::PoolList const& pools = FixedSizePool::GetPools();
+    for(FixedSizePool::PoolList::const_iterator itr = pools.begin(); itr != pools.end(); ++itr)
+    {
+        FixedSizePool const* pool = *itr;
+        uint32 inUse = pool->GetInUseCount();
+        uint32 freeCount = pool->GetFreeCount();
+        uint64 allocs = pool->GetAllocationCount();
+
+        // idle: part of pool owned memory not used currently, reuse: allocations served from free list
+        float idle = inUse + freeCount ? float(freeCount) * 100.0f / float(inUse + freeCount) : 0.0f;
+        float reuse = allocs ? float(pool->GetRecycledCount()) * 100.0f / float(allocs) : 0.0f;
+
+        PSendSysMessage("%s (%u bytes): used %u (peak %u), free %u (%u KB, %.1f%% idle), allocations " I64FMTD " (%.1f%% reused)",
+            pool->GetName(), uint32(pool->GetBlockSize()), inUse, pool->GetPeakInUseCount(), freeCount,
+            uint32(freeCount * pool->GetBlockSize() / 1024), idle, allocs, reuse);
+    }
+    return true;
+}
+
+bool ChatHandler::HandleServerQueryCacheCommand(const char* /*args*/)
+{
+    if(!sQueryResponseCache.IsEnabled())
+    {
+        SendSysMessage("Query response cache disabled (QueryResponseCache = 0).");
+        return true;
+    }
+
+    for(int i = 0; i < MAX_QUERY_CACHE_TYPE; ++i)
+    {
+        QueryCacheType type = QueryCacheType(i);
+        uint64 hits = sQueryResponseCache.GetHitCount(type);
+        uint64 queries = hits + sQueryResponseCache.GetMissCount(type);
+        float hitRate = queries ? float(hits) * 100.0f / float(queries) : 0.0f;
+
+        PSendSysMessage("%s: %u responses (%u KB), queries " I64FMTD " (%.1f%% from cache)",
+            QueryResponseCache::GetTypeName(type), sQueryResponseCache.GetResponseCount(type),
+            uint32(sQueryResponseCache.GetResponseBytes(type) / 1024), queries, hitRate);
+    }
+    return true;
+}
+
+/// Sort opcodes by handle time or sent bytes, most used first
+struct OpcodeHandleTimeGreater
+{
+    explicit OpcodeHandleTimeGreater(OpcodeHandleStats const* stats) : i_stats(stats) {}
+    bool operator()(uint32 a, uint32 b) const { return i_stats[a].totalTime > i_stats[b].totalTime; }
+    OpcodeHandleStats const* i_stats;
+};
+
+struct OpcodeSentBytesGreater
+{
+    explicit OpcodeSentBytesGreater(OpcodeSendStats const* stats) : i_stats(stats) {}
+    bool operator()(uint32 a, uint32 b) const { return i_stats[a].bytes > i_stats[b].bytes; }
+    OpcodeSendStats const* i_stats;
+};
+
+bool ChatHandler::HandleServerOpcodesCommand(const char* args)
+{
+    if(*args && strncmp(args, "reset", strlen(args)) == 0)
+    {
+        sOpcodeProfiler.Reset();
+        SendSysMessage("Opcode profiler stats reset.");
+        return true;
+    }
+
+    int32 count = *args ? atoi(args) : 10;
+    if(count <= 0)
+        return false;
+
+    if(!sOpcodeProfiler.IsEnabled())
+        SendSysMessage("Opcode profiler disabled (OpcodeProfiler = 0), shown stats collected before disable.");
+
+    std::vector<OpcodeHandleStats> handled(NUM_MSG_TYPES);
+    std::vector<OpcodeSendStats> sent(NUM_MSG_TYPES);
+    sOpcodeProfiler.GetHandleStats(&handled[0]);
+    sOpcodeProfiler.GetSendStats(&sent[0]);
+
+    std::vector<uint32> opcodes(NUM_MSG_TYPES);
+    for(uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+        opcodes[i] = i;
+
+    uint32 shown = std::min(uint32(count), uint32(NUM_MSG_TYPES));
+
+    SendSysMessage("Received opcodes by handle time:");
+    std::partial_sort(opcodes.begin(), opcodes.begin() + shown, opcodes.end(), OpcodeHandleTimeGreater(&handled[0]));
+    for(uint32 i = 0; i < shown && handled[opcodes[i]].count; ++i)
+    {
+        OpcodeHandleStats const& stats = handled[opcodes[i]];
+        PSendSysMessage("%s: " I64FMTD " handled, total " I64FMTD " ms, avg " I64FMTD " us, max %u us",
+            LookupOpcodeName(opcodes[i]), stats.count, stats.totalTime / 1000, stats.totalTime / stats.count, stats.maxTime);
+    }
+
+    SendSysMessage("Sent opcodes by size:");
+    std::partial_sort(opcodes.begin(), opcodes.begin() + shown, opcodes.end(), OpcodeSentBytesGreater(&sent[0]));
+    for(uint32 i = 0; i < shown && sent[opcodes[i]].count; ++i)
+    {
+        OpcodeSendStats const& stats = sent[opcodes[i]];
+        PSendSysMessage("%s: " I64FMTD " sent, " I64FMTD " KB",
+            LookupOpcodeName(opcodes[i]), stats.count, stats.bytes / 1024);
+    }
+    return true;
+}
+
+bool ChatHandler::HandleServerNetworkCommand(const char* /*args*/)
+{
+    for(size_t i = 0; i < sWorldSocketMgr->GetNetThreadsCount(); ++i)
+    {
+        long connections;
+        WorldSocketStats total, lastSecond;
+        sWorldSocketMgr->GetNetThreadStats(i, connections, total, lastSecond);
+
+        PSendSysMessage("Network thread %u: %u connections, last second: %u send calls (%u KB), %u recv calls (%u KB)",
+            uint32(i + 1), uint32(connections), uint32(lastSecond.sendCalls), uint32(lastSecond.sentBytes / 1024),
+            uint32(lastSecond.recvCalls), uint32(lastSecond.receivedBytes / 1024));
+        PSendSysMessage("  total: " I64FMTD " send calls (" I64FMTD " KB), " I64FMTD " recv calls (" I64FMTD " KB)",
+            total.sendCalls, total.sentBytes / 1024, total.recvCalls, total.receivedBytes / 1024);
+    }
+    return true;
+}
+
+bool ChatHandler::HandleServerMovementCommand(const char* args)
+{
+    if(*args && strncmp(args, "reset", strlen(args)) == 0)
+    {
+        sMovementRelay.Reset();
+        SendSysMessage("Movement relay stats reset.");
+        return true;
+    }
+
+    for(int i = 0; i < MAX_MOVEMENT_RELAY_MAP_TYPE; ++i)
+    {
+        MovementRelayMapType type = MovementRelayMapType(i);
+        MovementRelayStats const& stats = sMovementRelay.GetStats(type);
+        uint64 wouldSend = stats.sentBytes + stats.savedBytes;
+        float savedRate = wouldSend ? float(stats.savedBytes) * 100.0f / float(wouldSend) : 0.0f;
+
+        PSendSysMessage("%s: relayed " I64FMTD " packets (" I64FMTD " heartbeats merged), sent " I64FMTD " copies (%u KB), skipped " I64FMTD " copies to distant viewers, saved %u KB (%.1f%%)",
+            MovementRelay::GetMapTypeName(type), stats.packets, stats.merged, stats.sent, uint32(stats.sentBytes / 1024),
+            stats.skipped, uint32(stats.savedBytes / 1024), savedRate);
+    }
+    return true;
+}
+
 bool ChatHandler::HandleIdleShutDownCommand(const char* args)
 {
     if(!*args)
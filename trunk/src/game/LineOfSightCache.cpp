@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "LineOfSightCache.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <string.h>
+
+LineOfSightCache::AtomicGeneration LineOfSightCache::s_generation(0);
+
+LineOfSightCache::LineOfSightCache() : i_mask(0), i_invGridSize(1.0f), i_ttl(0), i_hits(0), i_misses(0)
+{
+}
+
+void LineOfSightCache::Initialize(uint32 size, float gridSize, uint32 ttl)
+{
+    i_entries.clear();
+    i_mask = 0;
+    ResetStats();
+
+    if(size == 0 || ttl == 0 || gridSize <= 0.0f)
+        return;
+
+    // round down to power of two for cheap index masking
+    uint32 pow2 = 1;
+    while(pow2 * 2 <= size)
+        pow2 *= 2;
+
+    Entry empty;
+    memset(&empty, 0, sizeof(Entry));
+    i_entries.assign(pow2, empty);
+    i_mask = pow2 - 1;
+    i_invGridSize = 1.0f / gridSize;
+    i_ttl = ttl;
+}
+
+void LineOfSightCache::MakeKey(float x1, float y1, float z1, float x2, float y2, float z2, Key& key) const
+{
+    int32 a[3] = { int32(floor(x1 * i_invGridSize)), int32(floor(y1 * i_invGridSize)), int32(floor(z1 * i_invGridSize)) };
+    int32 b[3] = { int32(floor(x2 * i_invGridSize)), int32(floor(y2 * i_invGridSize)), int32(floor(z2 * i_invGridSize)) };
+
+    // line of sight is symmetric, store the pair in fixed order so A->B and B->A share an entry
+    bool swap = a[0] != b[0] ? a[0] > b[0] : (a[1] != b[1] ? a[1] > b[1] : a[2] > b[2]);
+    int32 const* first  = swap ? b : a;
+    int32 const* second = swap ? a : b;
+
+    for(int i = 0; i < 3; ++i)
+    {
+        key.p[i]   = first[i];
+        key.p[i+3] = second[i];
+    }
+}
+
+uint32 LineOfSightCache::HashKey(Key const& key)
+{
+    // FNV-1a over the quantized coordinates
+    uint32 h = 2166136261U;
+    for(int i = 0; i < 6; ++i)
+    {
+        h ^= uint32(key.p[i]);
+        h *= 16777619U;
+    }
+    return h ^ (h >> 15);
+}
+
+bool LineOfSightCache::Lookup(float x1, float y1, float z1, float x2, float y2, float z2, bool& result)
+{
+    if(!IsEnabled())
+        return false;
+
+    Key key;
+    MakeKey(x1, y1, z1, x2, y2, z2, key);
+
+    Entry const& entry = i_entries[HashKey(key) & i_mask];
+    if(!entry.used || entry.generation != s_generation.value() || int32(entry.expireTime - getMSTime()) <= 0 || !(entry.key == key))
+    {
+        ++i_misses;
+        return false;
+    }
+
+    ++i_hits;
+    result = entry.result;
+    return true;
+}
+
+void LineOfSightCache::Store(float x1, float y1, float z1, float x2, float y2, float z2, bool result)
+{
+    if(!IsEnabled())
+        return;
+
+    Key key;
+    MakeKey(x1, y1, z1, x2, y2, z2, key);
+
+    Entry& entry = i_entries[HashKey(key) & i_mask];
+    entry.key = key;
+    entry.expireTime = getMSTime() + i_ttl;
+    entry.generation = s_generation.value();
+    entry.used = true;
+    entry.result = result;
+}
+
+void LineOfSightCache::Clear()
+{
+    for(std::vector<Entry>::iterator itr = i_entries.begin(); itr != i_entries.end(); ++itr)
+        itr->used = false;
+}
+
+uint32 LineOfSightCache::GetUsedCount() const
+{
+    uint32 now = getMSTime();
+    long generation = s_generation.value();
+    uint32 count = 0;
+    for(std::vector<Entry>::const_iterator itr = i_entries.begin(); itr != i_entries.end(); ++itr)
+        if(itr->used && itr->generation == generation && int32(itr->expireTime - now) > 0)
+            ++count;
+    return count;
+}
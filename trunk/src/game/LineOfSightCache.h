@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_LINEOFSIGHTCACHE_H
+#define MANGOS_LINEOFSIGHTCACHE_H
+
+#include "Platform/Define.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+#include <vector>
+
+/**
+ * Bounded cache of vmap line of sight results for one map (instance).
+ *
+ * Both end points are quantized to a grid of GridSize yards, so a pack of creatures
+ * checking the same tank or a caster re-targeting a stationary boss hit the same entry.
+ * The table is direct mapped (a colliding pair simply replaces the old one) and entries
+ * expire after a short TTL. Any vmap tile load/unload invalidates all caches of all maps.
+ */
+class MANGOS_DLL_SPEC LineOfSightCache
+{
+    public:
+        LineOfSightCache();
+
+        // size is rounded down to a power of two, 0 disable the cache
+        void Initialize(uint32 size, float gridSize, uint32 ttl);
+
+        bool IsEnabled() const { return !i_entries.empty(); }
+
+        // true and result filled if a still valid entry for this pair exist
+        bool Lookup(float x1, float y1, float z1, float x2, float y2, float z2, bool& result);
+        void Store(float x1, float y1, float z1, float x2, float y2, float z2, bool result);
+        void Clear();
+
+        uint64 GetHits() const { return i_hits; }
+        uint64 GetMisses() const { return i_misses; }
+        uint32 GetSize() const { return i_entries.size(); }
+        uint32 GetUsedCount() const;
+        void ResetStats() { i_hits = 0; i_misses = 0; }
+
+        // called at vmap tile load/unload, invalidate cached results for all maps
+        static void InvalidateAll() { ++s_generation; }
+
+    private:
+        struct Key
+        {
+            int32 p[6];
+
+            bool operator==(Key const& k) const
+            {
+                return p[0]==k.p[0] && p[1]==k.p[1] && p[2]==k.p[2] && p[3]==k.p[3] && p[4]==k.p[4] && p[5]==k.p[5];
+            }
+        };
+
+        struct Entry
+        {
+            Key key;
+            uint32 expireTime;
+            long generation;
+            bool used;
+            bool result;
+        };
+
+        void MakeKey(float x1, float y1, float z1, float x2, float y2, float z2, Key& key) const;
+        static uint32 HashKey(Key const& key);
+
+        std::vector<Entry> i_entries;
+        uint32 i_mask;
+        float i_invGridSize;
+        uint32 i_ttl;
+
+        uint64 i_hits;
+        uint64 i_misses;
+
+        // bumped by vmap tile load of any map, read by lookups of all maps
+        typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> AtomicGeneration;
+        static AtomicGeneration s_generation;
+};
+
+#endif
@@ -37,51 +37,208 @@
 #include "MapInstanced.h"
 #include "InstanceSaveMgr.h"
 #include "VMapFactory.h"
+#include "MovementRelay.h"
+
+#include "ace/Mem_Map.h"
 
 #define DEFAULT_GRID_EXPIRY     300
 #define MAX_GRID_LOAD_TIME      50
 
-// magic *.map header
-const char MAP_MAGIC[] = "MAP_2.00";
-
 GridState* si_GridStates[MAX_GRID_STATE];
 
-Map::~Map()
+GridMap::GridMap() : m_areaFlag(NULL), m_terrainType(NULL),
+    m_heightRaw(NULL), m_heightPacked(NULL), m_heightMin(0.0f), m_heightStep(0.0f),
+    m_liquidRaw(NULL), m_liquidIndex(NULL), m_liquidBlocks(NULL),
+    m_rawData(NULL), m_mappedFile(NULL)
 {
-    UnloadAll(true);
 }
 
-bool Map::ExistMap(uint32 mapid,int x,int y)
+GridMap::~GridMap()
 {
-    int len = sWorld.GetDataPath().length()+strlen("maps/%03u%02u%02u.map")+1;
-    char* tmp = new char[len];
-    snprintf(tmp, len, (char *)(sWorld.GetDataPath()+"maps/%03u%02u%02u.map").c_str(),mapid,x,y);
+    unloadData();
+}
 
-    FILE *pf=fopen(tmp,"rb");
+void GridMap::unloadData()
+{
+    delete [] m_rawData;
+    m_rawData = NULL;
+
+    if(m_mappedFile)
+    {
+        m_mappedFile->close();
+        delete m_mappedFile;
+        m_mappedFile = NULL;
+    }
+
+    m_areaFlag = NULL;
+    m_terrainType = NULL;
+    m_heightRaw = NULL;
+    m_heightPacked = NULL;
+    m_liquidRaw = NULL;
+    m_liquidIndex = NULL;
+    m_liquidBlocks = NULL;
+}
+
+bool GridMap::ExistFile(char const* filename)
+{
+    FILE *pf=fopen(filename,"rb");
 
     if(!pf)
     {
-        sLog.outError("Check existing of map file '%s': not exist!",tmp);
-        delete[] tmp;
+        sLog.outError("Check existing of map file '%s': not exist!",filename);
         return false;
     }
 
     char magic[8];
-    fread(magic,1,8,pf);
-    if(strncmp(MAP_MAGIC,magic,8))
+    if(fread(magic,1,8,pf) != 8 || (strncmp(MAP_MAGIC_RAW,magic,8) && strncmp(MAP_MAGIC_COMPACT,magic,8)))
     {
-        sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.",tmp);
-        delete [] tmp;
+        sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.",filename);
         fclose(pf);                                         //close file before return
         return false;
     }
 
-    delete [] tmp;
     fclose(pf);
+    return true;
+}
+
+bool GridMap::LoadData(char const* filename)
+{
+    unloadData();
+
+    FILE *pf=fopen(filename,"rb");
+    if(!pf)
+        return false;
+
+    char magic[8];
+    if(fread(magic,1,8,pf) != 8)
+    {
+        sLog.outError("Map file '%s' is corrupted.",filename);
+        fclose(pf);
+        return false;
+    }
+
+    if(!strncmp(MAP_MAGIC_RAW,magic,8))
+    {
+        bool res = loadRawData(pf,filename);
+        fclose(pf);
+        return res;
+    }
+
+    fclose(pf);
+
+    if(!strncmp(MAP_MAGIC_COMPACT,magic,8))
+        return loadCompactData(filename);
+
+    sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.",filename);
+    return false;
+}
+
+bool GridMap::loadRawData(FILE* pf, char const* filename)
+{
+    size_t const areaSize    = 16*16*sizeof(uint16);
+    size_t const terrainSize = 16*16*sizeof(uint8);
+    size_t const liquidSize  = 128*128*sizeof(float);
+    size_t const heightSize  = MAP_RESOLUTION*MAP_RESOLUTION*sizeof(float);
+    size_t const dataSize    = areaSize+terrainSize+liquidSize+heightSize;
+
+    m_rawData = new char[dataSize];
+    if(fread(m_rawData,1,dataSize,pf) != dataSize)
+    {
+        sLog.outError("Map file '%s' is corrupted.",filename);
+        unloadData();
+        return false;
+    }
+
+    m_areaFlag    = (uint16 const*)m_rawData;
+    m_terrainType = (uint8 const*)(m_rawData+areaSize);
+    m_liquidRaw   = (float const*)(m_rawData+areaSize+terrainSize);
+    m_heightRaw   = (float const*)(m_rawData+areaSize+terrainSize+liquidSize);
+    return true;
+}
+
+bool GridMap::loadCompactData(char const* filename)
+{
+    m_mappedFile = new ACE_Mem_Map;
+    if(m_mappedFile->map(filename, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_SHARED) != 0)
+    {
+        sLog.outError("Map file '%s' can't be mapped in memory.",filename);
+        unloadData();
+        return false;
+    }
+
+    char const* data = (char const*)m_mappedFile->addr();
+    size_t size = m_mappedFile->size();
+
+    // header fields used for size check
+    if(size < sizeof(GridMapFileHeader))
+    {
+        sLog.outError("Map file '%s' is corrupted.",filename);
+        unloadData();
+        return false;
+    }
+
+    GridMapFileHeader const* header = (GridMapFileHeader const*)data;
+    size_t offset = sizeof(GridMapFileHeader);
+
+    size_t needSize = offset + 16*16*sizeof(uint16) + 16*16*sizeof(uint8);
+    if(!(header->flags & GRIDMAP_FLAG_FLAT_HEIGHT))
+        needSize += MAP_RESOLUTION*MAP_RESOLUTION*sizeof(uint16);
+    if(!(header->flags & GRIDMAP_FLAG_NO_LIQUID))
+        needSize += 16*16*sizeof(uint16) + header->liquidBlocks*8*8*sizeof(float);
+
+    if(size < needSize)
+    {
+        sLog.outError("Map file '%s' is corrupted.",filename);
+        unloadData();
+        return false;
+    }
+
+    m_areaFlag = (uint16 const*)(data+offset);
+    offset += 16*16*sizeof(uint16);
+    m_terrainType = (uint8 const*)(data+offset);
+    offset += 16*16*sizeof(uint8);
+
+    m_heightMin = header->heightMin;
+    if(!(header->flags & GRIDMAP_FLAG_FLAT_HEIGHT))
+    {
+        m_heightStep = (header->heightMax - header->heightMin) / 65535.0f;
+        m_heightPacked = (uint16 const*)(data+offset);
+        offset += MAP_RESOLUTION*MAP_RESOLUTION*sizeof(uint16);
+    }
+
+    if(!(header->flags & GRIDMAP_FLAG_NO_LIQUID))
+    {
+        m_liquidIndex = (uint16 const*)(data+offset);
+        offset += 16*16*sizeof(uint16);
+        m_liquidBlocks = (float const*)(data+offset);
+
+        // getLiquidLevel reads block data by index without checks
+        for(int i = 0; i < 16*16; ++i)
+        {
+            if(m_liquidIndex[i] != GRIDMAP_LIQUID_NO_BLOCK && m_liquidIndex[i] >= header->liquidBlocks)
+            {
+                sLog.outError("Map file '%s' is corrupted.",filename);
+                unloadData();
+                return false;
+            }
+        }
+    }
 
     return true;
 }
 
+bool Map::ExistMap(uint32 mapid,int x,int y)
+{
+    int len = sWorld.GetDataPath().length()+strlen("maps/%03u%02u%02u.map")+1;
+    char* tmp = new char[len];
+    snprintf(tmp, len, (char *)(sWorld.GetDataPath()+"maps/%03u%02u%02u.map").c_str(),mapid,x,y);
+
+    bool res = GridMap::ExistFile(tmp);
+
+    delete [] tmp;
+    return res;
+}
+
 bool Map::ExistVMap(uint32 mapid,int x,int y)
 {
     if(VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager())
@@ -109,6 +266,7 @@ void Map::LoadVMap(int x,int y)
     switch(vmapLoadResult)
     {
         case VMAP::VMAP_LOAD_RESULT_OK:
+            LineOfSightCache::InvalidateAll();
             sLog.outDetail("VMAP loaded name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", GetMapName(), GetId(), x,y, x,y);
             break;
         case VMAP::VMAP_LOAD_RESULT_ERROR:
@@ -158,27 +316,14 @@ void Map::LoadMap(uint32 mapid, uint32 instanceid, int x,int y)
     snprintf(tmp, len, (char *)(sWorld.GetDataPath()+"maps/%03u%02u%02u.map").c_str(),mapid,x,y);
     sLog.outDetail("Loading map %s",tmp);
     // loading data
-    FILE *pf=fopen(tmp,"rb");
-    if(!pf)
-    {
-        delete [] tmp;
-        return;
-    }
-
-    char magic[8];
-    fread(magic,1,8,pf);
-    if(strncmp(MAP_MAGIC,magic,8))
+    GridMap * buf= new GridMap;
+    if(!buf->LoadData(tmp))
     {
-        sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.",tmp);
+        delete buf;
         delete [] tmp;
-        fclose(pf);                                         //close file before return
         return;
     }
-    delete []  tmp;
-
-    GridMap * buf= new GridMap;
-    fread(buf,1,sizeof(GridMap),pf);
-    fclose(pf);
+    delete [] tmp;
 
     GridMaps[x][y] = buf;
 }
@@ -219,6 +364,8 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
             setNGrid(NULL, idx, j);
         }
     }
+
+    i_losCache.Initialize(sWorld.getConfig(CONFIG_LOS_CACHE_SIZE), sWorld.getRate(RATE_LOS_CACHE_GRID_SIZE), sWorld.getConfig(CONFIG_LOS_CACHE_TTL));
 }
 
 // Template specialization of utility methods
@@ -510,6 +657,41 @@ void Map::MessageBroadcast(WorldObject *obj, WorldPacket *msg)
     cell_lock->Visit(cell_lock, message, *this);
 }
 
+uint32 Map::MovementBroadcast(Player *player, WorldPacket *msg, uint32 heartbeat)
+{
+    CellPair p = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
+
+    if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
+    {
+        sLog.outError("Map::MovementBroadcast: Player (GUID: %u) have invalid coordinates X:%f Y:%f grid cell [%u:%u]", player->GetGUIDLow(), player->GetPositionX(), player->GetPositionY(), p.x_coord, p.y_coord);
+        return 0;
+    }
+
+    Cell cell(p);
+    cell.data.Part.reserved = ALL_DISTRICT;
+
+    if( !loaded(GridPair(cell.data.Part.grid_x, cell.data.Part.grid_y)) )
+        return 0;
+
+    MovementRelayMapType relayType = MovementRelay::GetMapType(this);
+    float nearDistSq, farDistSq;
+    MovementRelay::GetTierDistancesSq(relayType, nearDistSq, farDistSq);
+
+    MaNGOS::MovementMessageDeliverer post_man(*player, msg, heartbeat, nearDistSq, farDistSq);
+    TypeContainerVisitor<MaNGOS::MovementMessageDeliverer, WorldTypeMapContainer > message(post_man);
+    CellLock<ReadGuard> cell_lock(cell, p);
+    cell_lock->Visit(cell_lock, message, *this);
+
+    MovementRelayStats& stats = sMovementRelay.GetStats(relayType);
+    ++stats.packets;
+    stats.sent += post_man.i_sent;
+    stats.sentBytes += uint64(post_man.i_sent) * msg->size();
+    stats.skipped += post_man.i_skipped;
+    stats.savedBytes += uint64(post_man.i_skipped) * msg->size();
+
+    return post_man.i_sent;
+}
+
 void Map::MessageDistBroadcast(Player *player, WorldPacket *msg, float dist, bool to_self, bool own_team_only)
 {
     CellPair p = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
@@ -717,6 +899,8 @@ Map::CreatureRelocation(Creature *creature, float x, float y, float z, float ang
 {
     assert(CheckGridIntegrity(creature,false));
 
+    creature->WakeUp();
+
     Cell old_cell = creature->GetCurrentCell();
 
     CellPair new_val = MaNGOS::ComputeCellPair(x, y);
@@ -906,6 +1090,7 @@ bool Map::UnloadGrid(const uint32 &x, const uint32 &y, bool pForce)
             if(GridMaps[gx][gy]) delete (GridMaps[gx][gy]);
             // x and y are swaped
             VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(GetId(), gy, gx);
+            LineOfSightCache::InvalidateAll();
         }
         else
             ((MapInstanced*)(MapManager::Instance().GetBaseMap(i_id)))->RemoveGridMapReference(GridPair(gx, gy));
@@ -951,10 +1136,10 @@ float Map::GetHeight(float x, float y, float z, bool pUseVmaps) const
 
         float zi[4];
         // Probe 4 nearest points (except border cases)
-        zi[0] = gmap->Z[lx_int][ly_int];
-        zi[1] = lx < MAP_RESOLUTION-1 ? gmap->Z[lx_int+1][ly_int] : zi[0];
-        zi[2] = ly < MAP_RESOLUTION-1 ? gmap->Z[lx_int][ly_int+1] : zi[0];
-        zi[3] = lx < MAP_RESOLUTION-1 && ly < MAP_RESOLUTION-1 ? gmap->Z[lx_int+1][ly_int+1] : zi[0];
+        zi[0] = gmap->getHeight(lx_int,ly_int);
+        zi[1] = lx < MAP_RESOLUTION-1 ? gmap->getHeight(lx_int+1,ly_int) : zi[0];
+        zi[2] = ly < MAP_RESOLUTION-1 ? gmap->getHeight(lx_int,ly_int+1) : zi[0];
+        zi[3] = lx < MAP_RESOLUTION-1 && ly < MAP_RESOLUTION-1 ? gmap->getHeight(lx_int+1,ly_int+1) : zi[0];
         // Recalculate them like if their x,y positions were in the range 0,1
         float b[4];
         b[0] = zi[0];
@@ -1041,7 +1226,7 @@ uint16 Map::GetAreaFlag(float x, float y ) const
     const_cast<Map*>(this)->EnsureGridCreated(GridPair(63-gx,63-gy));
 
     if(GridMaps[gx][gy])
-        return GridMaps[gx][gy]->area_flag[(int)(lx)][(int)(ly)];
+        return GridMaps[gx][gy]->getAreaFlag((int)(lx),(int)(ly));
     // this used while not all *.map files generated (instances)
     else
         return GetAreaFlagByMapId(i_id);
@@ -1064,7 +1249,7 @@ uint8 Map::GetTerrainType(float x, float y ) const
     const_cast<Map*>(this)->EnsureGridCreated(GridPair(63-gx,63-gy));
 
     if(GridMaps[gx][gy])
-        return GridMaps[gx][gy]->terrain_type[(int)(lx)][(int)(ly)];
+        return GridMaps[gx][gy]->getTerrainType((int)(lx),(int)(ly));
     else
         return 0;
 
@@ -1087,7 +1272,7 @@ float Map::GetWaterLevel(float x, float y ) const
     const_cast<Map*>(this)->EnsureGridCreated(GridPair(63-gx,63-gy));
 
     if(GridMaps[gx][gy])
-        return GridMaps[gx][gy]->liquid_level[(int)(lx)][(int)(ly)];
+        return GridMaps[gx][gy]->getLiquidLevel((int)(lx),(int)(ly));
     else
         return 0;
 }
@@ -1134,6 +1319,59 @@ bool Map::IsUnderWater(float x, float y, float z) const
     return (z < (water_z-2)) && (flag & 0x01);
 }
 
+bool Map::IsInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2)
+{
+    VMAP::IVMapManager *vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
+
+    // nothing to save if vmap LoS is disabled, the check is a no-op then
+    if(!vMapManager->isLineOfSightCalcEnabled() || !i_losCache.IsEnabled())
+        return vMapManager->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2);
+
+    bool result;
+    if(i_losCache.Lookup(x1, y1, z1, x2, y2, z2, result))
+        return result;
+
+    result = vMapManager->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2);
+    i_losCache.Store(x1, y1, z1, x2, y2, z2, result);
+    return result;
+}
+
+void Map::IsInLineOfSight(VMAP::LineOfSightQuery* queries, uint32 count)
+{
+    VMAP::IVMapManager *vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
+
+    if(!vMapManager->isLineOfSightCalcEnabled() || !i_losCache.IsEnabled())
+    {
+        vMapManager->isInLineOfSight(GetId(), queries, count);
+        return;
+    }
+
+    // answer what we can from cache and send only the misses to vmaps
+    std::vector<VMAP::LineOfSightQuery> misses;
+    std::vector<uint32> missIndex;
+    for(uint32 i = 0; i < count; ++i)
+    {
+        VMAP::LineOfSightQuery& q = queries[i];
+        if(!i_losCache.Lookup(q.x1, q.y1, q.z1, q.x2, q.y2, q.z2, q.result))
+        {
+            misses.push_back(q);
+            missIndex.push_back(i);
+        }
+    }
+
+    if(misses.empty())
+        return;
+
+    vMapManager->isInLineOfSight(GetId(), &misses[0], misses.size());
+
+    for(uint32 i = 0; i < misses.size(); ++i)
+    {
+        VMAP::LineOfSightQuery const& q = misses[i];
+        i_losCache.Store(q.x1, q.y1, q.z1, q.x2, q.y2, q.z2, q.result);
+        queries[missIndex[i]].result = q.result;
+    }
+}
+
 bool Map::CheckGridIntegrity(Creature* c, bool moved) const
 {
     Cell const& cur_cell = c->GetCurrentCell();
@@ -31,6 +31,7 @@
 #include "Timer.h"
 #include "SharedDefines.h"
 #include "GameSystem/GridRefManager.h"
+#include "LineOfSightCache.h"
 
 #include <bitset>
 #include <list>
@@ -38,8 +39,14 @@
 class Unit;
 class WorldPacket;
 class InstanceData;
+
+namespace VMAP
+{
+    struct LineOfSightQuery;
+}
 class Group;
 class InstanceSave;
+class ACE_Mem_Map;
 
 namespace ZThread
 {
@@ -67,13 +74,92 @@ typedef RGuard<GridRWLock, ZThread::Lockable> GridReadGuard;
 typedef WGuard<GridRWLock, ZThread::Lockable> GridWriteGuard;
 typedef MaNGOS::SingleThreaded<GridRWLock>::Lock NullGuard;
 
-typedef struct
+// *.map file header versions
+#define MAP_MAGIC_RAW       "MAP_2.00"                      // plain float arrays
+#define MAP_MAGIC_COMPACT   "MAP_3.00"                      // quantized heights and sparse liquid, memory mapped
+
+#define MAP_LIQUID_NO_WATER (-999999.0f)                    // liquid level value used by extractor for cells without liquid
+
+enum GridMapFlags
+{
+    GRIDMAP_FLAG_FLAT_HEIGHT    = 0x01,                     // height array not stored, all points at heightMin
+    GRIDMAP_FLAG_NO_LIQUID      = 0x02                      // liquid index and liquid blocks not stored
+};
+
+// Compact *.map file layout, file mapped in memory as is:
+//   GridMapFileHeader
+//   uint16 area_flag[16][16]
+//   uint8  terrain_type[16][16]
+//   uint16 Z[MAP_RESOLUTION][MAP_RESOLUTION]               (if not GRIDMAP_FLAG_FLAT_HEIGHT)
+//   uint16 liquid_index[16][16]                            (if not GRIDMAP_FLAG_NO_LIQUID, 0xFFFF for chunk without liquid)
+//   float  liquid_block[liquidBlocks][8][8]                (if not GRIDMAP_FLAG_NO_LIQUID)
+struct GridMapFileHeader
 {
-    uint16 area_flag[16][16];
-    uint8 terrain_type[16][16];
-    float liquid_level[128][128];
-    float Z[MAP_RESOLUTION][MAP_RESOLUTION];
-}GridMap;
+    char   magic[8];
+    uint32 flags;
+    float  heightMin;
+    float  heightMax;
+    uint32 liquidBlocks;
+};
+
+#define GRIDMAP_LIQUID_NO_BLOCK 0xFFFF
+
+class GridMap
+{
+    public:
+        GridMap();
+        ~GridMap();
+
+        static bool ExistFile(char const* filename);
+
+        bool LoadData(char const* filename);
+
+        uint16 getAreaFlag(int x, int y) const { return m_areaFlag[x*16+y]; }
+        uint8 getTerrainType(int x, int y) const { return m_terrainType[x*16+y]; }
+
+        // x,y in [0..MAP_RESOLUTION)
+        float getHeight(int x, int y) const
+        {
+            if(m_heightRaw)
+                return m_heightRaw[x*MAP_RESOLUTION+y];
+            if(m_heightPacked)
+                return m_heightMin + m_heightStep * m_heightPacked[x*MAP_RESOLUTION+y];
+            return m_heightMin;
+        }
+
+        // x,y in [0..128)
+        float getLiquidLevel(int x, int y) const
+        {
+            if(m_liquidRaw)
+                return m_liquidRaw[x*128+y];
+            if(!m_liquidIndex)
+                return MAP_LIQUID_NO_WATER;
+            uint16 block = m_liquidIndex[(x/8)*16+(y/8)];
+            if(block == GRIDMAP_LIQUID_NO_BLOCK)
+                return MAP_LIQUID_NO_WATER;
+            return m_liquidBlocks[block*64+(x%8)*8+(y%8)];
+        }
+
+    private:
+        bool loadRawData(FILE* pf, char const* filename);
+        bool loadCompactData(char const* filename);
+        void unloadData();
+
+        uint16 const* m_areaFlag;
+        uint8  const* m_terrainType;
+
+        float  const* m_heightRaw;                          // MAP_MAGIC_RAW
+        uint16 const* m_heightPacked;                       // MAP_MAGIC_COMPACT
+        float m_heightMin;
+        float m_heightStep;
+
+        float  const* m_liquidRaw;                          // MAP_MAGIC_RAW
+        uint16 const* m_liquidIndex;                        // MAP_MAGIC_COMPACT
+        float  const* m_liquidBlocks;                       // MAP_MAGIC_COMPACT
+
+        char* m_rawData;                                    // heap copy of MAP_MAGIC_RAW file
+        ACE_Mem_Map* m_mappedFile;                          // shared read-only mapping of MAP_MAGIC_COMPACT file
+};
 
 struct CreatureMover
 {
@@ -140,6 +226,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
 
         void MessageBroadcast(Player *, WorldPacket *, bool to_self);
         void MessageBroadcast(WorldObject *, WorldPacket *);
+        // movement of player to nearby players, heartbeat is relayed heartbeat number (0 for other movement), return count of viewers packet sent to
+        uint32 MovementBroadcast(Player *, WorldPacket *, uint32 heartbeat);
         void MessageDistBroadcast(Player *, WorldPacket *, float dist, bool to_self, bool own_team_only = false);
         void MessageDistBroadcast(WorldObject *, WorldPacket *, float dist);
 
@@ -185,6 +273,12 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         float GetWaterLevel(float x, float y ) const;
         bool IsUnderWater(float x, float y, float z) const;
 
+        // vmap line of sight check with per map result cache
+        bool IsInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2);
+        // batch version, all cache misses are answered by one vmap batch query
+        void IsInLineOfSight(VMAP::LineOfSightQuery* queries, uint32 count);
+        LineOfSightCache const& GetLineOfSightCache() const { return i_losCache; }
+
         static uint32 GetAreaId(uint16 areaflag,uint32 map_id);
         static uint32 GetZoneId(uint16 areaflag,uint32 map_id);
 
@@ -292,6 +386,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
 
         std::set<WorldObject *> i_objectsToRemove;
 
+        LineOfSightCache i_losCache;
+
         // Type specific code for add/remove to/from grid
         template<class T>
             void AddToGrid(T*, NGridType *, Cell const&);
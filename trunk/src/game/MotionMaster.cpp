@@ -86,6 +86,8 @@ MotionMaster::UpdateMotion(const uint32 &diff)
 void
 MotionMaster::Clear(bool reset)
 {
+    i_owner->WakeUp();
+
     while( !empty() && size() > 1 )
     {
         MovementGenerator *curr = top();
@@ -108,6 +110,8 @@ MotionMaster::MovementExpired(bool reset)
     if( empty() || size() == 1 )
         return;
 
+    i_owner->WakeUp();
+
     MovementGenerator *curr = top();
     curr->Finalize(*i_owner);
     pop();
@@ -301,6 +305,8 @@ MotionMaster::MoveDistract(uint32 timer)
 
 void MotionMaster::Mutate(MovementGenerator *m)
 {
+    i_owner->WakeUp();
+
     if (!empty())
     {
         switch(top()->GetMovementGeneratorType())
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MovementRelay.h"
+#include "Map.h"
+#include "World.h"
+#include "Player.h"
+#include "ObjectAccessor.h"
+#include "Policies/SingletonImp.h"
+
+INSTANTIATE_SINGLETON_1(MovementRelay);
+
+MovementRelay::MovementRelay()
+{
+    Reset();
+}
+
+MovementRelayMapType MovementRelay::GetMapType(Map const* map)
+{
+    if(map->IsBattleGroundOrArena())
+        return MOVEMENT_RELAY_BATTLEGROUND;
+    if(map->Instanceable())
+        return MOVEMENT_RELAY_INSTANCE;
+    return MOVEMENT_RELAY_CONTINENT;
+}
+
+char const* MovementRelay::GetMapTypeName(MovementRelayMapType type)
+{
+    switch(type)
+    {
+        case MOVEMENT_RELAY_CONTINENT:    return "Continents";
+        case MOVEMENT_RELAY_INSTANCE:     return "Instances";
+        case MOVEMENT_RELAY_BATTLEGROUND: return "BattleGrounds";
+    }
+    return "Unknown";
+}
+
+void MovementRelay::GetTierDistancesSq(MovementRelayMapType type, float& nearDistSq, float& farDistSq)
+{
+    uint32 nearDist, farDist;
+    switch(type)
+    {
+        case MOVEMENT_RELAY_INSTANCE:
+            nearDist = sWorld.getConfig(CONFIG_MOVEMENT_RELAY_NEAR_INSTANCES);
+            farDist = sWorld.getConfig(CONFIG_MOVEMENT_RELAY_FAR_INSTANCES);
+            break;
+        case MOVEMENT_RELAY_BATTLEGROUND:
+            nearDist = sWorld.getConfig(CONFIG_MOVEMENT_RELAY_NEAR_BATTLEGROUNDS);
+            farDist = sWorld.getConfig(CONFIG_MOVEMENT_RELAY_FAR_BATTLEGROUNDS);
+            break;
+        default:
+            nearDist = sWorld.getConfig(CONFIG_MOVEMENT_RELAY_NEAR_CONTINENTS);
+            farDist = sWorld.getConfig(CONFIG_MOVEMENT_RELAY_FAR_CONTINENTS);
+            break;
+    }
+
+    nearDistSq = float(nearDist * nearDist);
+    farDistSq = float(farDist * farDist);
+}
+
+void MovementRelay::SendPendingHeartbeats()
+{
+    // players can be logged out meanwhile, so found by guid
+    for(std::vector<uint64>::const_iterator itr = m_pendingHeartbeats.begin(); itr != m_pendingHeartbeats.end(); ++itr)
+        if(Player* player = ObjectAccessor::FindPlayer(*itr))
+            player->SendPendingHeartbeat();
+
+    m_pendingHeartbeats.clear();
+}
+
+void MovementRelay::Reset()
+{
+    memset(m_stats, 0, sizeof(m_stats));
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MOVEMENTRELAY_H
+#define MANGOS_MOVEMENTRELAY_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <vector>
+
+class Map;
+
+enum MovementRelayMapType
+{
+    MOVEMENT_RELAY_CONTINENT    = 0,
+    MOVEMENT_RELAY_INSTANCE     = 1,
+    MOVEMENT_RELAY_BATTLEGROUND = 2                         // also arenas
+};
+
+#define MAX_MOVEMENT_RELAY_MAP_TYPE 3
+
+struct MovementRelayStats
+{
+    uint64 packets;                                         // movement packets relayed to nearby players
+    uint64 merged;                                          // heartbeats replaced by later movement of same player in same tick
+    uint64 sent;                                            // packet copies sent to viewers
+    uint64 sentBytes;
+    uint64 skipped;                                         // heartbeat copies not sent to distant viewers
+    uint64 savedBytes;                                      // skipped copies and (estimated by viewers count) merged heartbeats
+};
+
+/**
+ * Tier distances and stats of player movement relay.
+ *
+ * Heartbeats (MSG_MOVE_HEARTBEAT) only repeat position of moving player, clients interpolate between them.
+ * Heartbeats received in one world tick are merged to last one, sent at world tick end, and heartbeat waiting
+ * at other movement packet receive is dropped. Viewers farther than near tier distance get every 2nd relayed
+ * heartbeat, farther than far tier distance every 4th. Other movement packets (start/stop, jump, fall,
+ * facing) change client side movement and always sent to all viewers.
+ *
+ * Used only from world thread.
+ */
+class MovementRelay
+{
+    public:
+        MovementRelay();
+
+        static MovementRelayMapType GetMapType(Map const* map);
+        static char const* GetMapTypeName(MovementRelayMapType type);
+
+        // squared tier distances for map type, 0 for disabled tier
+        static void GetTierDistancesSq(MovementRelayMapType type, float& nearDistSq, float& farDistSq);
+
+        // players with merged heartbeat waiting, sent by SendPendingHeartbeats at world tick end
+        void AddPendingHeartbeat(uint64 guid) { m_pendingHeartbeats.push_back(guid); }
+        void SendPendingHeartbeats();
+
+        MovementRelayStats& GetStats(MovementRelayMapType type) { return m_stats[type]; }
+        void Reset();
+
+    private:
+        MovementRelayStats m_stats[MAX_MOVEMENT_RELAY_MAP_TYPE];
+        std::vector<uint64> m_pendingHeartbeats;
+};
+
+#define sMovementRelay MaNGOS::Singleton<MovementRelay>::Instance()
+
+#endif
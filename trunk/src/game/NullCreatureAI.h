@@ -37,6 +37,7 @@ class MANGOS_DLL_DECL NullCreatureAI : public CreatureAI
         bool IsVisible(Unit *) const { return false;  }
 
         void UpdateAI(const uint32) {}
+        bool CanSleep() const { return true; }
         static int Permissible(const Creature *) { return PERMIT_BASE_IDLE;  }
 };
 #endif
@@ -93,18 +93,18 @@ Object::~Object( )
         }
 
         //DEBUG_LOG("Object desctr 1 check (%p)",(void*)this);
-        delete [] m_uint32Values;
-        delete [] m_uint32Values_mirror;
+        ValuesArrayPool::Release(m_uint32Values, m_valuesCount);
+        ValuesArrayPool::Release(m_uint32Values_mirror, m_valuesCount);
         //DEBUG_LOG("Object desctr 2 check (%p)",(void*)this);
     }
 }
 
 void Object::_InitValues()
 {
-    m_uint32Values = new uint32[ m_valuesCount ];
+    m_uint32Values = ValuesArrayPool::Allocate(m_valuesCount);
     memset(m_uint32Values, 0, m_valuesCount*sizeof(uint32));
 
-    m_uint32Values_mirror = new uint32[ m_valuesCount ];
+    m_uint32Values_mirror = ValuesArrayPool::Allocate(m_valuesCount);
     memset(m_uint32Values_mirror, 0, m_valuesCount*sizeof(uint32));
 
     m_objectUpdated = false;
@@ -1053,6 +1053,11 @@ bool WorldObject::IsWithinLOS(const float ox, const float oy, const float oz ) c
 {
     float x,y,z;
     GetPosition(x,y,z);
+    if(Map* map = GetMap())
+        return map->IsInLineOfSight(x, y, z+2.0f, ox, oy, oz+2.0f);
+
+    sLog.outError("WorldObject::IsWithinLOS: map %u (instance %u) of object (GUID: %u TypeId: %u) not found, line of sight checked without cache",
+        GetMapId(), GetInstanceId(), GetGUIDLow(), GetTypeId());
     VMAP::IVMapManager *vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
     return vMapManager->isInLineOfSight(GetMapId(), x, y, z+2.0f, ox, oy, oz+2.0f);
 }
@@ -25,6 +25,7 @@
 #include "UpdateData.h"
 #include "GameSystem/GridReference.h"
 #include "ObjectDefines.h"
+#include "ObjectPool.h"
 
 #include <set>
 #include <string>
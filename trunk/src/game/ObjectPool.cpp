@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Common.h"
+#include "ObjectPool.h"
+#include "UpdateFields.h"
+#include "zthread/Guard.h"
+
+#include <new>
+#include <stdio.h>
+
+uint32 FixedSizePool::s_maxFreeBlocks = 1000;
+
+FixedSizePool::PoolList& FixedSizePool::GetRegistry()
+{
+    static PoolList pools;
+    return pools;
+}
+
+FixedSizePool::FixedSizePool(char const* name, size_t blockSize, bool locked) : i_name(name),
+    i_blockSize(blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize),
+    i_freeList(NULL), i_freeCount(0), i_inUse(0), i_peakInUse(0), i_allocations(0), i_recycled(0),
+    i_locked(locked)
+{
+    GetRegistry().push_back(this);
+}
+
+FixedSizePool::~FixedSizePool()
+{
+    GetRegistry().remove(this);
+
+    while(i_freeList)
+    {
+        FreeBlock* block = i_freeList;
+        i_freeList = block->next;
+        ::operator delete(block);
+    }
+}
+
+void* FixedSizePool::AllocateLocked()
+{
+    void* block;
+    {
+        ZThread::Guard<ZThread::FastMutex> guard(i_lock);
+        block = PopFreeBlock();
+    }
+
+    return block ? block : ::operator new(i_blockSize);
+}
+
+void FixedSizePool::ReleaseLocked(void* block)
+{
+    bool kept;
+    {
+        ZThread::Guard<ZThread::FastMutex> guard(i_lock);
+        kept = PushFreeBlock(block);
+    }
+
+    if(!kept)
+        ::operator delete(block);
+}
+
+// update field array lengths of all object types
+static uint16 const valuesArrayCounts[] =
+{
+    ITEM_END, CONTAINER_END, UNIT_END, PLAYER_END, GAMEOBJECT_END, DYNAMICOBJECT_END, CORPSE_END
+};
+
+#define VALUES_ARRAY_POOL_COUNT (sizeof(valuesArrayCounts) / sizeof(valuesArrayCounts[0]))
+
+// pools created at static initialization and never changed later, so lookup at each object create/delete needs no lock
+static struct ValuesArrayPoolTable
+{
+    ValuesArrayPoolTable()
+    {
+        for(size_t i = 0; i < VALUES_ARRAY_POOL_COUNT; ++i)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "uint32[%u]", uint32(valuesArrayCounts[i]));
+            pools[i] = new FixedSizePool(name, valuesArrayCounts[i] * sizeof(uint32));
+        }
+    }
+
+    FixedSizePool* pools[VALUES_ARRAY_POOL_COUNT];
+} valuesArrayPoolTable;
+
+FixedSizePool* ValuesArrayPool::FindPool(uint16 count)
+{
+    for(size_t i = 0; i < VALUES_ARRAY_POOL_COUNT; ++i)
+        if(valuesArrayCounts[i] == count)
+            return valuesArrayPoolTable.pools[i];
+
+    return NULL;
+}
+
+NodePool::PoolMap& NodePool::GetPoolMap()
+{
+    static PoolMap pools;
+    return pools;
+}
+
+FixedSizePool& NodePool::GetPool(size_t size)
+{
+    // called once per allocator type (PoolAllocator keeps returned pool), pools never removed
+    // no lock: node pools and containers using PoolAllocator are only used from the world thread
+    PoolMap& pools = GetPoolMap();
+    PoolMap::const_iterator itr = pools.find(size);
+    if(itr != pools.end())
+        return *itr->second;
+
+    char name[32];
+    snprintf(name, sizeof(name), "node[%u]", uint32(size));
+    FixedSizePool* pool = new FixedSizePool(name, size, false);
+    pools[size] = pool;
+    return *pool;
+}
+
+uint32* ValuesArrayPool::Allocate(uint16 count)
+{
+    // pools take and give back blocks of the global heap, so arrays of unknown length can use it directly
+    if(FixedSizePool* pool = FindPool(count))
+        return (uint32*)pool->Allocate();
+    return (uint32*)::operator new(count * sizeof(uint32));
+}
+
+void ValuesArrayPool::Release(uint32* values, uint16 count)
+{
+    if(!values)
+        return;
+
+    if(FixedSizePool* pool = FindPool(count))
+        pool->Release(values);
+    else
+        ::operator delete(values);
+}
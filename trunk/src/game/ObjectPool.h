@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_OBJECTPOOL_H
+#define MANGOS_OBJECTPOOL_H
+
+#include "Platform/Define.h"
+#include "zthread/FastMutex.h"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <new>
+#include <string>
+
+// block size up to which pools keep full configured count of released blocks
+#define POOL_FULL_COUNT_BLOCK_SIZE 256
+
+/**
+ * Free list of equally sized memory blocks.
+ *
+ * Released blocks are kept (up to MaxFreeBlocks, fewer for large blocks) and handed out again at next allocation,
+ * so grid load/unload churn of creatures and gameobjects reuse the same memory instead of
+ * going through the heap each time. All pools register self for statistics output.
+ * Pools created not locked must be used only from the world thread.
+ */
+class MANGOS_DLL_SPEC FixedSizePool
+{
+    public:
+        FixedSizePool(char const* name, size_t blockSize, bool locked = true);
+        ~FixedSizePool();
+
+        void* Allocate()
+        {
+            if(i_locked)
+                return AllocateLocked();
+
+            void* block = PopFreeBlock();
+            return block ? block : ::operator new(i_blockSize);
+        }
+
+        void Release(void* block)
+        {
+            if(i_locked)
+                ReleaseLocked(block);
+            else if(!PushFreeBlock(block))
+                ::operator delete(block);
+        }
+
+        char const* GetName() const { return i_name.c_str(); }
+        size_t GetBlockSize() const { return i_blockSize; }
+        uint32 GetInUseCount() const { return i_inUse; }
+        uint32 GetFreeCount() const { return i_freeCount; }
+        uint32 GetPeakInUseCount() const { return i_peakInUse; }
+        uint64 GetAllocationCount() const { return i_allocations; }
+        uint64 GetRecycledCount() const { return i_recycled; }
+
+        static void SetMaxFreeBlocks(uint32 count) { s_maxFreeBlocks = count; }
+
+        typedef std::list<FixedSizePool const*> PoolList;
+        static PoolList const& GetPools() { return GetRegistry(); }
+
+    private:
+        static PoolList& GetRegistry();
+
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        void* PopFreeBlock()
+        {
+            ++i_allocations;
+            if(++i_inUse > i_peakInUse)
+                i_peakInUse = i_inUse;
+
+            if(!i_freeList)
+                return NULL;
+
+            FreeBlock* block = i_freeList;
+            i_freeList = block->next;
+            --i_freeCount;
+            ++i_recycled;
+            return block;
+        }
+
+        bool PushFreeBlock(void* block)
+        {
+            --i_inUse;
+            if(i_freeCount >= GetMaxFreeCount())
+                return false;
+
+            FreeBlock* freeBlock = (FreeBlock*)block;
+            freeBlock->next = i_freeList;
+            i_freeList = freeBlock;
+            ++i_freeCount;
+            return true;
+        }
+
+        // pools of blocks larger than POOL_FULL_COUNT_BLOCK_SIZE keep proportionally fewer released blocks
+        uint32 GetMaxFreeCount() const
+        {
+            if(i_blockSize <= POOL_FULL_COUNT_BLOCK_SIZE)
+                return s_maxFreeBlocks;
+            return uint32(uint64(s_maxFreeBlocks) * POOL_FULL_COUNT_BLOCK_SIZE / i_blockSize);
+        }
+
+        void* AllocateLocked();
+        void ReleaseLocked(void* block);
+
+        std::string i_name;
+        size_t i_blockSize;
+        FreeBlock* i_freeList;
+        uint32 i_freeCount;
+        uint32 i_inUse;
+        uint32 i_peakInUse;
+        uint64 i_allocations;
+        uint64 i_recycled;
+        bool i_locked;
+        ZThread::FastMutex i_lock;
+
+        static uint32 s_maxFreeBlocks;
+};
+
+/**
+ * Pools for the update field arrays of all objects, one FixedSizePool per array length.
+ */
+class MANGOS_DLL_SPEC ValuesArrayPool
+{
+    public:
+        static uint32* Allocate(uint16 count);
+        static void Release(uint32* values, uint16 count);
+
+    private:
+        static FixedSizePool* FindPool(uint16 count);
+};
+
+/**
+ * Shared pools for small nodes of standard containers, one FixedSizePool per node size.
+ */
+class MANGOS_DLL_SPEC NodePool
+{
+    public:
+        static FixedSizePool& GetPool(size_t size);
+
+    private:
+        typedef std::map<size_t, FixedSizePool*> PoolMap;
+        static PoolMap& GetPoolMap();
+};
+
+/**
+ * Standard allocator taking single element allocations (list and tree nodes) from NodePool.
+ *
+ * Containers filled and dropped at high rate (spell target lists) reuse released nodes instead of
+ * going through the heap for each element. Array allocations (n > 1) use the global heap.
+ * Node pools are not locked, so such containers must be used only from the world thread.
+ */
+template<class T>
+class PoolAllocator
+{
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef T const* const_pointer;
+        typedef T& reference;
+        typedef T const& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U> struct rebind { typedef PoolAllocator<U> other; };
+
+        PoolAllocator() {}
+        PoolAllocator(PoolAllocator const&) {}
+        template<class U> PoolAllocator(PoolAllocator<U> const&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, void const* /*hint*/ = 0)
+        {
+            if(n == 1)
+                return (pointer)GetPool().Allocate();
+            return (pointer)::operator new(n * sizeof(T));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            if(n == 1)
+                GetPool().Release(p);
+            else
+                ::operator delete(p);
+        }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer p, T const& value) { new((void*)p) T(value); }
+        void destroy(pointer p) { p->~T(); }
+
+    private:
+        static FixedSizePool& GetPool()
+        {
+            static FixedSizePool& pool = NodePool::GetPool(sizeof(T));
+            return pool;
+        }
+};
+
+template<class T, class U>
+inline bool operator==(PoolAllocator<T> const&, PoolAllocator<U> const&) { return true; }
+template<class T, class U>
+inline bool operator!=(PoolAllocator<T> const&, PoolAllocator<U> const&) { return false; }
+
+// class-level allocation through a FixedSizePool, derived classes with other size use the global heap
+#define DECLARE_POOLED_ALLOCATION(T) \
+    public: \
+        static void* operator new(size_t size); \
+        static void operator delete(void* p, size_t size); \
+        static FixedSizePool& GetPool();
+
+#define IMPLEMENT_POOLED_ALLOCATION(T) \
+    FixedSizePool& T::GetPool() \
+    { \
+        static FixedSizePool pool(#T, sizeof(T)); \
+        return pool; \
+    } \
+    void* T::operator new(size_t size) \
+    { \
+        if(size != sizeof(T)) \
+            return ::operator new(size); \
+        return GetPool().Allocate(); \
+    } \
+    void T::operator delete(void* p, size_t size) \
+    { \
+        if(!p) \
+            return; \
+        if(size != sizeof(T)) \
+        { \
+            ::operator delete(p); \
+            return; \
+        } \
+        GetPool().Release(p); \
+    }
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "OpcodeProfiler.h"
+#include "Log.h"
+#include "Config/ConfigEnv.h"
+#include "Policies/SingletonImp.h"
+#include "zthread/Guard.h"
+
+#include <ace/OS_NS_sys_time.h>
+
+INSTANTIATE_SINGLETON_1(OpcodeProfiler);
+
+OpcodeProfiler::OpcodeProfiler() : m_enabled(false), m_logFile(NULL)
+{
+    Reset();
+}
+
+OpcodeProfiler::~OpcodeProfiler()
+{
+    if(m_logFile)
+        fclose(m_logFile);
+}
+
+uint64 OpcodeProfiler::GetTimeUs()
+{
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    return uint64(now.sec()) * 1000000 + now.usec();
+}
+
+void OpcodeProfiler::AddHandled(uint16 opcode, uint64 startTime)
+{
+    if(opcode >= NUM_MSG_TYPES)
+        return;
+
+    uint64 endTime = GetTimeUs();
+    // system time can be changed while handling
+    uint32 time = endTime > startTime ? uint32(endTime - startTime) : 0;
+
+    uint32 bucket = 0;
+    while(bucket < OPCODE_PROFILE_BUCKETS - 1 && time >= (16U << (2 * bucket)))
+        ++bucket;
+
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    OpcodeHandleStats& stats = m_handled[opcode];
+    ++stats.count;
+    stats.totalTime += time;
+    if(time > stats.maxTime)
+        stats.maxTime = time;
+    ++stats.histogram[bucket];
+}
+
+void OpcodeProfiler::AddSent(uint16 opcode, size_t size)
+{
+    if(opcode >= NUM_MSG_TYPES)
+        return;
+
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    ++m_sent[opcode].count;
+    m_sent[opcode].bytes += size;
+}
+
+void OpcodeProfiler::Reset()
+{
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    memset(m_handled, 0, sizeof(m_handled));
+    memset(m_sent, 0, sizeof(m_sent));
+}
+
+void OpcodeProfiler::GetHandleStats(OpcodeHandleStats* stats) const
+{
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    memcpy(stats, m_handled, sizeof(m_handled));
+}
+
+void OpcodeProfiler::GetSendStats(OpcodeSendStats* stats) const
+{
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    memcpy(stats, m_sent, sizeof(m_sent));
+}
+
+void OpcodeProfiler::OpenLogFile()
+{
+    if(m_logFile)
+        return;
+
+    std::string logname = sConfig.GetStringDefault("OpcodeProfilerLogFile", "");
+    if(logname.empty())
+        return;
+
+    std::string logsDir = sConfig.GetStringDefault("LogsDir","");
+    if(!logsDir.empty())
+    {
+        if((logsDir.at(logsDir.length()-1)!='/') && (logsDir.at(logsDir.length()-1)!='\\'))
+            logsDir.append("/");
+    }
+
+    m_logFile = fopen((logsDir+logname).c_str(), "w");
+    if(!m_logFile)
+    {
+        sLog.outError("Can't open opcode profiler log file %s", (logsDir+logname).c_str());
+        return;
+    }
+
+    fprintf(m_logFile, "# cumulative stats since server start or .server opcodes reset, one line per used opcode\n");
+    fprintf(m_logFile, "# time,recv,opcode,name,count,total_us,max_us,lt16us,lt64us,lt256us,lt1ms,lt4ms,lt16ms,lt65ms,longer\n");
+    fprintf(m_logFile, "# time,send,opcode,name,count,bytes\n");
+    fflush(m_logFile);
+}
+
+void OpcodeProfiler::WriteLog()
+{
+    if(!m_logFile || !m_enabled)
+        return;
+
+    // copies for not hold lock while writing
+    OpcodeHandleStats* handled = new OpcodeHandleStats[NUM_MSG_TYPES];
+    OpcodeSendStats* sent = new OpcodeSendStats[NUM_MSG_TYPES];
+    GetHandleStats(handled);
+    GetSendStats(sent);
+
+    uint64 now = uint64(time(NULL));
+
+    for(uint32 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        OpcodeHandleStats const& stats = handled[opcode];
+        if(!stats.count)
+            continue;
+
+        fprintf(m_logFile, I64FMTD ",recv,%u,%s," I64FMTD "," I64FMTD ",%u",
+            now, opcode, LookupOpcodeName(opcode), stats.count, stats.totalTime, stats.maxTime);
+        for(int i = 0; i < OPCODE_PROFILE_BUCKETS; ++i)
+            fprintf(m_logFile, "," I64FMTD, stats.histogram[i]);
+        fprintf(m_logFile, "\n");
+    }
+
+    for(uint32 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        if(!sent[opcode].count)
+            continue;
+
+        fprintf(m_logFile, I64FMTD ",send,%u,%s," I64FMTD "," I64FMTD "\n",
+            now, opcode, LookupOpcodeName(opcode), sent[opcode].count, sent[opcode].bytes);
+    }
+
+    fflush(m_logFile);
+
+    delete[] handled;
+    delete[] sent;
+}
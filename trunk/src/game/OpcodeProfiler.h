@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_OPCODEPROFILER_H
+#define MANGOS_OPCODEPROFILER_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "Opcodes.h"
+#include "zthread/FastMutex.h"
+
+// handle time histogram buckets: < 16us, < 64us, < 256us, < 1ms, < 4ms, < 16ms, < 65ms, longer
+#define OPCODE_PROFILE_BUCKETS 8
+
+struct OpcodeHandleStats
+{
+    uint64 count;
+    uint64 totalTime;                                       // in microseconds
+    uint32 maxTime;
+    uint64 histogram[OPCODE_PROFILE_BUCKETS];
+};
+
+struct OpcodeSendStats
+{
+    uint64 count;
+    uint64 bytes;
+};
+
+/**
+ * Count and handler time of received opcodes and count and size of sent opcodes.
+ *
+ * Handled opcodes are recorded by WorldSession::Update (world thread) and ProcessPacketInPlace
+ * (network threads), sent opcodes by WorldSession::SendPacket. Stats are cumulative since server
+ * start or last Reset and written to log file with header described format at each WriteLog.
+ */
+class OpcodeProfiler
+{
+    public:
+        OpcodeProfiler();
+        ~OpcodeProfiler();
+
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        bool IsEnabled() const { return m_enabled; }
+
+        // current time in microseconds, for handle time measure
+        static uint64 GetTimeUs();
+
+        void AddHandled(uint16 opcode, uint64 startTime);
+        void AddSent(uint16 opcode, size_t size);
+        void Reset();
+
+        // copies of stats, made under lock
+        void GetHandleStats(OpcodeHandleStats* stats) const;
+        void GetSendStats(OpcodeSendStats* stats) const;
+
+        void OpenLogFile();
+        void WriteLog();
+
+    private:
+        OpcodeHandleStats m_handled[NUM_MSG_TYPES];
+        OpcodeSendStats m_sent[NUM_MSG_TYPES];
+        bool m_enabled;
+        FILE* m_logFile;
+
+        mutable ZThread::FastMutex m_lock;
+};
+
+#define sOpcodeProfiler MaNGOS::Singleton<OpcodeProfiler>::Instance()
+
+#endif
@@ -1102,6 +1102,14 @@ enum SessionStatus
     STATUS_NEVER                                            ///< Opcode not accepted from client (deprecated or server side only)
 };
 
+/// Thread where opcode handler is called
+enum PacketProcessing
+{
+    PROCESS_THREADUNSAFE = 0,                               ///< World thread at session update, may use any world data
+    PROCESS_MAP_LOCAL,                                      ///< Use only player and objects of player map, called at session update for now
+    PROCESS_THREADSAFE                                      ///< Not use player or changeable world data, called at receive in network thread
+};
+
 class WorldSession;
 class WorldPacket;
 
@@ -1109,6 +1117,7 @@ struct OpcodeHandler
 {
     char const* name;
     SessionStatus status;
+    PacketProcessing packetProcessing;
     void (WorldSession::*handler)(WorldPacket& recvPacket);
 };
 
@@ -63,6 +63,7 @@ uint32 const LevelStartLoyalty[6] =
 Pet::Pet(PetType type) : Creature()
 {
     m_isPet = true;
+    m_idleSleepAllowed = false;
     m_name = "Pet";
     m_petType = type;
 
@@ -1309,9 +1310,7 @@ void Pet::_SaveSpells()
 
 void Pet::_LoadAuras(uint32 timediff)
 {
-    m_Auras.clear();
-    for (int i = 0; i < TOTAL_AURAS; i++)
-        m_modAuras[i].clear();
+    _ClearAuraStorage();
 
     // all aura related fields
     for(int i = UNIT_FIELD_AURA; i <= UNIT_FIELD_AURASTATE; ++i)
@@ -58,6 +58,7 @@
 #include "Database/DatabaseImpl.h"
 #include "Spell.h"
 #include "SocialMgr.h"
+#include "MovementRelay.h"
 
 #include <cmath>
 
@@ -249,6 +250,10 @@ Player::Player (WorldSession *session): Unit()
 {
     m_transport = 0;
 
+    m_hasPendingHeartbeat = false;
+    m_relayedHeartbeats = 0;
+    m_heartbeatViewers = 0;
+
     m_speakTime = 0;
     m_speakCount = 0;
 
@@ -1459,6 +1464,9 @@ bool Player::TeleportTo(uint32 mapid, float x, float y, float z, float orientati
         sLog.outDebug("Player %s will teleported to map %u", GetName(), mapid);
     }
 
+    // position before teleport not need to be relayed
+    DiscardPendingHeartbeat();
+
     // if we were on a transport, leave
     if (!(options & TELE_TO_NOT_LEAVE_TRANSPORT) && m_transport)
     {
@@ -1682,6 +1690,8 @@ void Player::AddToWorld()
 
 void Player::RemoveFromWorld()
 {
+    DiscardPendingHeartbeat();
+
     // cleanup
     if(IsInWorld())
     {
@@ -5202,6 +5212,48 @@ void Player::SendMessageToSetInRange(WorldPacket *data, float dist, bool self, b
     MapManager::Instance().GetMap(GetMapId(), this)->MessageDistBroadcast(this, data, dist, self,own_team_only);
 }
 
+void Player::SendMovementToSet(WorldPacket *data)
+{
+    Map* map = MapManager::Instance().GetMap(GetMapId(), this);
+
+    bool wasPending = m_hasPendingHeartbeat;
+    if(m_hasPendingHeartbeat)
+    {
+        // superseded by later movement in same tick
+        MovementRelayStats& stats = sMovementRelay.GetStats(MovementRelay::GetMapType(map));
+        ++stats.merged;
+        stats.savedBytes += uint64(m_heartbeatViewers) * m_pendingHeartbeat.size();
+        m_hasPendingHeartbeat = false;
+    }
+
+    if(data->GetOpcode() == MSG_MOVE_HEARTBEAT)
+    {
+        if(sWorld.getConfig(CONFIG_MOVEMENT_RELAY_MERGE_HEARTBEATS))
+        {
+            // keep storage of pending packet, sent at world tick end
+            m_pendingHeartbeat.Initialize(data->GetOpcode(), data->size());
+            m_pendingHeartbeat.append(data->contents(), data->size());
+            m_hasPendingHeartbeat = true;
+            if(!wasPending)
+                sMovementRelay.AddPendingHeartbeat(GetGUID());
+            return;
+        }
+
+        m_heartbeatViewers = map->MovementBroadcast(this, data, ++m_relayedHeartbeats);
+    }
+    else
+        m_heartbeatViewers = map->MovementBroadcast(this, data, 0);
+}
+
+void Player::SendPendingHeartbeat()
+{
+    if(!m_hasPendingHeartbeat || !IsInWorld())
+        return;
+
+    m_hasPendingHeartbeat = false;
+    m_heartbeatViewers = MapManager::Instance().GetMap(GetMapId(), this)->MovementBroadcast(this, &m_pendingHeartbeat, ++m_relayedHeartbeats);
+}
+
 void Player::SendDirectMessage(WorldPacket *data)
 {
     GetSession()->SendPacket(data);
@@ -6366,6 +6418,8 @@ void Player::_ApplyItemMods(Item *item, uint8 slot,bool apply)
 
     sLog.outDetail("applying mods for item %u ",item->GetGUIDLow());
 
+    DeferStatUpdates();
+
     uint32 attacktype = Player::GetAttackBySlot(slot);
     if(attacktype < MAX_ATTACK)
         _ApplyWeaponDependentAuraMods(item,WeaponAttackType(attacktype),apply);
@@ -6381,6 +6435,8 @@ void Player::_ApplyItemMods(Item *item, uint8 slot,bool apply)
     if(proto->Socket[0].Color)                              //only (un)equipping of items with sockets can influence metagems, so no need to waste time with normal items
         CorrectMetaGemEnchants(slot, apply);
 
+    ApplyDeferredStatUpdates();
+
     sLog.outDebug("_ApplyItemMods complete.");
 }
 
@@ -6849,6 +6905,7 @@ void Player::CastItemCombatSpell(Item *item,Unit* Target, WeaponAttackType attTy
 void Player::_RemoveAllItemMods()
 {
     sLog.outDebug("_RemoveAllItemMods start.");
+    DeferStatUpdates();
 
     for (int i = 0; i < INVENTORY_SLOT_BAG_END; i++)
     {
@@ -6891,12 +6948,14 @@ void Player::_RemoveAllItemMods()
         }
     }
 
+    ApplyDeferredStatUpdates();
     sLog.outDebug("_RemoveAllItemMods complete.");
 }
 
 void Player::_ApplyAllItemMods()
 {
     sLog.outDebug("_ApplyAllItemMods start.");
+    DeferStatUpdates();
 
     for (int i = 0; i < INVENTORY_SLOT_BAG_END; i++)
     {
@@ -6940,6 +6999,7 @@ void Player::_ApplyAllItemMods()
         }
     }
 
+    ApplyDeferredStatUpdates();
     sLog.outDebug("_ApplyAllItemMods complete.");
 }
 
@@ -13839,9 +13899,7 @@ void Player::_LoadActions(QueryResult *result)
 
 void Player::_LoadAuras(QueryResult *result, uint32 timediff)
 {
-    m_Auras.clear();
-    for (int i = 0; i < TOTAL_AURAS; i++)
-        m_modAuras[i].clear();
+    _ClearAuraStorage();
 
     // all aura related fields
     for(int i = UNIT_FIELD_AURA; i <= UNIT_FIELD_AURASTATE; ++i)
@@ -15966,6 +16024,26 @@ void Player::AddSpellMod(SpellModifier* mod, bool apply)
     }
 }
 
+void Player::SaveSpellModCharges(SpellModChargesBackup& backup) const
+{
+    backup.mods.clear();
+    backup.removeCount = m_SpellModRemoveCount;
+    for(int i = 0; i < MAX_SPELLMOD; ++i)
+        for(SpellModList::const_iterator itr = m_spellMods[i].begin(); itr != m_spellMods[i].end(); ++itr)
+            if((*itr)->charges)
+                backup.mods.push_back(std::make_pair(*itr, **itr));
+}
+
+void Player::RestoreSpellModCharges(SpellModChargesBackup const& backup)
+{
+    for(std::vector<std::pair<SpellModifier*, SpellModifier> >::const_iterator itr = backup.mods.begin(); itr != backup.mods.end(); ++itr)
+    {
+        itr->first->charges = itr->second.charges;
+        itr->first->lastAffected = itr->second.lastAffected;
+    }
+    m_SpellModRemoveCount = backup.removeCount;
+}
+
 void Player::RemoveSpellMods(Spell const* spell)
 {
     if(!spell || (m_SpellModRemoveCount == 0))
@@ -16070,7 +16148,7 @@ void Player::SetRestBonus (float rest_bonus_new)
 
 void Player::HandleStealthedUnitsDetection()
 {
-    std::list<Unit*> stealthedUnits;
+    UnitList stealthedUnits;
 
     CellPair p(MaNGOS::ComputeCellPair(GetPositionX(),GetPositionY()));
     Cell cell(p);
@@ -16087,7 +16165,7 @@ void Player::HandleStealthedUnitsDetection()
     cell_lock->Visit(cell_lock, world_unit_searcher, *MapManager::Instance().GetMap(GetMapId(), this));
     cell_lock->Visit(cell_lock, grid_unit_searcher, *MapManager::Instance().GetMap(GetMapId(), this));
 
-    for (std::list<Unit*>::iterator i = stealthedUnits.begin(); i != stealthedUnits.end();)
+    for (UnitList::iterator i = stealthedUnits.begin(); i != stealthedUnits.end();)
     {
         if((*i)==this)
         {
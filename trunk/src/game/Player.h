@@ -91,6 +91,13 @@ struct SpellModifier
 typedef HM_NAMESPACE::hash_map<uint16, PlayerSpell*> PlayerSpellMap;
 typedef std::list<SpellModifier*> SpellModList;
 
+// charges of spell mods, saved before damage calculations that are not real casts and restored after
+struct SpellModChargesBackup
+{
+    std::vector<std::pair<SpellModifier*, SpellModifier> > mods;
+    int32 removeCount;
+};
+
 struct SpellCooldown
 {
     time_t end;
@@ -1423,6 +1430,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         bool IsAffectedBySpellmod(SpellEntry const *spellInfo, SpellModifier *mod, Spell const* spell = NULL);
         template <class T> T ApplySpellMod(uint32 spellId, SpellModOp op, T &basevalue, Spell const* spell = NULL);
         void RemoveSpellMods(Spell const* spell);
+        void SaveSpellModCharges(SpellModChargesBackup& backup) const;
+        void RestoreSpellModCharges(SpellModChargesBackup const& backup);
 
         bool HasSpellCooldown(uint32 spell_id) const
         {
@@ -1620,6 +1629,9 @@ class MANGOS_DLL_SPEC Player : public Unit
         void SendMessageToSetInRange(WorldPacket *data, float fist, bool self);
                                                             // overwrite Object::SendMessageToSetInRange
         void SendMessageToSetInRange(WorldPacket *data, float dist, bool self, bool own_team_only);
+        void SendMovementToSet(WorldPacket *data);          // relay of own movement, see MovementRelay.h
+        void SendPendingHeartbeat();
+        void DiscardPendingHeartbeat() { m_hasPendingHeartbeat = false; }
 
         static void DeleteFromDB(uint64 playerguid, uint32 accountId, bool updateRealmChars = true);
 
@@ -2224,6 +2236,12 @@ class MANGOS_DLL_SPEC Player : public Unit
         // Transports
         Transport * m_transport;
 
+        // Movement relay, last heartbeat received in current tick and count of relayed heartbeats
+        WorldPacket m_pendingHeartbeat;
+        bool m_hasPendingHeartbeat;
+        uint32 m_relayedHeartbeats;
+        uint32 m_heartbeatViewers;                          // viewers of last relayed movement, for merged heartbeat saved bytes estimate
+
         uint32 m_resetTalentsCost;
         time_t m_resetTalentsTime;
         uint32 m_usedTalentCount;
@@ -31,6 +31,7 @@
 #include "NPCHandler.h"
 #include "ObjectAccessor.h"
 #include "Pet.h"
+#include "QueryResponseCache.h"
 
 void WorldSession::SendNameQueryOpcode(Player *p)
 {
@@ -148,18 +149,26 @@ void WorldSession::HandleCreatureQueryOpcode( WorldPacket & recv_data )
 {
     CHECK_PACKET_SIZE(recv_data,4+8);
 
+    // called in network thread, see QueryResponseCache
+    ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getReadLock());
+
     uint32 entry;
     recv_data >> entry;
 
     CreatureInfo const *ci = objmgr.GetCreatureTemplate(entry);
     if (ci)
     {
+        int loc_idx = GetSessionDbLocaleIndex();
+        if (WorldPacket const* cached = sQueryResponseCache.Find(QUERY_CACHE_CREATURE, entry, loc_idx))
+        {
+            SendPacket( cached );
+            return;
+        }
 
         std::string Name, SubName;
         Name = ci->Name;
         SubName = ci->SubName;
 
-        int loc_idx = GetSessionDbLocaleIndex();
         if (loc_idx >= 0)
         {
             CreatureLocale const *cl = objmgr.GetCreatureLocale(entry);
@@ -192,6 +201,7 @@ void WorldSession::HandleCreatureQueryOpcode( WorldPacket & recv_data )
         data << (float)1.0f;                                // unk
         data << (float)1.0f;                                // unk
         data << (uint8)ci->RacialLeader;
+        sQueryResponseCache.Store(QUERY_CACHE_CREATURE, entry, loc_idx, data);
         SendPacket( &data );
         sLog.outDebug(  "WORLD: Sent SMSG_CREATURE_QUERY_RESPONSE " );
     }
@@ -213,12 +223,21 @@ void WorldSession::HandleGameObjectQueryOpcode( WorldPacket & recv_data )
 {
     CHECK_PACKET_SIZE(recv_data,4+8);
 
+    // called in network thread, see QueryResponseCache
+    ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getReadLock());
+
     uint32 entryID;
     recv_data >> entryID;
 
     const GameObjectInfo *info = objmgr.GetGameObjectInfo(entryID);
     if(info)
     {
+        int loc_idx = GetSessionDbLocaleIndex();
+        if (WorldPacket const* cached = sQueryResponseCache.Find(QUERY_CACHE_GAMEOBJECT, entryID, loc_idx))
+        {
+            SendPacket( cached );
+            return;
+        }
 
         std::string Name;
         std::string CastBarCaption;
@@ -226,7 +245,6 @@ void WorldSession::HandleGameObjectQueryOpcode( WorldPacket & recv_data )
         Name = info->name;
         CastBarCaption = info->castBarCaption;
 
-        int loc_idx = GetSessionDbLocaleIndex();
         if (loc_idx >= 0)
         {
             GameObjectLocale const *gl = objmgr.GetGameObjectLocale(entryID);
@@ -250,6 +268,7 @@ void WorldSession::HandleGameObjectQueryOpcode( WorldPacket & recv_data )
         data << uint8(0);                                   // 2.0.3, probably string
         data.append(info->raw.data,24);
         data << float(info->size);                          // go size
+        sQueryResponseCache.Store(QUERY_CACHE_GAMEOBJECT, entryID, loc_idx, data);
         SendPacket( &data );
         sLog.outDebug(  "WORLD: Sent CMSG_GAMEOBJECT_QUERY " );
     }
@@ -307,6 +326,16 @@ void WorldSession::HandleNpcTextQueryOpcode( WorldPacket & recv_data )
 
     pGossip = objmgr.GetGossipText(textID);
 
+    int loc_idx = GetSessionDbLocaleIndex();
+    if (pGossip)
+    {
+        if (WorldPacket const* cached = sQueryResponseCache.Find(QUERY_CACHE_NPC_TEXT, textID, loc_idx))
+        {
+            SendPacket( cached );
+            return;
+        }
+    }
+
     WorldPacket data( SMSG_NPC_TEXT_UPDATE, 100 );          // guess size
     data << textID;
 
@@ -335,7 +364,6 @@ void WorldSession::HandleNpcTextQueryOpcode( WorldPacket & recv_data )
             Text_1[i]=pGossip->Options[i].Text_1;
         }
 
-        int loc_idx = GetSessionDbLocaleIndex();
         if (loc_idx >= 0)
         {
             NpcTextLocale const *nl = objmgr.GetNpcTextLocale(textID);
@@ -376,6 +404,8 @@ void WorldSession::HandleNpcTextQueryOpcode( WorldPacket & recv_data )
             data << pGossip->Options[i].Emotes[2]._Delay;
             data << pGossip->Options[i].Emotes[2]._Emote;
         }
+
+        sQueryResponseCache.Store(QUERY_CACHE_NPC_TEXT, textID, loc_idx, data);
     }
 
     SendPacket( &data );
@@ -387,14 +417,29 @@ void WorldSession::HandlePageQueryOpcode( WorldPacket & recv_data )
 {
     CHECK_PACKET_SIZE(recv_data,4);
 
+    // called in network thread, see QueryResponseCache
+    ZThread::Guard<ZThread::Lockable> guard(sQueryResponseCache.GetDataLock().getReadLock());
+
     uint32 pageID;
 
     recv_data >> pageID;
     sLog.outDetail("WORLD: Received CMSG_PAGE_TEXT_QUERY for pageID '%u'", pageID);
 
+    int loc_idx = GetSessionDbLocaleIndex();
+
     while (pageID)
     {
         PageText const *pPage = sPageTextStore.LookupEntry<PageText>( pageID );
+
+        if (pPage)
+        {
+            if (WorldPacket const* cached = sQueryResponseCache.Find(QUERY_CACHE_PAGE_TEXT, pageID, loc_idx))
+            {
+                SendPacket( cached );
+                pageID = pPage->Next_Page;
+                continue;
+            }
+        }
                                                             // guess size
         WorldPacket data( SMSG_PAGE_TEXT_QUERY_RESPONSE, 50 );
         data << pageID;
@@ -409,7 +454,6 @@ void WorldSession::HandlePageQueryOpcode( WorldPacket & recv_data )
         {
             std::string Text = pPage->Text;
 
-            int loc_idx = GetSessionDbLocaleIndex();
             if (loc_idx >= 0)
             {
                 PageTextLocale const *pl = objmgr.GetPageTextLocale(pageID);
@@ -422,6 +466,7 @@ void WorldSession::HandlePageQueryOpcode( WorldPacket & recv_data )
 
             data << Text;
             data << uint32(pPage->Next_Page);
+            sQueryResponseCache.Store(QUERY_CACHE_PAGE_TEXT, pageID, loc_idx, data);
             pageID = pPage->Next_Page;
         }
         SendPacket( &data );
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "QueryResponseCache.h"
+#include "WorldPacket.h"
+#include "Policies/SingletonImp.h"
+
+INSTANTIATE_SINGLETON_1(QueryResponseCache);
+
+QueryResponseCache::QueryResponseCache() : m_enabled(true)
+{
+    for(int i = 0; i < MAX_QUERY_CACHE_TYPE; ++i)
+    {
+        m_bytes[i] = 0;
+        m_hits[i] = 0;
+        m_misses[i] = 0;
+    }
+}
+
+QueryResponseCache::~QueryResponseCache()
+{
+    ClearAll();
+}
+
+WorldPacket const* QueryResponseCache::Find(QueryCacheType type, uint32 entry, int loc_idx)
+{
+    if(!m_enabled)
+        return NULL;
+
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    ResponseMap::const_iterator itr = m_responses[type].find(MakeKey(entry, loc_idx));
+    if(itr == m_responses[type].end())
+    {
+        ++m_misses[type];
+        return NULL;
+    }
+
+    ++m_hits[type];
+    return itr->second;
+}
+
+void QueryResponseCache::Store(QueryCacheType type, uint32 entry, int loc_idx, WorldPacket const& data)
+{
+    if(!m_enabled)
+        return;
+
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    // already stored by other thread handling same query, keep it: can be in sending now
+    WorldPacket*& response = m_responses[type][MakeKey(entry, loc_idx)];
+    if(response)
+        return;
+
+    response = new WorldPacket(data);
+    m_bytes[type] += response->size();
+}
+
+void QueryResponseCache::Clear(QueryCacheType type)
+{
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    for(ResponseMap::iterator itr = m_responses[type].begin(); itr != m_responses[type].end(); ++itr)
+        delete itr->second;
+
+    m_responses[type].clear();
+    m_bytes[type] = 0;
+}
+
+void QueryResponseCache::ClearAll()
+{
+    for(int i = 0; i < MAX_QUERY_CACHE_TYPE; ++i)
+        Clear(QueryCacheType(i));
+}
+
+void QueryResponseCache::SetEnabled(bool enabled)
+{
+    ZThread::Guard<ZThread::Lockable> guard(m_dataLock.getWriteLock());
+
+    m_enabled = enabled;
+
+    if(!m_enabled)
+        ClearAll();
+}
+
+char const* QueryResponseCache::GetTypeName(QueryCacheType type)
+{
+    switch(type)
+    {
+        case QUERY_CACHE_ITEM:       return "item";
+        case QUERY_CACHE_CREATURE:   return "creature";
+        case QUERY_CACHE_GAMEOBJECT: return "gameobject";
+        case QUERY_CACHE_QUEST:      return "quest";
+        case QUERY_CACHE_NPC_TEXT:   return "npc text";
+        case QUERY_CACHE_PAGE_TEXT:  return "page text";
+    }
+    return "unknown";
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_QUERYRESPONSECACHE_H
+#define MANGOS_QUERYRESPONSECACHE_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "Utilities/HashMap.h"
+#include "zthread/FairReadWriteLock.h"
+#include "zthread/FastMutex.h"
+#include "zthread/Guard.h"
+
+class WorldPacket;
+
+enum QueryCacheType
+{
+    QUERY_CACHE_ITEM        = 0,                            // SMSG_ITEM_QUERY_SINGLE_RESPONSE
+    QUERY_CACHE_CREATURE    = 1,                            // SMSG_CREATURE_QUERY_RESPONSE
+    QUERY_CACHE_GAMEOBJECT  = 2,                            // SMSG_GAMEOBJECT_QUERY_RESPONSE
+    QUERY_CACHE_QUEST       = 3,                            // SMSG_QUEST_QUERY_RESPONSE
+    QUERY_CACHE_NPC_TEXT    = 4,                            // SMSG_NPC_TEXT_UPDATE
+    QUERY_CACHE_PAGE_TEXT   = 5                             // SMSG_PAGE_TEXT_QUERY_RESPONSE
+};
+
+#define MAX_QUERY_CACHE_TYPE 6
+
+/**
+ * Prebuilt responses of query opcodes sending only static template data.
+ *
+ * Responses are stored at first build per (entry, session db locale index) and later requests
+ * send the stored packet as is. Data of a type must be dropped by Clear(type) at reload of
+ * any table used in its response.
+ *
+ * Item, creature, gameobject and page text queries are handled in network threads: their
+ * handlers hold the data lock for read while using template data and the found response,
+ * reload of tables used by them (and Clear) must be done with the data lock held for write.
+ */
+class QueryResponseCache
+{
+    public:
+        QueryResponseCache();
+        ~QueryResponseCache();
+
+        // NULL if response not stored yet (counted as miss)
+        WorldPacket const* Find(QueryCacheType type, uint32 entry, int loc_idx);
+        void Store(QueryCacheType type, uint32 entry, int loc_idx, WorldPacket const& data);
+
+        void Clear(QueryCacheType type);
+        void ClearAll();
+
+        void SetEnabled(bool enabled);
+        bool IsEnabled() const { return m_enabled; }
+
+        ZThread::ReadWriteLock& GetDataLock() { return m_dataLock; }
+
+        // statistics
+        static char const* GetTypeName(QueryCacheType type);
+        uint32 GetResponseCount(QueryCacheType type) const { return m_responses[type].size(); }
+        size_t GetResponseBytes(QueryCacheType type) const { return m_bytes[type]; }
+        uint64 GetHitCount(QueryCacheType type) const { return m_hits[type]; }
+        uint64 GetMissCount(QueryCacheType type) const { return m_misses[type]; }
+
+    private:
+        typedef HM_NAMESPACE::hash_map<uint64, WorldPacket*> ResponseMap;
+
+        static uint64 MakeKey(uint32 entry, int loc_idx) { return (uint64(loc_idx + 1) << 32) | entry; }
+
+        ResponseMap m_responses[MAX_QUERY_CACHE_TYPE];
+        size_t m_bytes[MAX_QUERY_CACHE_TYPE];
+        uint64 m_hits[MAX_QUERY_CACHE_TYPE];
+        uint64 m_misses[MAX_QUERY_CACHE_TYPE];
+        bool m_enabled;
+
+        ZThread::FairReadWriteLock m_dataLock;              // template data and stored responses use
+        ZThread::FastMutex m_lock;                          // response maps and counters change
+};
+
+#define sQueryResponseCache MaNGOS::Singleton<QueryResponseCache>::Instance()
+
+#endif
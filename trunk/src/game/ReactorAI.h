@@ -35,6 +35,7 @@ class MANGOS_DLL_DECL ReactorAI : public CreatureAI
         bool IsVisible(Unit *) const;
 
         void UpdateAI(const uint32);
+        bool CanSleep() const { return true; }
         static int Permissible(const Creature *);
 
     private:
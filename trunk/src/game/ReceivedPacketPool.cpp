@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ReceivedPacketPool.h"
+
+// kept free packets per network thread, more returned packets deleted
+#define MAX_FREE_RECEIVED_PACKETS 128
+
+ReceivedWorldPacket* ReceivedPacketPool::Acquire(uint16 opcode, size_t size)
+{
+    if(!m_free)
+    {
+        ReceivedWorldPacket* packet = m_returned.PopAll();
+        while(packet)
+        {
+            ReceivedWorldPacket* next = packet->m_next;
+            if(m_freeCount < MAX_FREE_RECEIVED_PACKETS)
+            {
+                packet->m_next = m_free;
+                m_free = packet;
+                ++m_freeCount;
+            }
+            else
+                delete packet;
+            packet = next;
+        }
+    }
+
+    ReceivedWorldPacket* packet = m_free;
+    if(packet)
+    {
+        m_free = packet->m_next;
+        --m_freeCount;
+    }
+    else
+        packet = new ReceivedWorldPacket(this);
+
+    packet->m_next = NULL;
+    packet->Initialize(opcode, size);
+    return packet;
+}
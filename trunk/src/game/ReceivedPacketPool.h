@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_RECEIVEDPACKETPOOL_H
+#define MANGOS_RECEIVEDPACKETPOOL_H
+
+#include "Common.h"
+#include "WorldPacket.h"
+#include "Utilities/MPSCQueue.h"
+
+class ReceivedPacketPool;
+
+/// Packet received from client, owned by pool of the network thread that received it
+class ReceivedWorldPacket : public WorldPacket
+{
+    public:
+        explicit ReceivedWorldPacket(ReceivedPacketPool* pool) : m_next(NULL), m_pool(pool) {}
+
+        /// Return packet to its pool, can be called from any thread
+        void Release();
+
+        ReceivedWorldPacket* m_next;                        // link in session receive queue or pool lists
+    private:
+        ReceivedPacketPool* m_pool;
+};
+
+typedef MPSCQueue<ReceivedWorldPacket, &ReceivedWorldPacket::m_next> ReceivedPacketQueue;
+
+/**
+ * Pool of received packets of one network thread.
+ *
+ * Acquire must be called only from the owner network thread, packets released by other threads
+ * (world thread after session handling) are pushed to lock-free returned queue and moved to the
+ * free list at next Acquire with empty free list. Reused packets keep storage capacity.
+ *
+ * Pool is never deleted: sessions can release packets after network threads stop.
+ */
+class ReceivedPacketPool
+{
+    public:
+        ReceivedPacketPool() : m_free(NULL), m_freeCount(0) {}
+
+        ReceivedWorldPacket* Acquire(uint16 opcode, size_t size);
+        void Release(ReceivedWorldPacket* packet) { m_returned.Push(packet); }
+
+    private:
+        ReceivedPacketPool(ReceivedPacketPool const&);
+        ReceivedPacketPool& operator=(ReceivedPacketPool const&);
+
+        ReceivedWorldPacket* m_free;                        // owner thread only
+        uint32 m_freeCount;
+        ReceivedPacketQueue m_returned;
+};
+
+inline void ReceivedWorldPacket::Release()
+{
+    m_pool->Release(this);
+}
+
+/// Release received packet at scope exit unless ownership passed by release()
+class ReceivedPacketHolder
+{
+    public:
+        explicit ReceivedPacketHolder(ReceivedWorldPacket* packet) : i_packet(packet) {}
+        ~ReceivedPacketHolder() { if(i_packet) i_packet->Release(); }
+
+        ReceivedWorldPacket* release() { ReceivedWorldPacket* packet = i_packet; i_packet = NULL; return packet; }
+
+    private:
+        ReceivedPacketHolder(ReceivedPacketHolder const&);
+        ReceivedPacketHolder& operator=(ReceivedPacketHolder const&);
+
+        ReceivedWorldPacket* i_packet;
+};
+
+#endif
@@ -28,6 +28,7 @@ class Player;
 class GameObject;
 class Group;
 class Aura;
+struct SpellCastPlan;
 
 enum SpellCastTargetFlags
 {
@@ -298,6 +299,8 @@ class Spell
         Spell( Unit* Caster, SpellEntry const *info, bool triggered, uint64 originalCasterGUID = 0, Spell** triggeringContainer = NULL );
         ~Spell();
 
+        DECLARE_POOLED_ALLOCATION(Spell)
+
         void prepare(SpellCastTargets * targets, Aura* triggeredByAura = NULL);
         void cancel();
         void update(uint32 difftime);
@@ -338,10 +341,11 @@ class Spell
         void WriteAmmoToPacket( WorldPacket * data );
         void FillTargetMap();
 
-        void SetTargetMap(uint32 i,uint32 cur,std::list<Unit*> &TagUnitMap);
+        void SetTargetMap(uint32 i,uint32 cur,UnitList &TagUnitMap);
 
         Unit* SelectMagnetTarget();
-        bool CheckTarget( Unit* target, uint32 eff, bool hitPhase );
+        bool CheckTarget( Unit* target, uint32 eff, bool hitPhase, bool checkLOS = true );
+        void FilterTargetsByLOS( UnitList& targets, uint32 eff );
 
         void SendCastResult(uint8 result);
         void SendSpellStart();
@@ -409,6 +413,9 @@ class Spell
 
         Unit* m_caster;
 
+        SpellCastPlan const* m_castPlan;                    // spell constant targeting and range data from SpellMgr
+        bool m_ownCastPlan;                                 // m_castPlan calculated for this spell only (before plans loaded)
+
         uint64 m_originalCasterGUID;                        // real source of cast (aura caster/etc), used for spell targets selection
                                                             // e.g. damage around area spell trigered by victim aura and da,age emeies of aura caster
         Unit* m_originalCaster;                             // cached pointer for m_originalCaster, updated at Spell::UpdatePointers()
@@ -471,7 +478,8 @@ class Spell
             uint8  effectMask:8;
             bool   processed:1;
         };
-        std::list<TargetInfo> m_UniqueTargetInfo;
+        typedef std::list<TargetInfo, PoolAllocator<TargetInfo> > TargetList;
+        TargetList m_UniqueTargetInfo;
         uint8 m_needAliveTargetMask;                        // Mask req. alive targets
 
         struct GOTargetInfo
@@ -481,14 +489,16 @@ class Spell
             uint8  effectMask:8;
             bool   processed:1;
         };
-        std::list<GOTargetInfo> m_UniqueGOTargetInfo;
+        typedef std::list<GOTargetInfo, PoolAllocator<GOTargetInfo> > GOTargetList;
+        GOTargetList m_UniqueGOTargetInfo;
 
         struct ItemTargetInfo
         {
             Item  *item;
             uint8 effectMask;
         };
-        std::list<ItemTargetInfo> m_UniqueItemInfo;
+        typedef std::list<ItemTargetInfo, PoolAllocator<ItemTargetInfo> > ItemTargetList;
+        ItemTargetList m_UniqueItemInfo;
 
         void AddUnitTarget(Unit* target, uint32 effIndex);
         void AddUnitTarget(uint64 unitGUID, uint32 effIndex);
@@ -503,7 +513,7 @@ class Spell
         // -------------------------------------------
 
         //List For Triggered Spells
-        typedef std::list<SpellEntry const*> TriggerSpells;
+        typedef std::list<SpellEntry const*, PoolAllocator<SpellEntry const*> > TriggerSpells;
         TriggerSpells m_TriggerSpells;
 
         uint32 m_spellState;
@@ -542,13 +552,13 @@ namespace MaNGOS
 {
     struct MANGOS_DLL_DECL SpellNotifierPlayer
     {
-        std::list<Unit*> &i_data;
+        UnitList &i_data;
         Spell &i_spell;
         const uint32& i_index;
         float i_radius;
         Unit* i_originalCaster;
 
-        SpellNotifierPlayer(Spell &spell, std::list<Unit*> &data, const uint32 &i, float radius)
+        SpellNotifierPlayer(Spell &spell, UnitList &data, const uint32 &i, float radius)
             : i_data(data), i_spell(spell), i_index(i), i_radius(radius)
         {
             i_originalCaster = i_spell.GetOriginalCaster();
@@ -577,14 +587,14 @@ namespace MaNGOS
 
     struct MANGOS_DLL_DECL SpellNotifierCreatureAndPlayer
     {
-        std::list<Unit*> *i_data;
+        UnitList *i_data;
         Spell &i_spell;
         const uint32& i_push_type;
         float i_radius;
         SpellTargets i_TargetType;
         Unit* i_originalCaster;
 
-        SpellNotifierCreatureAndPlayer(Spell &spell, std::list<Unit*> &data, float radius, const uint32 &type,
+        SpellNotifierCreatureAndPlayer(Spell &spell, UnitList &data, float radius, const uint32 &type,
             SpellTargets TargetType = SPELL_TARGETS_NOT_FRIENDLY)
             : i_data(&data), i_spell(spell), i_push_type(type), i_radius(radius), i_TargetType(TargetType)
         {
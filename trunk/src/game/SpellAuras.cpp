@@ -609,6 +609,28 @@ void Aura::Update(uint32 diff)
     }
 }
 
+void Aura::SetAuraDuration(int32 duration)
+{
+    m_duration = duration;
+    m_target->WakeUp();
+}
+
+bool Aura::IsUpdateIdle() const
+{
+    // not expiring: no duration/mana per second updates and no remove at 0 duration
+    if (m_duration > 0 || (m_duration == 0 && !m_permanent && !m_isPassive))
+        return false;
+
+    if (m_isPeriodic || m_isAreaAura || m_isPersistent)
+        return false;
+
+    // channeled aura distance check
+    if (IsChanneledSpell(m_spellProto) && m_caster_guid != m_target->GetGUID())
+        return false;
+
+    return true;
+}
+
 void AreaAura::Update(uint32 diff)
 {
     // update for the caster of the aura
@@ -621,7 +643,7 @@ void AreaAura::Update(uint32 diff)
             Unit* owner = caster->GetCharmerOrOwner();
             if (!owner)
                 owner = caster;
-            std::list<Unit *> targets;
+            UnitList targets;
 
             switch(m_areaAuraType)
             {
@@ -701,7 +723,7 @@ void AreaAura::Update(uint32 diff)
                 }
             }
 
-            for(std::list<Unit *>::iterator tIter = targets.begin(); tIter != targets.end(); tIter++)
+            for(UnitList::iterator tIter = targets.begin(); tIter != targets.end(); tIter++)
             {
                 if((*tIter)->HasAura(GetId(), m_effIndex))
                     continue;
@@ -805,7 +827,12 @@ void Aura::ApplyModifier(bool apply, bool Real)
 
     m_in_use = true;
     if(aura<TOTAL_AURAS)
+    {
+        // handlers can read totals of own type and change amount while applying
+        m_target->InvalidateAuraModifierCache(aura);
         (*this.*AuraHandler [aura])(apply,Real);
+        m_target->InvalidateAuraModifierCache(aura);
+    }
     m_in_use = false;
 }
 
@@ -2141,7 +2168,7 @@ void Aura::HandleAuraDummy(bool apply, bool Real)
             // Predatory Strikes
             if(m_target->GetTypeId()==TYPEID_PLAYER && GetSpellProto()->SpellIconID == 1563)
             {
-                ((Player*)m_target)->UpdateAttackPowerAndDamage();
+                m_target->MarkStatsForUpdate(STAT_UPDATE_MOD(UNIT_MOD_ATTACK_POWER));
                 return;
             }
             // Idol of the Emerald Queen
@@ -2265,7 +2292,7 @@ void Aura::HandleAuraPeriodicDummy(bool apply, bool Real)
             {
                 // Update regen on remove
                 if (!apply && m_target->GetTypeId() == TYPEID_PLAYER)
-                    ((Player*)m_target)->UpdateManaRegen();
+                    m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
                 break;
             }
             break;
@@ -3179,7 +3206,7 @@ void Aura::HandleAuraModDisarm(bool apply, bool Real)
     else
         ((Player *)m_target)->SetRegularAttackTime();
 
-    m_target->UpdateDamagePhysical(BASE_ATTACK);
+    m_target->MarkStatsForUpdate(STAT_UPDATE_MOD(UNIT_MOD_DAMAGE_MAINHAND));
 }
 
 void Aura::HandleAuraModStun(bool apply, bool Real)
@@ -4373,7 +4400,7 @@ void Aura::HandleModSpellDamagePercentFromStat(bool apply, bool Real)
     // Magic damage modifiers implemented in Unit::SpellDamageBonus
     // This information for client side use only
     // Recalculate bonus
-    ((Player*)m_target)->UpdateSpellDamageAndHealingBonus();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_SPELL_BONUS);
 }
 
 void Aura::HandleModSpellHealingPercentFromStat(bool apply, bool Real)
@@ -4382,7 +4409,7 @@ void Aura::HandleModSpellHealingPercentFromStat(bool apply, bool Real)
         return;
 
     // Recalculate bonus
-    ((Player*)m_target)->UpdateSpellDamageAndHealingBonus();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_SPELL_BONUS);
 }
 
 void Aura::HandleAuraModDispelResist(bool apply, bool Real)
@@ -4402,7 +4429,7 @@ void Aura::HandleModSpellDamagePercentFromAttackPower(bool apply, bool Real)
     // Magic damage modifiers implemented in Unit::SpellDamageBonus
     // This information for client side use only
     // Recalculate bonus
-    ((Player*)m_target)->UpdateSpellDamageAndHealingBonus();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_SPELL_BONUS);
 }
 
 void Aura::HandleModSpellHealingPercentFromAttackPower(bool apply, bool Real)
@@ -4411,7 +4438,7 @@ void Aura::HandleModSpellHealingPercentFromAttackPower(bool apply, bool Real)
         return;
 
     // Recalculate bonus
-    ((Player*)m_target)->UpdateSpellDamageAndHealingBonus();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_SPELL_BONUS);
 }
 
 void Aura::HandleModHealingDone(bool apply, bool Real)
@@ -4420,7 +4447,7 @@ void Aura::HandleModHealingDone(bool apply, bool Real)
         return;
     // implemented in Unit::SpellHealingBonus
     // this information is for client side only
-    ((Player*)m_target)->UpdateSpellDamageAndHealingBonus();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_SPELL_BONUS);
 }
 
 void Aura::HandleModTotalPercentStat(bool apply, bool Real)
@@ -4432,6 +4459,7 @@ void Aura::HandleModTotalPercentStat(bool apply, bool Real)
     }
 
     //save current and max HP before applying aura
+    m_target->ApplyPendingStatUpdates();
     uint32 curHPValue = m_target->GetHealth();
     uint32 maxHPValue = m_target->GetMaxHealth();
 
@@ -4449,6 +4477,7 @@ void Aura::HandleModTotalPercentStat(bool apply, bool Real)
     if ((m_modifier.m_miscvalue == STAT_STAMINA) && (maxHPValue > 0) && (m_spellProto->Attributes & 0x10))
     {
         // newHP = (curHP / maxHP) * newMaxHP = (newMaxHP * curHP) / maxHP -> which is better because no int -> double -> int conversion is needed
+        m_target->ApplyPendingStatUpdates();
         uint32 newHPValue = (m_target->GetMaxHealth() * curHPValue) / maxHPValue;
         m_target->SetHealth(newHPValue);
     }
@@ -4468,7 +4497,7 @@ void Aura::HandleAuraModResistenceOfStatPercent(bool apply, bool Real)
     }
 
     // Recalculate Armor
-    m_target->UpdateArmor();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_MOD(UNIT_MOD_ARMOR));
 }
 
 /********************************/
@@ -4586,7 +4615,7 @@ void Aura::HandleModPowerRegen(bool apply, bool Real)       // drinking
     }
     m_isPeriodic = apply;
     if (Real && m_target->GetTypeId() == TYPEID_PLAYER && m_modifier.m_miscvalue == POWER_MANA)
-        ((Player*)m_target)->UpdateManaRegen();
+        m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
 }
 
 void Aura::HandleModPowerRegenPCT(bool apply, bool Real)
@@ -4600,7 +4629,7 @@ void Aura::HandleModPowerRegenPCT(bool apply, bool Real)
 
     // Update manaregen value
     if (m_modifier.m_miscvalue == POWER_MANA)
-        ((Player*)m_target)->UpdateManaRegen();
+        m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
 }
 
 void Aura::HandleModManaRegen(bool apply, bool Real)
@@ -4613,7 +4642,7 @@ void Aura::HandleModManaRegen(bool apply, bool Real)
         return;
 
     //Note: an increase in regen does NOT cause threat.
-    ((Player*)m_target)->UpdateManaRegen();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
 }
 
 void Aura::HandleComprehendLanguage(bool apply, bool Real)
@@ -4639,6 +4668,8 @@ void Aura::HandleAuraModIncreaseHealth(bool apply, bool Real)
                 if(apply)
                 {
                     m_target->HandleStatModifier(UNIT_MOD_HEALTH, TOTAL_VALUE, float(m_modifier.m_amount), apply);
+                    // new max health must be set before health increase
+                    m_target->ApplyPendingStatUpdates();
                     m_target->ModifyHealth(m_modifier.m_amount);
                 }
                 else
@@ -4660,10 +4691,13 @@ void Aura::HandleAuraModIncreaseHealth(bool apply, bool Real)
 
 void  Aura::HandleAuraModIncreaseMaxHealth(bool apply, bool Real)
 {
+    m_target->ApplyPendingStatUpdates();
+
     uint32 oldhealth = m_target->GetHealth();
     double healthPercentage = (double)oldhealth / (double)m_target->GetMaxHealth();
 
     m_target->HandleStatModifier(UNIT_MOD_HEALTH, TOTAL_VALUE, float(m_modifier.m_amount), apply);
+    m_target->ApplyPendingStatUpdates();
 
     // refresh percentage
     if(oldhealth > 0)
@@ -4717,7 +4751,7 @@ void Aura::HandleAuraModDodgePercent(bool apply, bool Real)
     if(m_target->GetTypeId()!=TYPEID_PLAYER)
         return;
 
-    ((Player*)m_target)->UpdateDodgePercentage();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_DODGE);
     //sLog.outError("BONUS DODGE CHANCE: + %f", float(m_modifier.m_amount));
 }
 
@@ -4739,7 +4773,7 @@ void Aura::HandleAuraModRegenInterrupt(bool apply, bool Real)
     if(m_target->GetTypeId()!=TYPEID_PLAYER)
         return;
 
-    ((Player*)m_target)->UpdateManaRegen();
+    m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
 }
 
 void Aura::HandleAuraModCritPercent(bool apply, bool Real)
@@ -4790,7 +4824,7 @@ void Aura::HandleModSpellCritChance(bool apply, bool Real)
 
     if(m_target->GetTypeId() == TYPEID_PLAYER)
     {
-        ((Player*)m_target)->UpdateAllSpellCritChances();
+        m_target->MarkStatsForUpdate(STAT_UPDATE_SPELL_CRIT);
     }
     else
     {
@@ -4945,7 +4979,7 @@ void Aura::HandleAuraModRangedAttackPowerOfStatPercent(bool apply, bool Real)
     }
 
     // Recalculate bonus
-    ((Player*)m_target)->UpdateAttackPowerAndDamage(true);
+    m_target->MarkStatsForUpdate(STAT_UPDATE_MOD(UNIT_MOD_ATTACK_POWER_RANGED));
 }
 
 /********************************/
@@ -6084,7 +6118,8 @@ void Aura::PeriodicDummyTick()
                     if (tick == 0)
                     {
                         (*i)->GetModifier()->m_amount = m_modifier.m_amount;
-                        ((Player*)m_target)->UpdateManaRegen();
+                        m_target->InvalidateAuraModifierCache(SPELL_AURA_MOD_POWER_REGEN);
+                        m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
                         // Disable continue
                         m_isPeriodic = false;
                     }
@@ -6117,7 +6152,7 @@ void Aura::PeriodicDummyTick()
                             (*i)->GetModifier()->m_amount = m_modifier.m_amount;
                             break;
                     }
-                    ((Player*)m_target)->UpdateManaRegen();
+                    m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
                     return;*/
                 }
             }
@@ -6152,7 +6187,7 @@ void Aura::PeriodicDummyTick()
             if      (regen_pct > 1.0f) regen_pct = 1.0f;
             else if (regen_pct < 0.2f) regen_pct = 0.2f;
             m_modifier.m_amount = int32 (base_regen * regen_pct);
-            ((Player*)m_target)->UpdateManaRegen();
+            m_target->MarkStatsForUpdate(STAT_UPDATE_MANA_REGEN);
             return;
         }
 //        // Steal Weapon
@@ -227,7 +227,7 @@ class MANGOS_DLL_SPEC Aura
         int32 GetAuraMaxDuration() const { return m_maxduration; }
         void SetAuraMaxDuration(int32 duration) { m_maxduration = duration; }
         int32 GetAuraDuration() const { return m_duration; }
-        void SetAuraDuration(int32 duration) { m_duration = duration; }
+        void SetAuraDuration(int32 duration);
         time_t GetAuraApplyTime() { return m_applyTime; }
         void UpdateAuraDuration();
         void SendAuraDurationForCaster(Player* caster);
@@ -269,6 +269,7 @@ class MANGOS_DLL_SPEC Aura
         bool IsDeathPersistent() const { return m_isDeathPersist; }
         bool IsRemovedOnShapeLost() const { return m_isRemovedOnShapeLost; }
         bool IsInUse() const { return m_in_use;}
+        bool IsUpdateIdle() const;                          // Update(diff) call will not change anything
 
         virtual void Update(uint32 diff);
         void ApplyModifier(bool apply, bool Real = false);
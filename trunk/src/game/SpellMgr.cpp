@@ -25,7 +25,7 @@
 #include "Chat.h"
 #include "Spell.h"
 
-SpellMgr::SpellMgr()
+SpellMgr::SpellMgr() : mSpellProcEventGeneration(0)
 {
 }
 
@@ -39,6 +39,10 @@ SpellMgr& SpellMgr::Instance()
     return spellMgr;
 }
 
+static SpellSpecific CalculateSpellSpecific(uint32 spellId);
+static bool CalculatePositiveEffect(uint32 spellId, uint32 effIndex);
+static bool CalculateSingleTargetSpell(SpellEntry const *spellInfo);
+
 int32 GetSpellDuration(SpellEntry const *spellInfo)
 {
     if(!spellInfo)
@@ -91,6 +95,9 @@ uint32 GetSpellCastTime(SpellEntry const* spellInfo, Spell const* spell)
 
 bool IsPassiveSpell(uint32 spellId)
 {
+    if(SpellClassification const* sc = spellmgr.GetSpellClassification(spellId))
+        return (sc->flags & SPELL_CLASS_PASSIVE) != 0;
+
     SpellEntry const *spellInfo = sSpellStore.LookupEntry(spellId);
     if (!spellInfo)
         return false;
@@ -126,6 +133,14 @@ int32 CompareAuraRanks(uint32 spellId_1, uint32 effIndex_1, uint32 spellId_2, ui
 }
 
 SpellSpecific GetSpellSpecific(uint32 spellId)
+{
+    if(SpellClassification const* sc = spellmgr.GetSpellClassification(spellId))
+        return SpellSpecific(sc->specific);
+
+    return CalculateSpellSpecific(spellId);
+}
+
+static SpellSpecific CalculateSpellSpecific(uint32 spellId)
 {
     SpellEntry const *spellInfo = sSpellStore.LookupEntry(spellId);
     if(!spellInfo)
@@ -285,6 +300,14 @@ bool IsPositiveTarget(uint32 targetA, uint32 targetB)
 }
 
 bool IsPositiveEffect(uint32 spellId, uint32 effIndex)
+{
+    if(SpellClassification const* sc = spellmgr.GetSpellClassification(spellId))
+        return (sc->flags & (SPELL_CLASS_POSITIVE_EFFECT_0 << effIndex)) != 0;
+
+    return CalculatePositiveEffect(spellId, effIndex);
+}
+
+static bool CalculatePositiveEffect(uint32 spellId, uint32 effIndex)
 {
     SpellEntry const *spellproto = sSpellStore.LookupEntry(spellId);
     if (!spellproto) return false;
@@ -475,6 +498,9 @@ bool IsPositiveEffect(uint32 spellId, uint32 effIndex)
 
 bool IsPositiveSpell(uint32 spellId)
 {
+    if(SpellClassification const* sc = spellmgr.GetSpellClassification(spellId))
+        return (sc->flags & SPELL_CLASS_POSITIVE_MASK) == SPELL_CLASS_POSITIVE_MASK;
+
     SpellEntry const *spellproto = sSpellStore.LookupEntry(spellId);
     if (!spellproto) return false;
 
@@ -487,6 +513,14 @@ bool IsPositiveSpell(uint32 spellId)
 }
 
 bool IsSingleTargetSpell(SpellEntry const *spellInfo)
+{
+    if(SpellClassification const* sc = spellmgr.GetSpellClassification(spellInfo->Id))
+        return (sc->flags & SPELL_CLASS_SINGLE_TARGET) != 0;
+
+    return CalculateSingleTargetSpell(spellInfo);
+}
+
+static bool CalculateSingleTargetSpell(SpellEntry const *spellInfo)
 {
     // all other single target spells have if it has AttributesEx5
     if ( spellInfo->AttributesEx5 & SPELL_ATTR_EX5_SINGLE_TARGET_SPELL )
@@ -806,6 +840,7 @@ bool SpellMgr::IsAffectedBySpell(SpellEntry const *spellInfo, uint32 spellId, ui
 void SpellMgr::LoadSpellProcEvents()
 {
     mSpellProcEventMap.clear();                             // need for reload case
+    ++mSpellProcEventGeneration;                            // units rebuild own proc aura data
 
     uint32 count = 0;
 
@@ -979,6 +1014,115 @@ void SpellMgr::LoadSpellElixirs()
     sLog.outString( ">> Loaded %u spell elixir definitions", count );
 }
 
+void SpellMgr::LoadSpellClassifications()
+{
+    // lookups fall back to direct calculation while the table is empty
+    mSpellClassifications.clear();                          // need for reload case
+
+    SpellClassificationVector classifications(sSpellStore.GetNumRows());
+    uint32 count = 0;
+
+    barGoLink bar( sSpellStore.GetNumRows() );
+
+    for(uint32 id = 0; id < sSpellStore.GetNumRows(); ++id)
+    {
+        bar.step();
+
+        SpellClassification& sc = classifications[id];
+        sc.flags = 0;
+        sc.specific = SPELL_NORMAL;
+
+        SpellEntry const* spellInfo = sSpellStore.LookupEntry(id);
+        if(!spellInfo)
+            continue;
+
+        sc.flags |= SPELL_CLASS_VALID;
+        sc.specific = CalculateSpellSpecific(id);
+
+        if(spellInfo->Attributes & SPELL_ATTR_PASSIVE)
+            sc.flags |= SPELL_CLASS_PASSIVE;
+
+        if(CalculateSingleTargetSpell(spellInfo))
+            sc.flags |= SPELL_CLASS_SINGLE_TARGET;
+
+        for(uint32 i = 0; i < 3; ++i)
+            if(CalculatePositiveEffect(id, i))
+                sc.flags |= (SPELL_CLASS_POSITIVE_EFFECT_0 << i);
+
+        ++count;
+    }
+
+    mSpellClassifications.swap(classifications);
+
+    sLog.outString();
+    sLog.outString( ">> Loaded %u spell classifications", count );
+
+#ifdef MANGOS_DEBUG
+    CheckSpellClassifications();
+#endif
+}
+
+// compare precalculated data with direct calculation, for debug builds and tests after spell code changes
+void SpellMgr::CheckSpellClassifications() const
+{
+    uint32 mismatches = 0;
+
+    for(uint32 id = 0; id < sSpellStore.GetNumRows(); ++id)
+    {
+        SpellEntry const* spellInfo = sSpellStore.LookupEntry(id);
+        if(!spellInfo)
+            continue;
+
+        SpellClassification const* sc = GetSpellClassification(id);
+        if(!sc)
+        {
+            sLog.outError("Spell %u has no precalculated classification", id);
+            ++mismatches;
+            continue;
+        }
+
+        bool positive = true;
+        for(uint32 i = 0; i < 3; ++i)
+        {
+            bool effPositive = CalculatePositiveEffect(id, i);
+            if(effPositive != IsPositiveEffect(id, i))
+            {
+                sLog.outError("Spell %u effect %u: precalculated positive %u, calculated %u", id, i, !effPositive, effPositive);
+                ++mismatches;
+            }
+            positive = positive && effPositive;
+        }
+
+        if(positive != IsPositiveSpell(id))
+        {
+            sLog.outError("Spell %u: precalculated positive %u, calculated %u", id, !positive, positive);
+            ++mismatches;
+        }
+
+        SpellSpecific specific = CalculateSpellSpecific(id);
+        if(specific != GetSpellSpecific(id))
+        {
+            sLog.outError("Spell %u: precalculated specific %u, calculated %u", id, uint32(GetSpellSpecific(id)), uint32(specific));
+            ++mismatches;
+        }
+
+        bool single = CalculateSingleTargetSpell(spellInfo);
+        if(single != IsSingleTargetSpell(spellInfo))
+        {
+            sLog.outError("Spell %u: precalculated single target %u, calculated %u", id, !single, single);
+            ++mismatches;
+        }
+
+        if(((spellInfo->Attributes & SPELL_ATTR_PASSIVE) != 0) != IsPassiveSpell(id))
+        {
+            sLog.outError("Spell %u: precalculated passive flag mismatch", id);
+            ++mismatches;
+        }
+    }
+
+    sLog.outString( ">> Checked spell classifications: %u mismatches", mismatches );
+}
+
 void SpellMgr::LoadSpellThreats()
 {
     sSpellThreatStore.Free();                               // for reload
@@ -989,6 +1133,114 @@ void SpellMgr::LoadSpellThreats()
     sLog.outString();
 }
 
+void SpellMgr::CalculateSpellCastPlan(SpellEntry const* spellInfo, SpellCastPlan& plan)
+{
+    SpellRangeEntry const* srange = sSpellRangeStore.LookupEntry(spellInfo->rangeIndex);
+    plan.minRange = GetSpellMinRange(srange);
+    plan.maxRange = GetSpellMaxRange(srange);
+    plan.channeled = IsChanneledSpell(spellInfo);
+    plan.valid = true;
+
+    for(uint32 i = 0; i < 3; ++i)
+    {
+        SpellEffectPlan& effectPlan = plan.effects[i];
+        effectPlan.flags = 0;
+        effectPlan.targetModeCount = 0;
+        effectPlan.targetModes[0] = 0;
+        effectPlan.targetModes[1] = 0;
+
+        if(spellInfo->EffectRadiusIndex[i])
+            effectPlan.radius = GetSpellRadius(sSpellRadiusStore.LookupEntry(spellInfo->EffectRadiusIndex[i]));
+        else
+            effectPlan.radius = plan.maxRange;
+
+        uint32 effect = spellInfo->Effect[i];
+        uint32 targetA = spellInfo->EffectImplicitTargetA[i];
+        uint32 targetB = spellInfo->EffectImplicitTargetB[i];
+
+        // not call for empty effect.
+        // Also some spells use not used effect targets for store targets for dummy effect in triggered spells
+        if(effect == 0)
+            continue;
+
+        // targets for TARGET_SCRIPT_COORDINATES (A) and TARGET_SCRIPT  filled in Spell::canCast call
+        if( targetA == TARGET_SCRIPT_COORDINATES || targetA == TARGET_SCRIPT ||
+            targetB == TARGET_SCRIPT && targetA != TARGET_SELF )
+            continue;
+
+        effectPlan.flags |= SPELL_EFFECT_PLAN_FILL_TARGETS;
+
+        // for area auras always add caster as target (needed for totems for example)
+        if(IsAreaAuraEffect(effect))
+            effectPlan.flags |= SPELL_EFFECT_PLAN_ADD_CASTER;
+
+        // TargetA/TargetB dependent from each other, we not switch to full support this dependences
+        // but need it support in some know cases
+        switch(targetA)
+        {
+            case TARGET_ALL_AROUND_CASTER:
+                if( targetB == TARGET_ALL_PARTY || targetB == TARGET_ALL_FRIENDLY_UNITS_AROUND_CASTER ||
+                    targetB == TARGET_RANDOM_RAID_MEMBER )
+                {
+                    effectPlan.targetModes[effectPlan.targetModeCount++] = targetB;
+                }
+                // environment damage spells have around enemies targeting but GO casting not implemented,
+                // so each enemy selected explicitly and self cast damage
+                else if(targetB == TARGET_ALL_ENEMY_IN_AREA && effect == SPELL_EFFECT_ENVIRONMENTAL_DAMAGE)
+                    effectPlan.flags |= SPELL_EFFECT_PLAN_EXPLICIT_TARGET;
+                else
+                {
+                    effectPlan.targetModes[effectPlan.targetModeCount++] = targetA;
+                    effectPlan.targetModes[effectPlan.targetModeCount++] = targetB;
+                }
+                break;
+            case TARGET_TABLE_X_Y_Z_COORDINATES:
+                // Only if target A, for target B (used in teleports) dest select in effect
+                effectPlan.targetModes[effectPlan.targetModeCount++] = targetA;
+                break;
+            default:
+                effectPlan.targetModes[effectPlan.targetModeCount++] = targetA;
+                // B case filled in canCast but we need fill unit list base at A case
+                if(targetB != TARGET_SCRIPT_COORDINATES)
+                    effectPlan.targetModes[effectPlan.targetModeCount++] = targetB;
+                break;
+        }
+
+        if( (targetA == 0 || targetA == TARGET_EFFECT_SELECT) && (targetB == 0 || targetB == TARGET_EFFECT_SELECT) )
+            effectPlan.flags |= SPELL_EFFECT_PLAN_DEFAULT_TARGET;
+    }
+}
+
+void SpellMgr::LoadSpellCastPlans()
+{
+    mSpellCastPlans.clear();
+
+    SpellCastPlanVector plans(sSpellStore.GetNumRows());
+    uint32 count = 0;
+
+    barGoLink bar( sSpellStore.GetNumRows() );
+
+    for(uint32 id = 0; id < sSpellStore.GetNumRows(); ++id)
+    {
+        bar.step();
+
+        SpellCastPlan& plan = plans[id];
+        plan.valid = false;
+
+        SpellEntry const* spellInfo = sSpellStore.LookupEntry(id);
+        if(!spellInfo)
+            continue;
+
+        CalculateSpellCastPlan(spellInfo, plan);
+        ++count;
+    }
+
+    mSpellCastPlans.swap(plans);
+
+    sLog.outString();
+    sLog.outString( ">> Loaded %u spell cast plans", count );
+}
+
 bool SpellMgr::IsRankSpellDueToSpell(SpellEntry const *spellInfo_1,uint32 spellId_2) const
 {
     SpellEntry const *spellInfo_2 = sSpellStore.LookupEntry(spellId_2);
@@ -498,6 +498,56 @@ typedef HM_NAMESPACE::hash_map<uint32, SpellProcEventEntry> SpellProcEventMap;
 
 typedef std::map<uint32, uint8> SpellElixirMap;
 
+// Precalculated results of the spell classification functions (IsPositiveSpell, GetSpellSpecific, ...)
+enum SpellClassificationFlags
+{
+    SPELL_CLASS_VALID               = 0x01,                 // record filled (spell exist)
+    SPELL_CLASS_PASSIVE             = 0x02,
+    SPELL_CLASS_SINGLE_TARGET       = 0x04,
+    SPELL_CLASS_POSITIVE_EFFECT_0   = 0x08,                 // SPELL_CLASS_POSITIVE_EFFECT_0 << effIndex
+    SPELL_CLASS_POSITIVE_EFFECT_1   = 0x10,
+    SPELL_CLASS_POSITIVE_EFFECT_2   = 0x20,
+};
+
+#define SPELL_CLASS_POSITIVE_MASK (SPELL_CLASS_POSITIVE_EFFECT_0|SPELL_CLASS_POSITIVE_EFFECT_1|SPELL_CLASS_POSITIVE_EFFECT_2)
+
+struct SpellClassification
+{
+    uint8 flags;                                            // SpellClassificationFlags
+    uint8 specific;                                         // SpellSpecific
+};
+
+typedef std::vector<SpellClassification> SpellClassificationVector;
+
+// How Spell::FillTargetMap collect unit targets of one effect, precalculated from effect and target modes
+enum SpellEffectPlanFlags
+{
+    SPELL_EFFECT_PLAN_FILL_TARGETS      = 0x01,             // targets filled in FillTargetMap (not empty effect, not script targets)
+    SPELL_EFFECT_PLAN_ADD_CASTER        = 0x02,             // area aura effect, caster always added
+    SPELL_EFFECT_PLAN_EXPLICIT_TARGET   = 0x04,             // only explicit unit target used instead target modes
+    SPELL_EFFECT_PLAN_DEFAULT_TARGET    = 0x08,             // no target modes, default target selected by effect type
+};
+
+struct SpellEffectPlan
+{
+    float radius;                                           // radius or spell max range if no radius, before spell mods
+    uint8 flags;                                            // SpellEffectPlanFlags
+    uint8 targetModeCount;
+    uint8 targetModes[2];                                   // target modes for Spell::SetTargetMap calls in call order
+};
+
+// Spell constant part of cast processing, resolved from DBC once at load
+struct SpellCastPlan
+{
+    SpellEffectPlan effects[3];
+    float minRange;
+    float maxRange;
+    bool valid;                                             // plan filled (spell exist)
+    bool channeled;
+};
+
+typedef std::vector<SpellCastPlan> SpellCastPlanVector;
+
 // Spell script target related declarations (accessed using SpellMgr functions)
 enum SpellTargetType
 {
@@ -661,6 +711,28 @@ class SpellMgr
             return itr->second;
         }
 
+        // NULL for not existed spells and while table (re)building
+        SpellClassification const* GetSpellClassification(uint32 spellId) const
+        {
+            if(spellId >= mSpellClassifications.size())
+                return NULL;
+
+            SpellClassification const& sc = mSpellClassifications[spellId];
+            return (sc.flags & SPELL_CLASS_VALID) ? &sc : NULL;
+        }
+
+        // NULL for not existed spells and before table build
+        SpellCastPlan const* GetSpellCastPlan(uint32 spellId) const
+        {
+            if(spellId >= mSpellCastPlans.size())
+                return NULL;
+
+            SpellCastPlan const& plan = mSpellCastPlans[spellId];
+            return plan.valid ? &plan : NULL;
+        }
+
+        static void CalculateSpellCastPlan(SpellEntry const* spellInfo, SpellCastPlan& plan);
+
         SpellSpecific GetSpellElixirSpecific(uint32 spellid) const
         {
             uint32 mask = GetSpellElixirMask(spellid);
@@ -675,6 +747,9 @@ class SpellMgr
         }
 
         // Spell proc events
+        // changed at each spell_proc_event (re)load, pointers to old entries are invalid then
+        uint32 GetSpellProcEventGeneration() const { return mSpellProcEventGeneration; }
+
         SpellProcEventEntry const* GetSpellProcEvent(uint32 spellId) const
         {
             SpellProcEventMap::const_iterator itr = mSpellProcEventMap.find(spellId);
@@ -844,6 +919,9 @@ class SpellMgr
         void LoadSpellThreats();
         void LoadSkillLineAbilityMap();
         void LoadSpellPetAuras();
+        void LoadSpellClassifications();                    // must be after LoadSpellElixirs
+        void CheckSpellClassifications() const;
+        void LoadSpellCastPlans();
 
     private:
         SpellScriptTarget  mSpellScriptTarget;
@@ -855,8 +933,11 @@ class SpellMgr
         SpellAffectMap     mSpellAffectMap;
         SpellElixirMap     mSpellElixirs;
         SpellProcEventMap  mSpellProcEventMap;
+        uint32             mSpellProcEventGeneration;
         SkillLineAbilityMap mSkillLineAbilityMap;
         SpellPetAuraMap     mSpellPetAuraMap;
+        SpellClassificationVector mSpellClassifications;
+        SpellCastPlanVector mSpellCastPlans;
 };
 
 #define spellmgr SpellMgr::Instance()
@@ -46,28 +46,27 @@ bool Player::UpdateStats(Stats stat)
             pet->UpdateStats(stat);
     }
 
+    // dependent values recalculated after all changed stats
+    uint32 statUpdateFlags = STAT_UPDATE_SPELL_BONUS | STAT_UPDATE_MANA_REGEN;
+
     switch(stat)
     {
         case STAT_STRENGTH:
-            UpdateAttackPowerAndDamage();
-            UpdateShieldBlockValue();
+            statUpdateFlags |= STAT_UPDATE_MOD(UNIT_MOD_ATTACK_POWER) | STAT_UPDATE_SHIELD_BLOCK;
             break;
         case STAT_AGILITY:
-            UpdateArmor();
-            UpdateAttackPowerAndDamage(true);
+            statUpdateFlags |= STAT_UPDATE_MOD(UNIT_MOD_ARMOR) | STAT_UPDATE_MOD(UNIT_MOD_ATTACK_POWER_RANGED);
             if(getClass() == CLASS_ROGUE || getClass() == CLASS_HUNTER || getClass() == CLASS_DRUID && m_form==FORM_CAT)
-                UpdateAttackPowerAndDamage();
+                statUpdateFlags |= STAT_UPDATE_MOD(UNIT_MOD_ATTACK_POWER);
 
-            UpdateAllCritPercentages();
-            UpdateDodgePercentage();
+            statUpdateFlags |= STAT_UPDATE_CRIT | STAT_UPDATE_DODGE;
             break;
 
-        case STAT_STAMINA:   UpdateMaxHealth(); break;
+        case STAT_STAMINA:   statUpdateFlags |= STAT_UPDATE_MOD(UNIT_MOD_HEALTH); break;
         case STAT_INTELLECT:
-            UpdateMaxPower(POWER_MANA);
-            UpdateAllSpellCritChances();
-            UpdateAttackPowerAndDamage(true);               //SPELL_AURA_MOD_RANGED_ATTACK_POWER_OF_STAT_PERCENT, only intelect currently
-            UpdateArmor();                                  //SPELL_AURA_MOD_RESISTANCE_OF_INTELLECT_PERCENT, only armor currently
+            statUpdateFlags |= STAT_UPDATE_MOD(UNIT_MOD_MANA) | STAT_UPDATE_SPELL_CRIT;
+            statUpdateFlags |= STAT_UPDATE_MOD(UNIT_MOD_ATTACK_POWER_RANGED);  //SPELL_AURA_MOD_RANGED_ATTACK_POWER_OF_STAT_PERCENT, only intelect currently
+            statUpdateFlags |= STAT_UPDATE_MOD(UNIT_MOD_ARMOR);                //SPELL_AURA_MOD_RESISTANCE_OF_INTELLECT_PERCENT, only armor currently
             break;
 
         case STAT_SPIRIT:
@@ -76,8 +75,7 @@ bool Player::UpdateStats(Stats stat)
         default:
             break;
     }
-    UpdateSpellDamageAndHealingBonus();
-    UpdateManaRegen();
+    MarkStatsForUpdate(statUpdateFlags);
     return true;
 }
 
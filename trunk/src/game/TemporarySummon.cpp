@@ -26,6 +26,7 @@
 TemporarySummon::TemporarySummon( uint64 summoner ) :
 Creature(), m_type(TEMPSUMMON_TIMED_OR_CORPSE_DESPAWN), m_timer(0), m_lifetime(0), m_summoner(summoner)
 {
+    m_idleSleepAllowed = false;
 }
 
 void TemporarySummon::Update( uint32 diff )
@@ -26,6 +26,8 @@
 #include "ObjectAccessor.h"
 #include "UnitEvents.h"
 
+#include <algorithm>
+
 //==============================================================
 //================= ThreatCalcHelper ===========================
 //==============================================================
@@ -55,6 +57,8 @@ HostilReference::HostilReference(Unit* pUnit, ThreatManager *pThreatManager, flo
     iUnitGuid = pUnit->GetGUID();
     iOnline = true;
     iAccessible = true;
+    iHeapIndex = -1;
+    iAddOrder = 0;
 }
 
 //============================================================
@@ -192,30 +196,135 @@ Unit* HostilReference::getSourceUnit()
 
 void ThreatContainer::clearReferences()
 {
-    for(std::list<HostilReference*>::iterator i = iThreatList.begin(); i != iThreatList.end(); i++)
+    for(std::vector<HostilReference*>::iterator i = iThreatHeap.begin(); i != iThreatHeap.end(); i++)
     {
+        (*i)->iHeapIndex = -1;
         (*i)->unlink();
         delete (*i);
     }
-    iThreatList.clear();
+    iThreatHeap.clear();
+    delete iRefsByGuid;
+    iRefsByGuid = NULL;
+    iSortedList.clear();
+    iSortedListValid = true;
+}
+
+//============================================================
+
+void ThreatContainer::siftUp(uint32 pPos)
+{
+    HostilReference* ref = iThreatHeap[pPos];
+    while(pPos > 0)
+    {
+        uint32 parent = (pPos - 1) / 2;
+        if(!isHigher(ref, iThreatHeap[parent]))
+            break;
+        setHeapPosition(pPos, iThreatHeap[parent]);
+        pPos = parent;
+    }
+    setHeapPosition(pPos, ref);
+}
+
+//============================================================
+
+void ThreatContainer::siftDown(uint32 pPos)
+{
+    HostilReference* ref = iThreatHeap[pPos];
+    uint32 size = iThreatHeap.size();
+    for(;;)
+    {
+        uint32 child = 2 * pPos + 1;
+        if(child >= size)
+            break;
+        if(child + 1 < size && isHigher(iThreatHeap[child + 1], iThreatHeap[child]))
+            ++child;
+        if(!isHigher(iThreatHeap[child], ref))
+            break;
+        setHeapPosition(pPos, iThreatHeap[child]);
+        pPos = child;
+    }
+    setHeapPosition(pPos, ref);
+}
+
+//============================================================
+
+#define THREAT_GUID_INDEX_SIZE 16
+
+void ThreatContainer::addReference(HostilReference* pHostilReference)
+{
+    if(contains(pHostilReference))
+        return;
+
+    // added reference is after all references with same threat
+    pHostilReference->iAddOrder = iAddCounter++;
+    iThreatHeap.push_back(pHostilReference);
+    siftUp(iThreatHeap.size() - 1);
+    iSortedListValid = false;
+
+    if(iRefsByGuid)
+        (*iRefsByGuid)[pHostilReference->getUnitGuid()] = pHostilReference;
+    else if(iThreatHeap.size() >= THREAT_GUID_INDEX_SIZE)
+    {
+        iRefsByGuid = new RefsByGuid;
+        for(std::vector<HostilReference*>::const_iterator i = iThreatHeap.begin(); i != iThreatHeap.end(); ++i)
+            (*iRefsByGuid)[(*i)->getUnitGuid()] = *i;
+    }
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostilReference* pRef)
+{
+    if(!contains(pRef))
+        return;
+
+    uint32 pos = pRef->iHeapIndex;
+    HostilReference* last = iThreatHeap.back();
+    iThreatHeap.pop_back();
+    pRef->iHeapIndex = -1;
+    iSortedListValid = false;
+
+    if(iRefsByGuid)
+        iRefsByGuid->erase(pRef->getUnitGuid());
+
+    // move last reference to the free position and restore the order from there
+    if(pos < iThreatHeap.size())
+    {
+        setHeapPosition(pos, last);
+        siftUp(pos);
+        siftDown(last->iHeapIndex);
+    }
+}
+
+//============================================================
+
+void ThreatContainer::update(HostilReference* pRef)
+{
+    if(!contains(pRef))
+        return;
+
+    siftUp(pRef->iHeapIndex);
+    siftDown(pRef->iHeapIndex);
+    iSortedListValid = false;
 }
 
 //============================================================
 // Return the HostilReference of NULL, if not found
 HostilReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
 {
-    HostilReference* result = NULL;
     uint64 guid = pVictim->GetGUID();
-    for(std::list<HostilReference*>::iterator i = iThreatList.begin(); i != iThreatList.end(); i++)
+
+    if(iRefsByGuid)
     {
-        if((*i)->getUnitGuid() == guid)
-        {
-            result = (*i);
-            break;
-        }
+        RefsByGuid::const_iterator itr = iRefsByGuid->find(guid);
+        return itr != iRefsByGuid->end() ? itr->second : NULL;
     }
 
-    return result;
+    for(std::vector<HostilReference*>::const_iterator i = iThreatHeap.begin(); i != iThreatHeap.end(); i++)
+        if((*i)->getUnitGuid() == guid)
+            return *i;
+
+    return NULL;
 }
 
 //============================================================
@@ -239,23 +348,28 @@ void ThreatContainer::modifyThreatPercent(Unit *pVictim, int32 pPercent)
 
 //============================================================
 
-bool HostilReferenceSortPredicate(const HostilReference* lhs, const HostilReference* rhs)
+std::list<HostilReference*>& ThreatContainer::getThreatList()
 {
-    // std::list::sort ordering predicate must be: (Pred(x,y)&&Pred(y,x))==false
-    return lhs->getThreat() > rhs->getThreat();             // reverse sorting
+    if(!iSortedListValid)
+    {
+        iSortedList.assign(iThreatHeap.begin(), iThreatHeap.end());
+        iSortedList.sort(&ThreatContainer::isHigher);
+        iSortedListValid = true;
+    }
+    return iSortedList;
 }
 
 //============================================================
-// Check if the list is dirty and sort if necessary
 
-void ThreatContainer::update()
+// std::push_heap/pop_heap ordering of heap positions, best reference at front
+struct ThreatHeapIndexOrder
 {
-    if(iDirty && iThreatList.size() >1)
-    {
-        iThreatList.sort(HostilReferenceSortPredicate);
-    }
-    iDirty = false;
-}
+    explicit ThreatHeapIndexOrder(std::vector<HostilReference*> const& pHeap) : iHeap(pHeap) {}
+
+    bool operator()(uint32 pLeft, uint32 pRight) const { return ThreatContainer::isHigher(iHeap[pRight], iHeap[pLeft]); }
+
+    std::vector<HostilReference*> const& iHeap;
+};
 
 //============================================================
 // return the next best victim
@@ -263,11 +377,20 @@ void ThreatContainer::update()
 
 HostilReference* ThreatContainer::selectNextVictim(Creature* pAttacker, HostilReference* pCurrentVictim)
 {
-    HostilReference* currentRef = NULL;
-    bool found = false;
-    for(std::list<HostilReference*>::iterator iter = iThreatList.begin(); iter != iThreatList.end() && !found; ++iter)
+    if(iThreatHeap.empty())
+        return NULL;
+
+    // references are visited in threat order: next is the best of not visited children of visited references
+    ThreatHeapIndexOrder order(iThreatHeap);
+
+    // scratch storage reused by all calls (world thread only, not reentered), keeps its capacity
+    static std::vector<uint32> candidates;
+    candidates.clear();
+
+    uint32 pos = 0;
+    for(;;)
     {
-        currentRef = (*iter);
+        HostilReference* currentRef = iThreatHeap[pos];
 
         Unit* target = currentRef->getTarget();
         assert(target);                                     // if the ref has status online the target must be there !
@@ -278,30 +401,31 @@ HostilReference* ThreatContainer::selectNextVictim(Creature* pAttacker, HostilRe
             {
                 // list sorted and and we check current target, then this is best case
                 if(pCurrentVictim == currentRef || currentRef->getThreat() <= 1.1f * pCurrentVictim->getThreat() )
-                {
-                    currentRef = pCurrentVictim;            // for second case
-                    found = true;
-                    break;
-                }
+                    return pCurrentVictim;                  // for second case
 
                 if( currentRef->getThreat() > 1.3f * pCurrentVictim->getThreat() ||
                     currentRef->getThreat() > 1.1f * pCurrentVictim->getThreat() && pAttacker->IsWithinDistInMap(target, ATTACK_DISTANCE) )
                 {                                           //implement 110% threat rule for targets in melee range
-                    found = true;                           //and 130% rule for targets in ranged distances
-                    break;                                  //for selecting alive targets
-                }
+                    return currentRef;                      //and 130% rule for targets in ranged distances
+                }                                           //for selecting alive targets
             }
             else                                            // select any
-            {
-                found = true;
-                break;
-            }
+                return currentRef;
         }
-    }
-    if(!found)
-        currentRef = NULL;
 
-    return currentRef;
+        for(uint32 child = 2 * pos + 1; child <= 2 * pos + 2 && child < iThreatHeap.size(); ++child)
+        {
+            candidates.push_back(child);
+            std::push_heap(candidates.begin(), candidates.end(), order);
+        }
+
+        if(candidates.empty())
+            return NULL;
+
+        std::pop_heap(candidates.begin(), candidates.end(), order);
+        pos = candidates.back();
+        candidates.pop_back();
+    }
 }
 
 //============================================================
@@ -367,7 +491,6 @@ void ThreatManager::modifyThreatPercent(Unit *pVictim, int32 pPercent)
 
 Unit* ThreatManager::getHostilTarget()
 {
-    iThreatContainer.update();
     HostilReference* nextVictim = iThreatContainer.selectNextVictim((Creature*) getOwner(), getCurrentVictim());
     setCurrentVictim(nextVictim);
     return getCurrentVictim() != NULL ? getCurrentVictim()->getTarget() : NULL;
@@ -433,35 +556,29 @@ bool ThreatManager::processThreatEvent(const UnitBaseEvent* pUnitBaseEvent)
     switch(pUnitBaseEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
-            if((getCurrentVictim() == hostilReference && threatRefStatusChangeEvent->getFValue()<0.0f) ||
-                (getCurrentVictim() != hostilReference && threatRefStatusChangeEvent->getFValue()>0.0f))
-                setDirty(true);                             // the order in the threat list might have changed
+            // the order in the threat list might have changed
+            if(hostilReference->isOnline())
+                iThreatContainer.update(hostilReference);
+            else
+                iThreatOfflineContainer.update(hostilReference);
             break;
         case UEV_THREAT_REF_ONLINE_STATUS:
             if(!hostilReference->isOnline())
             {
                 if (hostilReference == getCurrentVictim())
-                {
                     setCurrentVictim(NULL);
-                    setDirty(true);
-                }
                 iThreatContainer.remove(hostilReference);
                 iThreatOfflineContainer.addReference(hostilReference);
             }
             else
             {
-                if(getCurrentVictim() && hostilReference->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
-                    setDirty(true);
-                iThreatContainer.addReference(hostilReference);
                 iThreatOfflineContainer.remove(hostilReference);
+                iThreatContainer.addReference(hostilReference);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
             if (hostilReference == getCurrentVictim())
-            {
                 setCurrentVictim(NULL);
-                setDirty(true);
-            }
             if(hostilReference->isOnline())
                 iThreatContainer.remove(hostilReference);
             else
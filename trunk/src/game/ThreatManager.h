@@ -23,8 +23,10 @@
 #include "SharedDefines.h"
 #include "Utilities/LinkedReference/Reference.h"
 #include "UnitEvents.h"
+#include "Utilities/HashMap.h"
 
 #include <list>
+#include <vector>
 
 //==============================================================
 
@@ -46,12 +48,16 @@ class ThreatCalcHelper
 
 class MANGOS_DLL_SPEC HostilReference : public Reference<Unit, ThreatManager>
 {
+    friend class ThreatContainer;
+
     private:
         float iThreat;
         float iTempThreatModifyer;                          // used for taunt
         uint64 iUnitGuid;
         bool iOnline;
         bool iAccessible;
+        int32 iHeapIndex;                                   // position in threat heap of the container, -1 if not in container
+        uint32 iAddOrder;                                   // references with same threat ordered by add to container
     private:
         // Inform the source, that the status of that reference was changed
         void fireStatusChanged(const ThreatRefStatusChangeEvent& pThreatRefStatusChangeEvent);
@@ -128,21 +134,42 @@ class MANGOS_DLL_SPEC HostilReference : public Reference<Unit, ThreatManager>
 //==============================================================
 class ThreatManager;
 
+/**
+ * Threat references of one creature, kept in binary max heap ordered by threat.
+ *
+ * Every reference know own heap position, so after threat change only its position is restored
+ * (O(log n)) and the most hated is always on top. selectNextVictim visit references in threat
+ * order through the heap and so look only at the references above the selected one. References
+ * of big lists are also indexed by target guid.
+ */
 class MANGOS_DLL_SPEC ThreatContainer
 {
     private:
-        std::list<HostilReference*> iThreatList;
-        bool iDirty;
+        typedef HM_NAMESPACE::hash_map<uint64, HostilReference*> RefsByGuid;
+
+        std::vector<HostilReference*> iThreatHeap;
+        RefsByGuid* iRefsByGuid;                            // created when list grow to THREAT_GUID_INDEX_SIZE
+        std::list<HostilReference*> iSortedList;            // sorted copy for getThreatList
+        bool iSortedListValid;
+        uint32 iAddCounter;
+
+        bool contains(HostilReference const* pRef) const
+        {
+            return pRef->iHeapIndex >= 0 && uint32(pRef->iHeapIndex) < iThreatHeap.size() && iThreatHeap[pRef->iHeapIndex] == pRef;
+        }
+        void setHeapPosition(uint32 pPos, HostilReference* pRef) { iThreatHeap[pPos] = pRef; pRef->iHeapIndex = pPos; }
+        void siftUp(uint32 pPos);
+        void siftDown(uint32 pPos);
     protected:
         friend class ThreatManager;
 
-        void remove(HostilReference* pRef) { iThreatList.remove(pRef); }
-        void addReference(HostilReference* pHostilReference) { iThreatList.push_back(pHostilReference); }
+        void remove(HostilReference* pRef);
+        void addReference(HostilReference* pHostilReference);
         void clearReferences();
-        // Sort the list if necessary
-        void update();
+        // Restore the order after threat change of the reference
+        void update(HostilReference* pRef);
     public:
-        ThreatContainer() { iDirty = false; }
+        ThreatContainer() : iRefsByGuid(NULL), iSortedListValid(true), iAddCounter(0) {}
         ~ThreatContainer() { clearReferences(); }
 
         HostilReference* addThreat(Unit* pVictim, float pThreat);
@@ -151,17 +178,21 @@ class MANGOS_DLL_SPEC ThreatContainer
 
         HostilReference* selectNextVictim(Creature* pAttacker, HostilReference* pCurrentVictim);
 
-        void setDirty(bool pDirty) { iDirty = pDirty; }
+        bool empty() { return(iThreatHeap.empty()); }
 
-        bool isDirty() { return iDirty; }
-
-        bool empty() { return(iThreatList.empty()); }
-
-        HostilReference* getMostHated() { return iThreatList.empty() ? NULL : iThreatList.front(); }
+        HostilReference* getMostHated() { return iThreatHeap.empty() ? NULL : iThreatHeap.front(); }
 
         HostilReference* getReferenceByTarget(Unit* pVictim);
 
-        std::list<HostilReference*>& getThreatList() { return iThreatList; }
+        // references sorted by threat, changes of the returned list not affect the container
+        std::list<HostilReference*>& getThreatList();
+
+        static bool isHigher(HostilReference const* pLeft, HostilReference const* pRight)
+        {
+            if(pLeft->iThreat != pRight->iThreat)
+                return pLeft->iThreat > pRight->iThreat;
+            return int32(pLeft->iAddOrder - pRight->iAddOrder) < 0;
+        }
 };
 
 //=================================================
@@ -200,9 +231,7 @@ class MANGOS_DLL_SPEC ThreatManager
 
         void setCurrentVictim(HostilReference* pHostilReference);
 
-        void setDirty(bool pDirty) { iThreatContainer.setDirty(pDirty); }
-
-        // methods to access the lists from the outside to do sume dirty manipulation (scriping and such)
+        // methods to access the lists from the outside (scriping and such), the lists are sorted copies
         // I hope they are used as little as possible.
         inline std::list<HostilReference*>& getThreatList() { return iThreatContainer.getThreatList(); }
         inline std::list<HostilReference*>& getOfflieThreatList() { return iThreatOfflineContainer.getThreatList(); }
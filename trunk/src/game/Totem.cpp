@@ -28,6 +28,7 @@
 Totem::Totem() : Creature()
 {
     m_isTotem = true;
+    m_idleSleepAllowed = false;
     m_duration = 0;
     m_type = TOTEM_PASSIVE;
 }
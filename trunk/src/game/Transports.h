@@ -70,6 +70,8 @@ class Transport : private GameObject
         using GameObject::GetPositionZ;
         using GameObject::BuildCreateUpdateBlockForPlayer;
         using GameObject::BuildOutOfRangeUpdateBlock;
+        using GameObject::operator new;
+        using GameObject::operator delete;
 
         bool Create(uint32 guidlow, uint32 mapid, float x, float y, float z, float ang, uint32 animprogress, uint32 dynflags);
         bool GenerateWaypoints(uint32 pathid, std::set<uint32> &mapids);
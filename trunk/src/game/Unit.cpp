@@ -58,6 +58,9 @@ float baseMoveSpeed[MAX_MOVE_TYPE] =
     4.5f,                                                   // MOVE_FLYBACK
 };
 
+uint64 Unit::s_statUpdateRequests = 0;
+uint64 Unit::s_statUpdates = 0;
+
 // auraTypes contains attacker auras capable of proc'ing cast auras
 static Unit::AuraTypeSet GenerateAttakerProcCastAuraTypes()
 {
@@ -182,6 +185,10 @@ Unit::Unit()
     m_transform = 0;
     m_ShapeShiftFormSpellId = 0;
     m_canModifyStats = false;
+    m_statUpdateFlags = 0;
+    m_statUpdateDeferCount = 0;
+    m_updatingMarkedStats = false;
+    m_sleeping = false;
 
     for (int i = 0; i < MAX_SPELL_IMMUNITY; i++)
         m_spellImmune[i].clear();
@@ -220,6 +227,8 @@ Unit::Unit()
         m_speed_rate[i] = 1.0f;
 
     m_removedAuras = 0;
+    m_procAuraFlags = 0;
+    m_procAuraGeneration = spellmgr.GetSpellProcEventGeneration();
     m_charmInfo = NULL;
     m_unit_movement_flags = 0;
 
@@ -256,8 +265,11 @@ void Unit::Update( uint32 p_time )
     // WARNING! Order of execution here is important, do not change.
     // Spells must be processed with event system BEFORE they go to _UpdateSpells.
     // Or else we may have some SPELL_STATE_FINISHED spells stalled in pointers, that is bad.
+    // stats changed by spells and expired auras are recalculated once per update
+    DeferStatUpdates();
     m_Events.Update( p_time );
     _UpdateSpells( p_time );
+    ApplyDeferredStatUpdates();
 
     // update combat timer only for players and pets
     if (isInCombat() && (GetTypeId() == TYPEID_PLAYER || ((Creature*)this)->isPet() || ((Creature*)this)->isCharmed()))
@@ -413,26 +425,14 @@ bool Unit::canReachWithAttack(Unit *pVictim) const
 void Unit::RemoveSpellsCausingAura(AuraType auraType)
 {
     if (auraType >= TOTAL_AURAS) return;
-    AuraList::iterator iter, next;
-    for (iter = m_modAuras[auraType].begin(); iter != m_modAuras[auraType].end(); iter = next)
-    {
-        next = iter;
-        ++next;
-
-        if (*iter)
-        {
-            RemoveAurasDueToSpell((*iter)->GetId());
-            if (!m_modAuras[auraType].empty())
-                next = m_modAuras[auraType].begin();
-            else
-                return;
-        }
-    }
+    // removing spell can remove other auras of this type too, so take head again each time
+    for(AuraList auras = GetAurasByType(auraType); !auras.empty(); auras = GetAurasByType(auraType))
+        RemoveAurasDueToSpell(auras.front()->GetId());
 }
 
 bool Unit::HasAuraType(AuraType auraType) const
 {
-    return (!m_modAuras[auraType].empty());
+    return !m_Auras.GetByType(auraType).empty();
 }
 
 /* Called by DealDamage for auras that have a chance to be dispelled on damage taken. */
@@ -1607,6 +1607,7 @@ void Unit::CalcAbsorbResist(Unit *pVictim,SpellSchoolMask schoolMask, DamageEffe
         {
             currentAbsorb = RemainingDamage;
             (*i)->GetModifier()->m_amount -= RemainingDamage;
+            pVictim->InvalidateAuraModifierCache(SPELL_AURA_SCHOOL_ABSORB);
         }
 
         RemainingDamage -= currentAbsorb;
@@ -1640,6 +1641,7 @@ void Unit::CalcAbsorbResist(Unit *pVictim,SpellSchoolMask schoolMask, DamageEffe
             currentAbsorb = maxAbsorb;
 
         (*i)->GetModifier()->m_amount -= currentAbsorb;
+        pVictim->InvalidateAuraModifierCache(SPELL_AURA_MANA_SHIELD);
         if((*i)->GetModifier()->m_amount <= 0)
         {
             pVictim->RemoveAurasDueToSpell((*i)->GetId());
@@ -2512,6 +2514,8 @@ MeleeHitOutcome Unit::RollMeleeOutcomeAgainst (const Unit *pVictim, WeaponAttack
 
 uint32 Unit::CalculateDamage (WeaponAttackType attType, bool normalized)
 {
+    ApplyPendingStatUpdates();
+
     float min_damage, max_damage;
 
     if (normalized && GetTypeId()==TYPEID_PLAYER)
@@ -2966,6 +2970,8 @@ uint32 Unit::GetDefenseSkillValue(Unit const* target) const
 
 float Unit::GetUnitDodgeChance() const
 {
+    ApplyPendingStatUpdates();
+
     if(hasUnitState(UNIT_STAT_STUNNED))
         return 0.0f;
     if( GetTypeId() == TYPEID_PLAYER )
@@ -2985,6 +2991,8 @@ float Unit::GetUnitDodgeChance() const
 
 float Unit::GetUnitParryChance() const
 {
+    ApplyPendingStatUpdates();
+
     if ( IsNonMeleeSpellCasted(false) || hasUnitState(UNIT_STAT_STUNNED))
         return 0.0f;
 
@@ -3017,6 +3025,8 @@ float Unit::GetUnitParryChance() const
 
 float Unit::GetUnitBlockChance() const
 {
+    ApplyPendingStatUpdates();
+
     if ( IsNonMeleeSpellCasted(false) || hasUnitState(UNIT_STAT_STUNNED))
         return 0.0f;
 
@@ -3047,6 +3057,8 @@ float Unit::GetUnitBlockChance() const
 
 float Unit::GetUnitCriticalChance(WeaponAttackType attackType, const Unit *pVictim) const
 {
+    ApplyPendingStatUpdates();
+
     float crit;
 
     if(GetTypeId() == TYPEID_PLAYER)
@@ -3146,52 +3158,30 @@ void Unit::_UpdateSpells( uint32 time )
         }
     }
 
-    // TODO: Find a better way to prevent crash when multiple auras are removed.
-    m_removedAuras = 0;
     for (AuraMap::iterator i = m_Auras.begin(); i != m_Auras.end(); ++i)
-        if ((*i).second)
-            (*i).second->SetUpdated(false);
+        (*i).second->SetUpdated(false);
 
-    for (AuraMap::iterator i = m_Auras.begin(), next; i != m_Auras.end(); i = next)
+    // aura slots stay in place at remove, auras removed by other aura update are just skipped
+    for (AuraMap::iterator i = m_Auras.begin(); i != m_Auras.end(); ++i)
     {
-        next = i;
-        ++next;
-        if ((*i).second)
-        {
-            // prevent double update
-            if ((*i).second->IsUpdated())
-                continue;
-            (*i).second->SetUpdated(true);
-            (*i).second->Update( time );
-            // several auras can be deleted due to update
-            if (m_removedAuras)
-            {
-                if (m_Auras.empty()) break;
-                next = m_Auras.begin();
-                m_removedAuras = 0;
-            }
-        }
+        // prevent double update
+        if ((*i).second->IsUpdated())
+            continue;
+        (*i).second->SetUpdated(true);
+        (*i).second->Update( time );
     }
 
     for (AuraMap::iterator i = m_Auras.begin(); i != m_Auras.end();)
     {
-        if ((*i).second)
-        {
-            if ( !(*i).second->GetAuraDuration() && !((*i).second->IsPermanent() || ((*i).second->IsPassive())) )
-            {
-                RemoveAura(i);
-            }
-            else
-            {
-                ++i;
-            }
-        }
+        if ( !(*i).second->GetAuraDuration() && !((*i).second->IsPermanent() || ((*i).second->IsPassive())) )
+            RemoveAura(i);
         else
-        {
             ++i;
-        }
     }
 
+    // no aura iteration in progress here, drop free slots
+    m_Auras.Compact();
+
     if(!m_gameObj.empty())
     {
         std::list<GameObject*>::iterator ite1, dnext1;
@@ -3257,6 +3247,8 @@ void Unit::SetCurrentCastedSpell( Spell * pSpell )
     pSpell->SetDeletable(false);                            // spell will not be deleted until gone from current pointers
     if (pSpell == m_currentSpells[CSpellType]) return;      // avoid breaking self
 
+    WakeUp();
+
     // break same type spell if it is not delayed
     InterruptSpell(CSpellType,false);
 
@@ -3442,170 +3434,127 @@ void Unit::DeMorph()
     SetDisplayId(GetNativeDisplayId());
 }
 
-int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+int32 Unit::GetAuraModifierAggregate(AuraType auratype, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue) const
 {
     int32 modifier = 0;
+    if(m_auraModifierCache.Lookup(auratype, aggregate, filter, filterValue, modifier))
+        return modifier;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        modifier += (*i)->GetModifier()->m_amount;
+    {
+        Modifier* mod = (*i)->GetModifier();
+        if ((filter == AURA_FILTER_MISC_MASK && !(mod->m_miscvalue & filterValue)) ||
+            (filter == AURA_FILTER_MISC_VALUE && mod->m_miscvalue != filterValue))
+            continue;
+
+        switch(aggregate)
+        {
+            case AURA_AGGREGATE_TOTAL:
+                modifier += mod->m_amount;
+                break;
+            case AURA_AGGREGATE_MAX_POSITIVE:
+                if (mod->m_amount > modifier)
+                    modifier = mod->m_amount;
+                break;
+            case AURA_AGGREGATE_MAX_NEGATIVE:
+                if (mod->m_amount < modifier)
+                    modifier = mod->m_amount;
+                break;
+            default:
+                break;
+        }
+    }
 
+    m_auraModifierCache.Store(auratype, aggregate, filter, filterValue, modifier);
     return modifier;
 }
 
-float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+float Unit::GetAuraMultiplierAggregate(AuraType auratype, AuraAggregateFilter filter, int32 filterValue) const
 {
     float multipler = 1.0f;
+    if(m_auraModifierCache.Lookup(auratype, AURA_AGGREGATE_MULTIPLIER, filter, filterValue, multipler))
+        return multipler;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        multipler *= (100.0f + (*i)->GetModifier()->m_amount)/100.0f;
+    {
+        Modifier* mod = (*i)->GetModifier();
+        if ((filter == AURA_FILTER_MISC_MASK && !(mod->m_miscvalue & filterValue)) ||
+            (filter == AURA_FILTER_MISC_VALUE && mod->m_miscvalue != filterValue))
+            continue;
 
+        multipler *= (100.0f + mod->m_amount)/100.0f;
+    }
+
+    m_auraModifierCache.Store(auratype, AURA_AGGREGATE_MULTIPLIER, filter, filterValue, multipler);
     return multipler;
 }
 
-int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+int32 Unit::GetTotalAuraModifier(AuraType auratype) const
 {
-    int32 modifier = 0;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_TOTAL, AURA_FILTER_NONE, 0);
+}
 
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount > modifier)
-            modifier = (*i)->GetModifier()->m_amount;
+float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+{
+    return GetAuraMultiplierAggregate(auratype, AURA_FILTER_NONE, 0);
+}
 
-    return modifier;
+int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+{
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_MAX_POSITIVE, AURA_FILTER_NONE, 0);
 }
 
 int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount < modifier)
-            modifier = (*i)->GetModifier()->m_amount;
-
-    return modifier;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_MAX_NEGATIVE, AURA_FILTER_NONE, 0);
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask)
-            modifier += mod->m_amount;
-    }
-    return modifier;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_TOTAL, AURA_FILTER_MISC_MASK, int32(misc_mask));
 }
 
 float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
-    float multipler = 1.0f;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask)
-            multipler *= (100.0f + mod->m_amount)/100.0f;
-    }
-    return multipler;
+    return GetAuraMultiplierAggregate(auratype, AURA_FILTER_MISC_MASK, int32(misc_mask));
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask && mod->m_amount > modifier)
-            modifier = mod->m_amount;
-    }
-
-    return modifier;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_MAX_POSITIVE, AURA_FILTER_MISC_MASK, int32(misc_mask));
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask && mod->m_amount < modifier)
-            modifier = mod->m_amount;
-    }
-
-    return modifier;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_MAX_NEGATIVE, AURA_FILTER_MISC_MASK, int32(misc_mask));
 }
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value)
-            modifier += mod->m_amount;
-    }
-    return modifier;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_TOTAL, AURA_FILTER_MISC_VALUE, misc_value);
 }
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    float multipler = 1.0f;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value)
-            multipler *= (100.0f + mod->m_amount)/100.0f;
-    }
-    return multipler;
+    return GetAuraMultiplierAggregate(auratype, AURA_FILTER_MISC_VALUE, misc_value);
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value && mod->m_amount > modifier)
-            modifier = mod->m_amount;
-    }
-
-    return modifier;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_MAX_POSITIVE, AURA_FILTER_MISC_VALUE, misc_value);
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value && mod->m_amount < modifier)
-            modifier = mod->m_amount;
-    }
-
-    return modifier;
+    return GetAuraModifierAggregate(auratype, AURA_AGGREGATE_MAX_NEGATIVE, AURA_FILTER_MISC_VALUE, misc_value);
 }
 
 bool Unit::AddAura(Aura *Aur)
 {
+    WakeUp();
+
     // ghost spell check, allow apply any auras at player loading in ghost mode (will be cleanup after load)
     if( !isAlive() && Aur->GetId() != 20584 && Aur->GetId() != 8326 && Aur->GetId() != 2584 &&
         (GetTypeId()!=TYPEID_PLAYER || !((Player*)this)->GetSession()->PlayerLoading()) )
@@ -3702,8 +3651,8 @@ bool Unit::AddAura(Aura *Aur)
                 break;
 
             bool restart = false;
-            AuraList& scAuras = caster->GetSingleCastAuras();
-            for(AuraList::iterator itr = scAuras.begin(); itr != scAuras.end(); ++itr)
+            SingleCastAuraList& scAuras = caster->GetSingleCastAuras();
+            for(SingleCastAuraList::iterator itr = scAuras.begin(); itr != scAuras.end(); ++itr)
             {
                 if( (*itr)->GetTarget() != Aur->GetTarget() &&
                     IsSingleTargetSpells((*itr)->GetSpellProto(),aurSpellInfo) )
@@ -3730,11 +3679,9 @@ bool Unit::AddAura(Aura *Aur)
 
     // add aura, register in lists and arrays
     Aur->_AddAura();
-    m_Auras.insert(AuraMap::value_type(spellEffectPair(Aur->GetId(), Aur->GetEffIndex()), Aur));
-    if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
-    {
-        m_modAuras[Aur->GetModifier()->m_auraname].push_back(Aur);
-    }
+    m_Auras.insert(AuraMap::value_type(spellEffectPair(Aur->GetId(), Aur->GetEffIndex()), Aur), Aur->GetModifier()->m_auraname);
+    m_auraModifierCache.Invalidate(Aur->GetModifier()->m_auraname);
+    _AddProcAura(Aur);
 
     Aur->ApplyModifier(true,true);
     sLog.outDebug("Aura %u now is in use", Aur->GetModifier()->m_auraname);
@@ -4071,8 +4018,8 @@ void Unit::RemoveNotOwnSingleTargetAuras()
     }
 
     // single target auras at other targets
-    AuraList& scAuras = GetSingleCastAuras();
-    for (AuraList::iterator iter = scAuras.begin(); iter != scAuras.end(); )
+    SingleCastAuraList& scAuras = GetSingleCastAuras();
+    for (SingleCastAuraList::iterator iter = scAuras.begin(); iter != scAuras.end(); )
     {
         Aura* aura = *iter;
         if (aura->GetTarget()!=this)
@@ -4089,11 +4036,13 @@ void Unit::RemoveNotOwnSingleTargetAuras()
 
 void Unit::RemoveAura(AuraMap::iterator &i, AuraRemoveMode mode)
 {
+    WakeUp();
+
     if (IsSingleTargetSpell((*i).second->GetSpellProto()))
     {
         if(Unit* caster = (*i).second->GetCaster())
         {
-            AuraList& scAuras = caster->GetSingleCastAuras();
+            SingleCastAuraList& scAuras = caster->GetSingleCastAuras();
             scAuras.remove((*i).second);
         }
         else
@@ -4103,19 +4052,17 @@ void Unit::RemoveAura(AuraMap::iterator &i, AuraRemoveMode mode)
         }
     }
 
-    if ((*i).second->GetModifier()->m_auraname < TOTAL_AURAS)
-    {
-        m_modAuras[(*i).second->GetModifier()->m_auraname].remove((*i).second);
-    }
-
     // remove from list before mods removing (prevent cyclic calls, mods added before including to aura list - use reverse order)
     Aura* Aur = i->second;
     // Set remove mode
     Aur->SetRemoveMode(mode);
     // some ShapeshiftBoosts at remove trigger removing other auras including parent Shapeshift aura
     // remove aura from list before to prevent deleting it before
+    // slot freed in place, iterator still usable and advanced below
     m_Auras.erase(i);
-    ++m_removedAuras;                                       // internal count used by unit update
+    m_auraModifierCache.Invalidate(Aur->GetModifier()->m_auraname);
+    _RemoveProcAura(Aur);
+    ++m_removedAuras;                                       // internal count used by type list iterations
 
     // Status unsummoned at aura remove
     Totem* statue = NULL;
@@ -4132,24 +4079,24 @@ void Unit::RemoveAura(AuraMap::iterator &i, AuraRemoveMode mode)
     if(statue)
         statue->UnSummon();
 
-    // only way correctly remove all auras from list
-    if( m_Auras.empty() )
-        i = m_Auras.end();
-    else
-        i = m_Auras.begin();
+    // other auras can be removed at this aura remove, but their slots stay in place
+    ++i;
 }
 
 void Unit::RemoveAllAuras()
 {
+    DeferStatUpdates();
     while (!m_Auras.empty())
     {
         AuraMap::iterator iter = m_Auras.begin();
         RemoveAura(iter);
     }
+    ApplyDeferredStatUpdates();
 }
 
 void Unit::RemoveAllAurasOnDeath()
 {
+    DeferStatUpdates();
     // used just after dieing to remove all visible auras
     // and disable the mods for the passive ones
     for(AuraMap::iterator iter = m_Auras.begin(); iter != m_Auras.end();)
@@ -4159,6 +4106,7 @@ void Unit::RemoveAllAurasOnDeath()
         else
             ++iter;
     }
+    ApplyDeferredStatUpdates();
 }
 
 void Unit::DelayAura(uint32 spellId, uint32 effindex, int32 delaytime)
@@ -4277,6 +4225,7 @@ void Unit::AddGameObject(GameObject* gameObj)
     assert(gameObj && gameObj->GetOwnerGUID()==0);
     m_gameObj.push_back(gameObj);
     gameObj->SetOwnerGUID(GetGUID());
+    WakeUp();
 }
 
 void Unit::RemoveGameObject(GameObject* gameObj, bool del)
@@ -6112,8 +6061,8 @@ bool Unit::HandleProcTriggerSpell(Unit *pVictim, uint32 damage, Aura* triggeredB
                             return false;
 
                         // single proc at time
-                        AuraList const& scAuras = GetSingleCastAuras();
-                        for(AuraList::const_iterator itr = scAuras.begin(); itr != scAuras.end(); ++itr)
+                        SingleCastAuraList const& scAuras = GetSingleCastAuras();
+                        for(SingleCastAuraList::const_iterator itr = scAuras.begin(); itr != scAuras.end(); ++itr)
                             if((*itr)->GetId()==triggered_spell_id)
                                 return false;
 
@@ -7593,6 +7542,8 @@ int32 Unit::SpellBaseDamageBonusForVictim(SpellSchoolMask schoolMask, Unit *pVic
 
 bool Unit::isSpellCrit(Unit *pVictim, SpellEntry const *spellProto, SpellSchoolMask schoolMask, WeaponAttackType attackType)
 {
+    ApplyPendingStatUpdates();
+
     // not criting spell
     if((spellProto->AttributesEx2 & SPELL_ATTR_EX2_CANT_CRIT))
         return false;
@@ -9413,42 +9364,97 @@ bool Unit::HandleStatModifier(UnitMods unitMod, UnitModifierType modifierType, f
     if(!CanModifyStats())
         return false;
 
-    switch(unitMod)
+    MarkStatsForUpdate(STAT_UPDATE_MOD(unitMod));
+    return true;
+}
+
+void Unit::MarkStatsForUpdate(uint32 statUpdateFlags)
+{
+    // every request counted, also for already marked values, so avoided = requests - updates
+    for(uint32 flags = statUpdateFlags; flags; flags &= flags - 1)
+        ++s_statUpdateRequests;
+
+    m_statUpdateFlags |= statUpdateFlags;
+
+    if(!m_statUpdateDeferCount)
+        _UpdateMarkedStats();
+}
+
+void Unit::_UpdateMarkedStats()
+{
+    if(!CanModifyStats())
     {
-        case UNIT_MOD_STAT_STRENGTH:
-        case UNIT_MOD_STAT_AGILITY:
-        case UNIT_MOD_STAT_STAMINA:
-        case UNIT_MOD_STAT_INTELLECT:
-        case UNIT_MOD_STAT_SPIRIT:         UpdateStats(GetStatByAuraGroup(unitMod));  break;
+        m_statUpdateFlags = 0;
+        return;
+    }
 
-        case UNIT_MOD_ARMOR:               UpdateArmor();           break;
-        case UNIT_MOD_HEALTH:              UpdateMaxHealth();       break;
+    // values marked while recalculating go to same loop
+    ++m_statUpdateDeferCount;
+    m_updatingMarkedStats = true;
 
-        case UNIT_MOD_MANA:
-        case UNIT_MOD_RAGE:
-        case UNIT_MOD_FOCUS:
-        case UNIT_MOD_ENERGY:
-        case UNIT_MOD_HAPPINESS:           UpdateMaxPower(GetPowerTypeByAuraGroup(unitMod));         break;
+    while(m_statUpdateFlags)
+    {
+        uint32 index = 0;
+        while(!(m_statUpdateFlags & (uint32(1) << index)))
+            ++index;
 
-        case UNIT_MOD_RESISTANCE_HOLY:
-        case UNIT_MOD_RESISTANCE_FIRE:
-        case UNIT_MOD_RESISTANCE_NATURE:
-        case UNIT_MOD_RESISTANCE_FROST:
-        case UNIT_MOD_RESISTANCE_SHADOW:
-        case UNIT_MOD_RESISTANCE_ARCANE:   UpdateResistances(GetSpellSchoolByAuraGroup(unitMod));      break;
+        m_statUpdateFlags &= ~(uint32(1) << index);
+        ++s_statUpdates;
 
-        case UNIT_MOD_ATTACK_POWER:        UpdateAttackPowerAndDamage();         break;
-        case UNIT_MOD_ATTACK_POWER_RANGED: UpdateAttackPowerAndDamage(true);     break;
+        switch(index)
+        {
+            case UNIT_MOD_STAT_STRENGTH:
+            case UNIT_MOD_STAT_AGILITY:
+            case UNIT_MOD_STAT_STAMINA:
+            case UNIT_MOD_STAT_INTELLECT:
+            case UNIT_MOD_STAT_SPIRIT:         UpdateStats(GetStatByAuraGroup(UnitMods(index)));  break;
 
-        case UNIT_MOD_DAMAGE_MAINHAND:     UpdateDamagePhysical(BASE_ATTACK);    break;
-        case UNIT_MOD_DAMAGE_OFFHAND:      UpdateDamagePhysical(OFF_ATTACK);     break;
-        case UNIT_MOD_DAMAGE_RANGED:       UpdateDamagePhysical(RANGED_ATTACK);  break;
+            case UNIT_MOD_ARMOR:               UpdateArmor();           break;
+            case UNIT_MOD_HEALTH:              UpdateMaxHealth();       break;
 
-        default:
-            break;
+            case UNIT_MOD_MANA:
+            case UNIT_MOD_RAGE:
+            case UNIT_MOD_FOCUS:
+            case UNIT_MOD_ENERGY:
+            case UNIT_MOD_HAPPINESS:           UpdateMaxPower(GetPowerTypeByAuraGroup(UnitMods(index)));         break;
+
+            case UNIT_MOD_RESISTANCE_HOLY:
+            case UNIT_MOD_RESISTANCE_FIRE:
+            case UNIT_MOD_RESISTANCE_NATURE:
+            case UNIT_MOD_RESISTANCE_FROST:
+            case UNIT_MOD_RESISTANCE_SHADOW:
+            case UNIT_MOD_RESISTANCE_ARCANE:   UpdateResistances(GetSpellSchoolByAuraGroup(UnitMods(index)));      break;
+
+            case UNIT_MOD_ATTACK_POWER:        UpdateAttackPowerAndDamage();         break;
+            case UNIT_MOD_ATTACK_POWER_RANGED: UpdateAttackPowerAndDamage(true);     break;
+
+            case UNIT_MOD_DAMAGE_MAINHAND:     UpdateDamagePhysical(BASE_ATTACK);    break;
+            case UNIT_MOD_DAMAGE_OFFHAND:      UpdateDamagePhysical(OFF_ATTACK);     break;
+            case UNIT_MOD_DAMAGE_RANGED:       UpdateDamagePhysical(RANGED_ATTACK);  break;
+
+            default:
+            {
+                if(GetTypeId() != TYPEID_PLAYER)
+                    break;
+
+                Player* player = (Player*)this;
+                switch(uint32(1) << index)
+                {
+                    case STAT_UPDATE_SHIELD_BLOCK: player->UpdateShieldBlockValue();            break;
+                    case STAT_UPDATE_CRIT:         player->UpdateAllCritPercentages();          break;
+                    case STAT_UPDATE_DODGE:        player->UpdateDodgePercentage();             break;
+                    case STAT_UPDATE_SPELL_CRIT:   player->UpdateAllSpellCritChances();         break;
+                    case STAT_UPDATE_SPELL_BONUS:  player->UpdateSpellDamageAndHealingBonus();  break;
+                    case STAT_UPDATE_MANA_REGEN:   player->UpdateManaRegen();                   break;
+                    default: break;
+                }
+                break;
+            }
+        }
     }
 
-    return true;
+    m_updatingMarkedStats = false;
+    --m_statUpdateDeferCount;
 }
 
 float Unit::GetModifierValue(UnitMods unitMod, UnitModifierType modifierType) const
@@ -9560,6 +9566,8 @@ Powers Unit::GetPowerTypeByAuraGroup(UnitMods unitMod) const
 
 float Unit::GetTotalAttackPowerValue(WeaponAttackType attType) const
 {
+    ApplyPendingStatUpdates();
+
     UnitMods unitMod = (attType == RANGED_ATTACK) ? UNIT_MOD_ATTACK_POWER_RANGED : UNIT_MOD_ATTACK_POWER;
 
     float val = GetTotalAuraModValue(unitMod);
@@ -9588,6 +9596,8 @@ void Unit::SetLevel(uint32 lvl)
 
 void Unit::SetHealth(uint32 val)
 {
+    WakeUp();                                               // health aura states updated in Unit::Update
+
     uint32 maxHealth = GetMaxHealth();
     if(maxHealth < val)
         val = maxHealth;
@@ -9614,6 +9624,8 @@ void Unit::SetHealth(uint32 val)
 
 void Unit::SetMaxHealth(uint32 val)
 {
+    WakeUp();
+
     uint32 health = GetHealth();
     SetUInt32Value(UNIT_FIELD_MAXHEALTH, val);
 
@@ -9740,15 +9752,6 @@ void Unit::ApplyMaxPowerMod(Powers power, uint32 val, bool apply)
     }
 }
 
-void Unit::ApplyAuraProcTriggerDamage( Aura* aura, bool apply )
-{
-    AuraList& tAuraProcTriggerDamage = m_modAuras[SPELL_AURA_PROC_TRIGGER_DAMAGE];
-    if(apply)
-        tAuraProcTriggerDamage.push_back(aura);
-    else
-        tAuraProcTriggerDamage.remove(aura);
-}
-
 uint32 Unit::GetCreatePowers( Powers power ) const
 {
     // POWER_FOCUS and POWER_HAPPINESS only have hunter pet
@@ -9959,6 +9962,80 @@ bool Unit::isFrozen() const
     return false;
 }
 
+void Unit::_AddProcAura(Aura* aura)
+{
+    AuraType auraType = aura->GetModifier()->m_auraname;
+    if(procAuraTypes.find(auraType) == procAuraTypes.end())
+        return;
+
+    SpellEntry const *spellProto = aura->GetSpellProto();
+    if(!spellProto)
+        return;
+
+    SpellProcEventEntry const *spellProcEvent = spellmgr.GetSpellProcEvent(spellProto->Id);
+    if(!spellProcEvent)
+    {
+        // used to prevent spam in log about same non-handled spells
+        static std::set<uint32> nonHandledSpellProcSet;
+
+        if(spellProto->procFlags != 0 && nonHandledSpellProcSet.find(spellProto->Id)==nonHandledSpellProcSet.end())
+        {
+            sLog.outError("ProcDamageAndSpell: spell %u (aura source) not have record in `spell_proc_event`)",spellProto->Id);
+            nonHandledSpellProcSet.insert(spellProto->Id);
+        }
+
+        // spell.dbc use totally different flags, that only can create problems if used.
+        return;
+    }
+
+    ProcAuraEntry entry;
+    entry.aura = aura;
+    entry.procEvent = spellProcEvent;
+    entry.procFlags = spellProcEvent->procFlags;
+    entry.auraType = auraType;
+    m_procAuras.push_back(entry);
+    m_procAuraFlags |= entry.procFlags;
+}
+
+void Unit::_RemoveProcAura(Aura* aura)
+{
+    for(ProcAuraEntries::iterator itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
+    {
+        if(itr->aura == aura)
+        {
+            m_procAuras.erase(itr);
+
+            m_procAuraFlags = 0;
+            for(itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
+                m_procAuraFlags |= itr->procFlags;
+            return;
+        }
+    }
+}
+
+void Unit::_RebuildProcAuras()
+{
+    m_procAuras.clear();
+    m_procAuraFlags = 0;
+    m_procAuraGeneration = spellmgr.GetSpellProcEventGeneration();
+
+    // by type lists, to keep apply order of auras with same type
+    for(AuraTypeSet::const_iterator aur = procAuraTypes.begin(); aur != procAuraTypes.end(); ++aur)
+    {
+        AuraList const& auras = GetAurasByType(*aur);
+        for(AuraList::const_iterator i = auras.begin(); i != auras.end(); ++i)
+            _AddProcAura(*i);
+    }
+}
+
+void Unit::_ClearAuraStorage()
+{
+    m_Auras.clear();
+    m_auraModifierCache.Clear();
+    m_procAuras.clear();
+    m_procAuraFlags = 0;
+}
+
 struct ProcTriggeredData
 {
     ProcTriggeredData(SpellEntry const * _spellInfo, uint32 _spellParam, Aura* _triggeredByAura, uint32 _cooldown)
@@ -9978,35 +10055,27 @@ typedef std::list< ProcTriggeredData > ProcTriggeredList;
 
 void Unit::ProcDamageAndSpellFor( bool isVictim, Unit * pTarget, uint32 procFlag, AuraTypeSet const& procAuraTypes, WeaponAttackType attType, SpellEntry const * procSpell, uint32 damage, SpellSchoolMask damageSchoolMask )
 {
+    if(m_procAuraGeneration != spellmgr.GetSpellProcEventGeneration())
+        _RebuildProcAuras();
+
+    // no applied aura can proc at this event
+    if((m_procAuraFlags & procFlag) == 0)
+        return;
+
     for(AuraTypeSet::const_iterator aur = procAuraTypes.begin(); aur != procAuraTypes.end(); ++aur)
     {
         // List of spells (effects) that proceed. Spell prototype and aura-specific value (damage for TRIGGER_DAMAGE)
         ProcTriggeredList procTriggered;
 
-        AuraList const& auras = GetAurasByType(*aur);
-        for(AuraList::const_iterator i = auras.begin(), next; i != auras.end(); i = next)
+        // proc auras not changed until triggered list processing
+        for(ProcAuraEntries::const_iterator itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
         {
-            next = i; ++next;
-
-            SpellEntry const *spellProto = (*i)->GetSpellProto();
-            if(!spellProto)
+            if(itr->auraType != *aur || (itr->procFlags & procFlag) == 0)
                 continue;
 
-            SpellProcEventEntry const *spellProcEvent = spellmgr.GetSpellProcEvent(spellProto->Id);
-            if(!spellProcEvent)
-            {
-                // used to prevent spam in log about same non-handled spells
-                static std::set<uint32> nonHandledSpellProcSet;
-
-                if(spellProto->procFlags != 0 && nonHandledSpellProcSet.find(spellProto->Id)==nonHandledSpellProcSet.end())
-                {
-                    sLog.outError("ProcDamageAndSpell: spell %u (%s aura source) not have record in `spell_proc_event`)",spellProto->Id,(isVictim?"a victim's":"an attacker's"));
-                    nonHandledSpellProcSet.insert(spellProto->Id);
-                }
-
-                // spell.dbc use totally different flags, that only can create problems if used.
-                continue;
-            }
+            Aura* aura = itr->aura;
+            SpellEntry const *spellProto = aura->GetSpellProto();
+            SpellProcEventEntry const *spellProcEvent = itr->procEvent;
 
             // Check spellProcEvent data requirements
             if(!SpellMgr::IsSpellProcEventCanTriggeredBy(spellProcEvent, procSpell,procFlag))
@@ -10046,7 +10115,7 @@ void Unit::ProcDamageAndSpellFor( bool isVictim, Unit * pTarget, uint32 procFlag
             {
                 uint32 cooldown = spellProcEvent->cooldown;
 
-                uint32 i_spell_eff = (*i)->GetEffIndex();
+                uint32 i_spell_eff = aura->GetEffIndex();
 
                 int32 i_spell_param;
                 switch(*aur)
@@ -10060,14 +10129,14 @@ void Unit::ProcDamageAndSpellFor( bool isVictim, Unit * pTarget, uint32 procFlag
                         i_spell_param = i_spell_eff;
                         break;
                     case SPELL_AURA_OVERRIDE_CLASS_SCRIPTS:
-                        i_spell_param = (*i)->GetModifier()->m_miscvalue;
+                        i_spell_param = aura->GetModifier()->m_miscvalue;
                         break;
                     default:
-                        i_spell_param = (*i)->GetModifier()->m_amount;
+                        i_spell_param = aura->GetModifier()->m_amount;
                         break;
                 }
 
-                procTriggered.push_back( ProcTriggeredData(spellProto,i_spell_param,*i, cooldown) );
+                procTriggered.push_back( ProcTriggeredData(spellProto,i_spell_param,aura, cooldown) );
             }
         }
 
@@ -10232,6 +10301,7 @@ void Unit::ProcDamageAndSpellFor( bool isVictim, Unit * pTarget, uint32 procFlag
         }
 
         // Safely remove auras with zero charges
+        AuraList const& auras = GetAurasByType(*aur);
         for(AuraList::const_iterator i = auras.begin(), next; i != auras.end(); i = next)
         {
             next = i; ++next;
@@ -10561,7 +10631,7 @@ Unit* Unit::SelectNearbyTarget() const
     cell.data.Part.reserved = ALL_DISTRICT;
     cell.SetNoCreate();
 
-    std::list<Unit *> targets;
+    UnitList targets;
 
     {
         MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck u_check(this, this, ATTACK_DISTANCE);
@@ -10580,11 +10650,11 @@ Unit* Unit::SelectNearbyTarget() const
         targets.remove(getVictim());
 
     // remove not LoS targets
-    for(std::list<Unit *>::iterator tIter = targets.begin(); tIter != targets.end();)
+    for(UnitList::iterator tIter = targets.begin(); tIter != targets.end();)
     {
         if(!IsWithinLOSInMap(*tIter))
         {
-            std::list<Unit *>::iterator tIter2 = tIter;
+            UnitList::iterator tIter2 = tIter;
             ++tIter;
             targets.erase(tIter2);
         }
@@ -10598,7 +10668,7 @@ Unit* Unit::SelectNearbyTarget() const
 
     // select random
     uint32 rIdx = urand(0,targets.size()-1);
-    std::list<Unit *>::const_iterator tcIter = targets.begin();
+    UnitList::const_iterator tcIter = targets.begin();
     for(uint32 i = 0; i < rIdx; ++i)
         ++tcIter;
 
@@ -24,6 +24,8 @@
 #include "Opcodes.h"
 #include "Mthread.h"
 #include "SpellAuraDefines.h"
+#include "AuraContainer.h"
+#include "AuraModifierCache.h"
 #include "UpdateFields.h"
 #include "SharedDefines.h"
 #include "ThreatManager.h"
@@ -232,6 +234,7 @@ struct FactionTemplateEntry;
 struct Modifier;
 struct SpellEntry;
 struct SpellEntryExt;
+struct SpellProcEventEntry;
 
 class Aura;
 class Creature;
@@ -242,6 +245,10 @@ class Item;
 class Pet;
 class Path;
 class PetAura;
+class Unit;
+
+// filled by grid searchers and spell targeting at high rate, nodes reused through NodePool
+typedef std::list<Unit*, PoolAllocator<Unit*> > UnitList;
 
 struct SpellImmune
 {
@@ -317,6 +324,20 @@ enum UnitMods
     UNIT_MOD_POWER_END = UNIT_MOD_HAPPINESS + 1
 };
 
+// Derived values marked for recalculation by Unit::MarkStatsForUpdate, recalculated in bit order
+// (so after the values they depend on). Bits below UNIT_MOD_END are STAT_UPDATE_MOD(UnitMods).
+#define STAT_UPDATE_MOD(mod) (uint32(1) << (mod))
+
+enum StatUpdateFlags
+{
+    STAT_UPDATE_SHIELD_BLOCK    = 1 << (UNIT_MOD_END + 0),  // player only
+    STAT_UPDATE_CRIT            = 1 << (UNIT_MOD_END + 1),
+    STAT_UPDATE_DODGE           = 1 << (UNIT_MOD_END + 2),
+    STAT_UPDATE_SPELL_CRIT      = 1 << (UNIT_MOD_END + 3),
+    STAT_UPDATE_SPELL_BONUS     = 1 << (UNIT_MOD_END + 4),
+    STAT_UPDATE_MANA_REGEN      = 1 << (UNIT_MOD_END + 5)
+};
+
 enum BaseModGroup
 {
     CRIT_PERCENTAGE,
@@ -579,6 +600,15 @@ struct CleanDamage
     MeleeHitOutcome hitOutCome;
 };
 
+// proc capable aura with its spell_proc_event data, see Unit::ProcDamageAndSpellFor
+struct ProcAuraEntry
+{
+    Aura* aura;
+    SpellProcEventEntry const* procEvent;
+    uint32 procFlags;                                       // copy of procEvent->procFlags, tested before other data
+    AuraType auraType;
+};
+
 struct UnitActionBarEntry
 {
     uint32 Type;
@@ -690,8 +720,9 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
     public:
         typedef std::set<Unit*> AttackerSet;
         typedef std::pair<uint32, uint8> spellEffectPair;
-        typedef std::multimap< spellEffectPair, Aura*> AuraMap;
-        typedef std::list<Aura *> AuraList;
+        typedef AuraContainer AuraMap;
+        typedef AuraContainer::TypeList AuraList;
+        typedef std::list<Aura *> SingleCastAuraList;
         typedef std::list<DiminishingReturn> Diminishing;
         typedef std::set<AuraType> AuraTypeSet;
         typedef std::set<uint32> ComboPointHolderSet;
@@ -770,16 +801,16 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         uint32 getClassMask() const { return 1 << (getClass()-1); }
         uint8 getGender() const { return GetByteValue(UNIT_FIELD_BYTES_0, 2); }
 
-        float GetStat(Stats stat) const { return float(GetUInt32Value(UNIT_FIELD_STAT0+stat)); }
+        float GetStat(Stats stat) const { ApplyPendingStatUpdates(); return float(GetUInt32Value(UNIT_FIELD_STAT0+stat)); }
         void SetStat(Stats stat, int32 val) { SetStatInt32Value(UNIT_FIELD_STAT0+stat, val); }
         uint32 GetArmor() const { return GetResistance(SPELL_SCHOOL_NORMAL) ; }
         void SetArmor(int32 val) { SetResistance(SPELL_SCHOOL_NORMAL, val); }
 
-        uint32 GetResistance(SpellSchools school) const { return GetUInt32Value(UNIT_FIELD_RESISTANCES+school); }
+        uint32 GetResistance(SpellSchools school) const { ApplyPendingStatUpdates(); return GetUInt32Value(UNIT_FIELD_RESISTANCES+school); }
         void SetResistance(SpellSchools school, int32 val) { SetStatInt32Value(UNIT_FIELD_RESISTANCES+school,val); }
 
         uint32 GetHealth()    const { return GetUInt32Value(UNIT_FIELD_HEALTH); }
-        uint32 GetMaxHealth() const { return GetUInt32Value(UNIT_FIELD_MAXHEALTH); }
+        uint32 GetMaxHealth() const { ApplyPendingStatUpdates(); return GetUInt32Value(UNIT_FIELD_MAXHEALTH); }
         void SetHealth(   uint32 val);
         void SetMaxHealth(uint32 val);
         int32 ModifyHealth(int32 val);
@@ -787,7 +818,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         Powers getPowerType() const { return Powers(GetByteValue(UNIT_FIELD_BYTES_0, 3)); }
         void setPowerType(Powers power);
         uint32 GetPower(   Powers power) const { return GetUInt32Value(UNIT_FIELD_POWER1   +power); }
-        uint32 GetMaxPower(Powers power) const { return GetUInt32Value(UNIT_FIELD_MAXPOWER1+power); }
+        uint32 GetMaxPower(Powers power) const { ApplyPendingStatUpdates(); return GetUInt32Value(UNIT_FIELD_MAXPOWER1+power); }
         void SetPower(   Powers power, uint32 val);
         void SetMaxPower(Powers power, uint32 val);
         int32 ModifyPower(Powers power, int32 val);
@@ -1079,6 +1110,25 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         Powers GetPowerTypeByAuraGroup(UnitMods unitMod) const;
         bool CanModifyStats() const { return m_canModifyStats; }
         void SetCanModifyStats(bool modifyStats) { m_canModifyStats = modifyStats; }
+
+        // Marked values are recalculated at once, or inside DeferStatUpdates/ApplyDeferredStatUpdates
+        // block only once at block end, so many modifiers applied together not recalculate same values.
+        void MarkStatsForUpdate(uint32 statUpdateFlags);
+        void DeferStatUpdates() { ++m_statUpdateDeferCount; }
+        void ApplyDeferredStatUpdates()
+        {
+            if(--m_statUpdateDeferCount == 0 && m_statUpdateFlags)
+                _UpdateMarkedStats();
+        }
+        // recalculate marked values now, called by derived value getters (stats, resistances, max health/power,
+        // attack power, weapon damage, crit/dodge/parry/block chances) used inside deferred block
+        void ApplyPendingStatUpdates() const
+        {
+            if(m_statUpdateFlags && !m_updatingMarkedStats)
+                const_cast<Unit*>(this)->_UpdateMarkedStats();
+        }
+        static uint64 GetStatUpdateRequestCount() { return s_statUpdateRequests; }
+        static uint64 GetStatUpdateCount() { return s_statUpdates; }
         virtual bool UpdateStats(Stats stat) = 0;
         virtual bool UpdateAllStats() = 0;
         virtual void UpdateResistances(uint32 school) = 0;
@@ -1109,8 +1159,8 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         virtual bool IsVisibleInGridForPlayer(Player* pl) const = 0;
 
         bool waterbreath;
-        AuraList      & GetSingleCastAuras()       { return m_scAuras; }
-        AuraList const& GetSingleCastAuras() const { return m_scAuras; }
+        SingleCastAuraList      & GetSingleCastAuras()       { return m_scAuras; }
+        SingleCastAuraList const& GetSingleCastAuras() const { return m_scAuras; }
         SpellImmuneList m_spellImmune[MAX_SPELL_IMMUNITY];
 
         // Threat related methodes
@@ -1129,8 +1179,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         Aura* GetAura(uint32 spellId, uint32 effindex);
         AuraMap      & GetAuras()       { return m_Auras; }
         AuraMap const& GetAuras() const { return m_Auras; }
-        AuraList const& GetAurasByType(AuraType type) const { return m_modAuras[type]; }
-        void ApplyAuraProcTriggerDamage(Aura* aura, bool apply);
+        AuraList GetAurasByType(AuraType type) const { return m_Auras.GetByType(type); }
 
         int32 GetTotalAuraModifier(AuraType auratype) const;
         float GetTotalAuraMultiplier(AuraType auratype) const;
@@ -1147,6 +1196,9 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         int32 GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const;
         int32 GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const;
 
+        // must be called at any change of amount or misc value of applied auras of this type
+        void InvalidateAuraModifierCache(AuraType auratype) { m_auraModifierCache.Invalidate(auratype); }
+
         Aura* GetDummyAura(uint32 spell_id) const;
 
         uint32 GetDisplayId() { return GetUInt32Value(UNIT_FIELD_DISPLAYID); }
@@ -1252,12 +1304,16 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         // reactive attacks
         void ClearAllReactives();
-        void StartReactiveTimer( ReactiveType reactive ) { m_reactiveTimer[reactive] = REACTIVE_TIMER_START;}
+        void StartReactiveTimer( ReactiveType reactive ) { m_reactiveTimer[reactive] = REACTIVE_TIMER_START; WakeUp(); }
         void UpdateReactives(uint32 p_time);
 
         // group updates
         void UpdateAuraForGroup(uint8 slot);
 
+        // idle creature update skipping, see Creature::UpdateSleepState
+        bool IsSleeping() const { return m_sleeping; }
+        void WakeUp() { m_sleeping = false; }
+
         // pet auras
         typedef std::set<PetAura const*> PetAuraSet;
         PetAuraSet m_petAuras;
@@ -1283,7 +1339,16 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         AuraMap m_Auras;
 
-        std::list<Aura *> m_scAuras;                        // casted singlecast auras
+        SingleCastAuraList m_scAuras;                       // casted singlecast auras
+        mutable AuraModifierCache m_auraModifierCache;      // totals by aura type, filled by const getters
+
+        typedef std::vector<ProcAuraEntry> ProcAuraEntries;
+        ProcAuraEntries m_procAuras;                        // proc capable auras in apply order
+        uint32 m_procAuraFlags;                             // all procFlags of m_procAuras
+        uint32 m_procAuraGeneration;                        // spell_proc_event load of m_procAuras data
+
+        // drop all aura pointers without remove handling, for aura loading
+        void _ClearAuraStorage();
 
         typedef std::list<uint64> DynObjectGUIDs;
         DynObjectGUIDs m_dynObjGUIDs;
@@ -1293,10 +1358,14 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         uint32 m_transform;
         uint32 m_removedAuras;
 
-        AuraList m_modAuras[TOTAL_AURAS];
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
         float m_weaponDamage[MAX_ATTACK][2];
         bool m_canModifyStats;
+        uint32 m_statUpdateFlags;                           // StatUpdateFlags waiting for recalculation
+        uint32 m_statUpdateDeferCount;
+        bool m_updatingMarkedStats;                         // getters not recalculate from inside recalculation
+        static uint64 s_statUpdateRequests;
+        static uint64 s_statUpdates;
         //std::list< spellEffectPair > AuraSpells[TOTAL_AURAS];  // TODO: use this if ok for mem
 
         float m_speed_rate[MAX_MOVE_TYPE];
@@ -1310,6 +1379,8 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         uint32 m_reactiveTimer[MAX_REACTIVE];
 
+        bool m_sleeping;                                    // set only by Creature::UpdateSleepState
+
     private:
         void SendAttackStop(Unit* victim);                  // only from AttackStop(Unit*)
         void SendAttackStart(Unit* pVictim);                // only from Unit::AttackStart(Unit*)
@@ -1320,6 +1391,15 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         bool HandleHasteAuraProc(Unit *pVictim, SpellEntry const *spellProto, uint32 effIndex, uint32 damage, Aura* triggredByAura, SpellEntry const * procSpell, uint32 procFlag,uint32 cooldown);
         bool HandleOverrideClassScriptAuraProc(Unit *pVictim, int32 scriptId, uint32 damage, Aura* triggredByAura, SpellEntry const *procSpell,uint32 cooldown);
 
+        void _AddProcAura(Aura* aura);
+        void _RemoveProcAura(Aura* aura);
+        void _RebuildProcAuras();
+
+        int32 GetAuraModifierAggregate(AuraType auratype, AuraAggregateType aggregate, AuraAggregateFilter filter, int32 filterValue) const;
+        float GetAuraMultiplierAggregate(AuraType auratype, AuraAggregateFilter filter, int32 filterValue) const;
+
+        void _UpdateMarkedStats();
+
         uint32 m_state;                                     // Even derived shouldn't modify
         uint32 m_CombatTimer;
         uint32 m_lastManaUse;                               // msecs
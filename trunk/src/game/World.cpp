@@ -55,6 +55,10 @@
 #include "CellImpl.h"
 #include "InstanceSaveMgr.h"
 #include "WaypointManager.h"
+#include "QueryResponseCache.h"
+#include "OpcodeProfiler.h"
+#include "WorldSocketMgr.h"
+#include "MovementRelay.h"
 #include "Util.h"
 
 INSTANTIATE_SINGLETON_1( World );
@@ -540,6 +544,47 @@ void World::LoadConfigSettings(bool reload)
 
     m_configs[CONFIG_INTERVAL_CHANGEWEATHER] = sConfig.GetIntDefault("ChangeWeatherInterval", 600000);
 
+    m_configs[CONFIG_OBJECT_POOL_MAX_FREE] = sConfig.GetIntDefault("ObjectPoolMaxFree", 1000);
+    FixedSizePool::SetMaxFreeBlocks(m_configs[CONFIG_OBJECT_POOL_MAX_FREE]);
+
+    m_configs[CONFIG_CREATURE_IDLE_SLEEP] = sConfig.GetBoolDefault("CreatureIdleSleep", true);
+
+    m_configs[CONFIG_QUERY_RESPONSE_CACHE] = sConfig.GetBoolDefault("QueryResponseCache", true);
+    sQueryResponseCache.SetEnabled(m_configs[CONFIG_QUERY_RESPONSE_CACHE]);
+
+    m_configs[CONFIG_OPCODE_PROFILER] = sConfig.GetBoolDefault("OpcodeProfiler", false);
+    sOpcodeProfiler.SetEnabled(m_configs[CONFIG_OPCODE_PROFILER]);
+
+    m_configs[CONFIG_OPCODE_PROFILER_LOG_INTERVAL] = sConfig.GetIntDefault("OpcodeProfilerLogInterval", 60000);
+    if(m_configs[CONFIG_OPCODE_PROFILER_LOG_INTERVAL] < 1000)
+    {
+        sLog.outError("OpcodeProfilerLogInterval (%i) must be >= 1000. Using 1000 instead.",m_configs[CONFIG_OPCODE_PROFILER_LOG_INTERVAL]);
+        m_configs[CONFIG_OPCODE_PROFILER_LOG_INTERVAL] = 1000;
+    }
+    if(reload)
+        m_timers[WUPDATE_OPCODE_LOG].SetInterval(m_configs[CONFIG_OPCODE_PROFILER_LOG_INTERVAL]);
+
+    m_configs[CONFIG_PACKET_RATE_QUERY] = sConfig.GetIntDefault("PacketRate.Query", 200);
+    m_configs[CONFIG_PACKET_RATE_SEARCH] = sConfig.GetIntDefault("PacketRate.Search", 2);
+    m_configs[CONFIG_PACKET_RATE_CHAT] = sConfig.GetIntDefault("PacketRate.Chat", 10);
+    m_configs[CONFIG_PACKET_RATE_MOVEMENT] = sConfig.GetIntDefault("PacketRate.Movement", 100);
+    for(int i = CONFIG_PACKET_RATE_QUERY; i <= CONFIG_PACKET_RATE_MOVEMENT; ++i)
+    {
+        if(m_configs[i] > MAX_PACKET_RATE)
+        {
+            sLog.outError("PacketRate.* (%u) can't be greater %u. Use this maximal value.",m_configs[i],MAX_PACKET_RATE);
+            m_configs[i] = MAX_PACKET_RATE;
+        }
+    }
+    m_configs[CONFIG_PACKET_RATE_BURST] = sConfig.GetIntDefault("PacketRate.Burst", 5);
+    if(m_configs[CONFIG_PACKET_RATE_BURST] < 1 || m_configs[CONFIG_PACKET_RATE_BURST] > 60)
+    {
+        sLog.outError("PacketRate.Burst (%i) must be in range 1..60. Using 5 instead.",m_configs[CONFIG_PACKET_RATE_BURST]);
+        m_configs[CONFIG_PACKET_RATE_BURST] = 5;
+    }
+    m_configs[CONFIG_SESSION_PACKET_BUDGET] = sConfig.GetIntDefault("SessionPacketBudget", 100);
+    m_configs[CONFIG_SESSION_MAX_PENDING_PACKETS] = sConfig.GetIntDefault("SessionMaxPendingPackets", 1000);
+
     if(reload)
     {
         uint32 val = sConfig.GetIntDefault("WorldServerPort", DEFAULT_WORLDSERVER_PORT);
@@ -847,6 +892,11 @@ void World::LoadConfigSettings(bool reload)
         m_MaxVisibleDistanceInFlight = MAX_VISIBILITY_DISTANCE - m_VisibleObjectGreyDistance;
     }
 
+    m_configs[CONFIG_MOVEMENT_RELAY_MERGE_HEARTBEATS] = sConfig.GetBoolDefault("Movement.Relay.MergeHeartbeats", true);
+    LoadMovementRelayTier("Continents",    CONFIG_MOVEMENT_RELAY_NEAR_CONTINENTS,    CONFIG_MOVEMENT_RELAY_FAR_CONTINENTS,    30, 50);
+    LoadMovementRelayTier("Instances",     CONFIG_MOVEMENT_RELAY_NEAR_INSTANCES,     CONFIG_MOVEMENT_RELAY_FAR_INSTANCES,     0,  0);
+    LoadMovementRelayTier("BattleGrounds", CONFIG_MOVEMENT_RELAY_NEAR_BATTLEGROUNDS, CONFIG_MOVEMENT_RELAY_FAR_BATTLEGROUNDS, 30, 50);
+
     ///- Read the "Data" directory from the config file
     std::string dataPath = sConfig.GetStringDefault("DataDir","./");
     if( dataPath.at(dataPath.length()-1)!='/' && dataPath.at(dataPath.length()-1)!='\\' )
@@ -871,9 +921,33 @@ void World::LoadConfigSettings(bool reload)
     VMAP::VMapFactory::createOrGetVMapManager()->setEnableHeightCalc(enableHeight);
     VMAP::VMapFactory::createOrGetVMapManager()->preventMapsFromBeingUsed(ignoreMapIds.c_str());
     VMAP::VMapFactory::preventSpellsFromBeingTestedForLoS(ignoreSpellIds.c_str());
+
+    m_configs[CONFIG_LOS_CACHE_SIZE] = sConfig.GetIntDefault("vmap.losCache.size", 4096);
+    m_configs[CONFIG_LOS_CACHE_TTL] = sConfig.GetIntDefault("vmap.losCache.ttl", 1000);
+    rate_values[RATE_LOS_CACHE_GRID_SIZE] = sConfig.GetFloatDefault("vmap.losCache.gridSize", 0.5f);
+    if(rate_values[RATE_LOS_CACHE_GRID_SIZE] <= 0.0f)
+    {
+        sLog.outError("vmap.losCache.gridSize (%f) must be > 0. Using 0.5 instead.",rate_values[RATE_LOS_CACHE_GRID_SIZE]);
+        rate_values[RATE_LOS_CACHE_GRID_SIZE] = 0.5f;
+    }
     sLog.outString( "WORLD: VMap support included. LineOfSight:%i, getHeight:%i",enableLOS, enableHeight);
     sLog.outString( "WORLD: VMap data directory is: %svmaps",m_dataPath.c_str());
-    sLog.outString( "WORLD: VMap config keys are: vmap.enableLOS, vmap.enableHeight, vmap.ignoreMapIds, vmap.ignoreSpellIds");
+    sLog.outString( "WORLD: VMap LoS cache: %u entries, grid size %f, TTL %u ms",m_configs[CONFIG_LOS_CACHE_SIZE],rate_values[RATE_LOS_CACHE_GRID_SIZE],m_configs[CONFIG_LOS_CACHE_TTL]);
+    sLog.outString( "WORLD: VMap config keys are: vmap.enableLOS, vmap.enableHeight, vmap.ignoreMapIds, vmap.ignoreSpellIds, vmap.losCache.size, vmap.losCache.gridSize, vmap.losCache.ttl");
+}
+
+/// Read movement relay tier distances of one map type
+void World::LoadMovementRelayTier(char const* mapTypeName, WorldConfigs nearIndex, WorldConfigs farIndex, uint32 nearDefault, uint32 farDefault)
+{
+    m_configs[nearIndex] = sConfig.GetIntDefault((std::string("Movement.Relay.NearDistance.") + mapTypeName).c_str(), nearDefault);
+    m_configs[farIndex]  = sConfig.GetIntDefault((std::string("Movement.Relay.FarDistance.") + mapTypeName).c_str(), farDefault);
+
+    if(m_configs[farIndex] && m_configs[farIndex] < m_configs[nearIndex])
+    {
+        sLog.outError("Movement.Relay.FarDistance.%s (%u) can't be less Movement.Relay.NearDistance.%s (%u). Using %u instead.",
+            mapTypeName, m_configs[farIndex], mapTypeName, m_configs[nearIndex], m_configs[nearIndex]);
+        m_configs[farIndex] = m_configs[nearIndex];
+    }
 }
 
 /// Initialize the World
@@ -959,6 +1033,12 @@ void World::SetInitialWorldSettings()
     sLog.outString( "Loading Spell Elixir types..." );
     spellmgr.LoadSpellElixirs();
 
+    sLog.outString( "Loading Spell Classifications..." );   // must be after LoadSpellElixirs
+    spellmgr.LoadSpellClassifications();
+
+    sLog.outString( "Loading Spell Cast Plans..." );
+    spellmgr.LoadSpellCastPlans();
+
     sLog.outString( "Loading Spell Learn Skills..." );
     spellmgr.LoadSpellLearnSkills();                        // must be after LoadSpellChains
 
@@ -1158,6 +1238,9 @@ void World::SetInitialWorldSettings()
     m_timers[WUPDATE_UPTIME].SetInterval(m_configs[CONFIG_UPTIME_UPDATE]*MINUTE*1000);
                                                             //Update "uptime" table based on configuration entry in minutes.
     m_timers[WUPDATE_CORPSES].SetInterval(20*MINUTE*1000);  //erase corpses every 20 minutes
+    m_timers[WUPDATE_OPCODE_LOG].SetInterval(m_configs[CONFIG_OPCODE_PROFILER_LOG_INTERVAL]);
+
+    sOpcodeProfiler.OpenLogFile();
 
     //to set mailtimer to return mails every day between 4 and 5 am
     //mailtimer is increased when updating auctions
@@ -1361,6 +1444,13 @@ void World::Update(time_t diff)
         WorldDatabase.PExecute("UPDATE uptime SET uptime = %d, maxplayers = %d WHERE starttime = " I64FMTD, tmpDiff, maxClientsNum, uint64(m_startTime));
     }
 
+    /// <li> Write opcode profiler stats
+    if (m_timers[WUPDATE_OPCODE_LOG].Passed())
+    {
+        m_timers[WUPDATE_OPCODE_LOG].Reset();
+        sOpcodeProfiler.WriteLog();
+    }
+
     /// <li> Handle all other objects
     if (m_timers[WUPDATE_OBJECTS].Passed())
     {
@@ -1404,6 +1494,12 @@ void World::Update(time_t diff)
 
     // And last, but not least handle the issued cli commands
     ProcessCliCommands();
+
+    ///- Relay last movement heartbeat of players received in this tick
+    sMovementRelay.SendPendingHeartbeats();
+
+    ///- Let network threads send packets built in this tick, one write per socket
+    sWorldSocketMgr->FlushOutput();
 }
 
 /// Put scripts in the execution queue
@@ -59,7 +59,8 @@ enum WorldTimers
     WUPDATE_UPTIME      = 4,
     WUPDATE_CORPSES     = 5,
     WUPDATE_EVENTS      = 6,
-    WUPDATE_COUNT       = 7
+    WUPDATE_OPCODE_LOG  = 7,
+    WUPDATE_COUNT       = 8
 };
 
 /// Configuration elements
@@ -161,6 +162,27 @@ enum WorldConfigs
     CONFIG_LISTEN_RANGE_SAY,
     CONFIG_LISTEN_RANGE_TEXTEMOTE,
     CONFIG_LISTEN_RANGE_YELL,
+    CONFIG_LOS_CACHE_SIZE,
+    CONFIG_LOS_CACHE_TTL,
+    CONFIG_OBJECT_POOL_MAX_FREE,
+    CONFIG_CREATURE_IDLE_SLEEP,
+    CONFIG_QUERY_RESPONSE_CACHE,
+    CONFIG_OPCODE_PROFILER,
+    CONFIG_OPCODE_PROFILER_LOG_INTERVAL,
+    CONFIG_PACKET_RATE_QUERY,
+    CONFIG_PACKET_RATE_SEARCH,
+    CONFIG_PACKET_RATE_CHAT,
+    CONFIG_PACKET_RATE_MOVEMENT,
+    CONFIG_PACKET_RATE_BURST,
+    CONFIG_SESSION_PACKET_BUDGET,
+    CONFIG_SESSION_MAX_PENDING_PACKETS,
+    CONFIG_MOVEMENT_RELAY_MERGE_HEARTBEATS,
+    CONFIG_MOVEMENT_RELAY_NEAR_CONTINENTS,
+    CONFIG_MOVEMENT_RELAY_FAR_CONTINENTS,
+    CONFIG_MOVEMENT_RELAY_NEAR_INSTANCES,
+    CONFIG_MOVEMENT_RELAY_FAR_INSTANCES,
+    CONFIG_MOVEMENT_RELAY_NEAR_BATTLEGROUNDS,
+    CONFIG_MOVEMENT_RELAY_FAR_BATTLEGROUNDS,
     CONFIG_VALUE_COUNT
 };
 
@@ -222,6 +244,7 @@ enum Rates
     RATE_DURABILITY_LOSS_PARRY,
     RATE_DURABILITY_LOSS_ABSORB,
     RATE_DURABILITY_LOSS_BLOCK,
+    RATE_LOS_CACHE_GRID_SIZE,
     MAX_RATES
 };
 
@@ -480,6 +503,8 @@ class World
 
         void InitDailyQuestResetTime();
         void ResetDailyQuests();
+
+        void LoadMovementRelayTier(char const* mapTypeName, WorldConfigs nearIndex, WorldConfigs farIndex, uint32 nearDefault, uint32 farDefault);
     private:
         time_t m_startTime;
         time_t m_gameTime;
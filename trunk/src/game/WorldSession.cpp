@@ -39,14 +39,30 @@
 #include "Language.h"                                       // for CMSG_CANCEL_MOUNT_AURA handler
 #include "Chat.h"
 #include "SocialMgr.h"
+#include "OpcodeProfiler.h"
+
+/// Received packets per second allowed for opcode class, 0 if not limited
+static uint32 GetPacketRateLimit(PacketRateClass rateClass)
+{
+    if(rateClass == PACKET_RATE_NONE)
+        return 0;
+
+    return sWorld.getConfig(CONFIG_PACKET_RATE_QUERY + rateClass - PACKET_RATE_QUERY);
+}
 
 /// WorldSession constructor
 WorldSession::WorldSession(uint32 id, WorldSocket *sock, uint32 sec, uint8 expansion, time_t mute_time, LocaleConstant locale) :
 LookingForGroup_auto_join(false), LookingForGroup_auto_add(false), m_muteTime(mute_time),
 _player(NULL), m_Socket(sock),_security(sec), _accountId(id), m_expansion(expansion),
 m_sessionDbcLocale(sWorld.GetAvailableDbcLocale(locale)), m_sessionDbLocaleIndex(objmgr.GetIndexForLocale(locale)),
-_logoutTime(0), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_latency(0)
+_logoutTime(0), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_latency(0),
+m_recvPending(NULL), m_recvPendingTail(NULL), m_recvPendingCount(0), m_inPlaceQueryTokens(0), m_inPlaceQueryTime(getMSTime())
 {
+    // start with full burst allowance
+    for(int i = 0; i < MAX_PACKET_RATE_CLASS; ++i)
+        m_packetRateTokens[i] = GetPacketRateLimit(PacketRateClass(i)) * sWorld.getConfig(CONFIG_PACKET_RATE_BURST) * 1000;
+    m_inPlaceQueryTokens = m_packetRateTokens[PACKET_RATE_QUERY];
+
    if (sock)
      {
        m_Address = sock->GetRemoteAddress ();
@@ -70,10 +86,20 @@ WorldSession::~WorldSession()
     }
 
     ///- empty incoming packet queue
-    while(!_recvQueue.empty())
+    ReceivedWorldPacket* packet = m_recvPending;
+    while(packet)
+    {
+        ReceivedWorldPacket* next = packet->m_next;
+        packet->Release();
+        packet = next;
+    }
+
+    packet = _recvQueue.PopAll();
+    while(packet)
     {
-        WorldPacket *packet = _recvQueue.next();
-        delete packet;
+        ReceivedWorldPacket* next = packet->m_next;
+        packet->Release();
+        packet = next;
     }
     
     sWorld.RemoveQueuedPlayer(this);
@@ -94,7 +120,9 @@ char const* WorldSession::GetPlayerName() const
 /// Send a packet to the client
 void WorldSession::SendPacket(WorldPacket const* packet)
 {
-    if (!m_Socket)
+    // read once, thread-safe opcode handlers send from network thread while world thread can drop closed socket
+    WorldSocket* socket = m_Socket;
+    if (!socket)
         return;
     #ifdef MANGOS_DEBUG
     // Code for network use statistic
@@ -130,16 +158,126 @@ void WorldSession::SendPacket(WorldPacket const* packet)
     }
 #endif                                                  // !MANGOS_DEBUG
 
-  if (m_Socket->SendPacket (*packet) == -1)
+    if (sOpcodeProfiler.IsEnabled())
+        sOpcodeProfiler.AddSent(packet->GetOpcode(), packet->size());
+
+  if (socket->SendPacket (*packet) == -1)
     {
-      m_Socket->CloseSocket ();
+      socket->CloseSocket ();
     }
 }
 
 /// Add an incoming packet to the queue
-void WorldSession::QueuePacket(WorldPacket* new_packet)
+void WorldSession::QueuePacket(ReceivedWorldPacket* new_packet)
 {
-    _recvQueue.add(new_packet);
+    _recvQueue.Push(new_packet);
+}
+
+/// Call handler of PROCESS_THREADSAFE opcode in caller (network) thread, false if packet must be queued
+bool WorldSession::ProcessPacketInPlace(WorldPacket& packet)
+{
+    if(packet.GetOpcode() >= NUM_MSG_TYPES)
+        return false;
+
+    // session status not checked: thread-safe handlers not use player
+    OpcodeHandler const& opHandle = opcodeTable[packet.GetOpcode()];
+    if(opHandle.packetProcessing != PROCESS_THREADSAFE || opHandle.status == STATUS_NEVER)
+        return false;
+
+    // over rate queries queued to world thread, there they wait for world thread tokens
+    PacketRateClass rateClass = GetPacketRateClass(packet.GetOpcode());
+    if(uint32 rate = GetPacketRateLimit(rateClass))
+    {
+        uint32 now = getMSTime();
+        uint32 burst = sWorld.getConfig(CONFIG_PACKET_RATE_BURST) * 1000;
+        uint32 passed = std::min(burst, getMSTimeDiff(m_inPlaceQueryTime, now));
+        m_inPlaceQueryTokens = std::min(rate * burst, m_inPlaceQueryTokens + rate * passed);
+        m_inPlaceQueryTime = now;
+
+        if(m_inPlaceQueryTokens < 1000)
+            return false;
+        m_inPlaceQueryTokens -= 1000;
+    }
+
+    uint64 startTime = sOpcodeProfiler.IsEnabled() ? OpcodeProfiler::GetTimeUs() : 0;
+
+    (this->*opHandle.handler)(packet);
+
+    if(startTime)
+        sOpcodeProfiler.AddHandled(packet.GetOpcode(), startTime);
+    return true;
+}
+
+/// Opcode class for receive rate limits
+PacketRateClass WorldSession::GetPacketRateClass(uint16 opcode)
+{
+    switch(opcode)
+    {
+        case CMSG_NAME_QUERY:
+        case CMSG_PET_NAME_QUERY:
+        case CMSG_GUILD_QUERY:
+        case CMSG_ITEM_QUERY_SINGLE:
+        case CMSG_ITEM_QUERY_MULTIPLE:
+        case CMSG_PAGE_TEXT_QUERY:
+        case CMSG_QUEST_QUERY:
+        case CMSG_GAMEOBJECT_QUERY:
+        case CMSG_CREATURE_QUERY:
+        case CMSG_NPC_TEXT_QUERY:
+        case CMSG_ITEM_NAME_QUERY:
+        case CMSG_ITEM_TEXT_QUERY:
+        case CMSG_PETITION_QUERY:
+        case CMSG_ARENA_TEAM_QUERY:
+        case CMSG_QUESTGIVER_STATUS_QUERY:
+            return PACKET_RATE_QUERY;
+        case CMSG_WHO:
+        case CMSG_WHOIS:
+        case CMSG_INSPECT:
+        case CMSG_GUILD_ROSTER:
+        case CMSG_CHANNEL_LIST:
+        case CMSG_AUCTION_LIST_ITEMS:
+        case CMSG_AUCTION_LIST_OWNER_ITEMS:
+        case CMSG_AUCTION_LIST_BIDDER_ITEMS:
+            return PACKET_RATE_SEARCH;
+        case CMSG_MESSAGECHAT:
+        case CMSG_EMOTE:
+        case CMSG_TEXT_EMOTE:
+            return PACKET_RATE_CHAT;
+        default:
+            break;
+    }
+
+    if(opcode < NUM_MSG_TYPES && opcodeTable[opcode].handler == &WorldSession::HandleMovementOpcodes)
+        return PACKET_RATE_MOVEMENT;
+
+    return PACKET_RATE_NONE;
+}
+
+/// Add tokens of rate limited opcode classes for passed time, up to burst limit
+void WorldSession::UpdatePacketRateTokens(uint32 diff)
+{
+    uint32 burst = sWorld.getConfig(CONFIG_PACKET_RATE_BURST) * 1000;
+    if(diff > burst)
+        diff = burst;
+
+    for(int i = PACKET_RATE_QUERY; i < MAX_PACKET_RATE_CLASS; ++i)
+    {
+        uint32 rate = GetPacketRateLimit(PacketRateClass(i));
+        m_packetRateTokens[i] = std::min(rate * burst, m_packetRateTokens[i] + rate * diff);
+    }
+}
+
+/// Take token for handle received opcode, false if its class rate limit reached
+bool WorldSession::ConsumePacketRateToken(uint16 opcode)
+{
+    PacketRateClass rateClass = GetPacketRateClass(opcode);
+    if(!GetPacketRateLimit(rateClass))
+        return true;
+
+    if(m_packetRateTokens[rateClass] < 1000)
+        return false;
+
+    m_packetRateTokens[rateClass] -= 1000;
+    return true;
 }
 
 /// Logging helper for unexpected opcodes
@@ -152,7 +290,7 @@ void WorldSession::logUnexpectedOpcode(WorldPacket* packet, const char *reason)
 }
 
 /// Update the WorldSession (triggered by World update)
-bool WorldSession::Update(uint32 /*diff*/)
+bool WorldSession::Update(uint32 diff)
 {
   if (m_Socket)
     if (m_Socket->IsClosed ())
@@ -161,14 +299,52 @@ bool WorldSession::Update(uint32 /*diff*/)
         m_Socket = NULL;
       }
   
-    WorldPacket *packet;
-
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// \todo Is there a way to consolidate the OpcondeHandlerTable and the g_worldOpcodeNames to only maintain 1 list?
     /// answer : there is a way, but this is better, because it would use redundant RAM
-    while (!_recvQueue.empty())
+    /// all queued packets taken at once, packets received while processing wait next update
+    if (ReceivedWorldPacket* received = _recvQueue.PopAll())
+    {
+        if (m_recvPendingTail)
+            m_recvPendingTail->m_next = received;
+        else
+            m_recvPending = received;
+
+        for(; received; received = received->m_next)
+        {
+            m_recvPendingTail = received;
+            ++m_recvPendingCount;
+        }
+    }
+
+    UpdatePacketRateTokens(diff);
+
+    /// packets over class rate limit or session update budget wait next update, in receive order
+    /// searches over rate limit are dropped instead, client repeats them and they must not hold other packets
+    uint32 budget = sWorld.getConfig(CONFIG_SESSION_PACKET_BUDGET);
+    for (uint32 processed = 0; m_recvPending && (!budget || processed < budget); ++processed)
     {
-        packet = _recvQueue.next();
+        ReceivedWorldPacket* packet = m_recvPending;
+        bool dropPacket = false;
+        if (!ConsumePacketRateToken(packet->GetOpcode()))
+        {
+            if (GetPacketRateClass(packet->GetOpcode()) != PACKET_RATE_SEARCH)
+                break;
+            dropPacket = true;
+        }
+
+        m_recvPending = packet->m_next;
+        if (!m_recvPending)
+            m_recvPendingTail = NULL;
+        --m_recvPendingCount;
+
+        if (dropPacket)
+        {
+            sLog.outDebug("SESSION: account %u dropped %s (0x%.4X) over search rate limit",
+                GetAccountId(), LookupOpcodeName(packet->GetOpcode()), packet->GetOpcode());
+            packet->Release();
+            continue;
+        }
 
         /*#if 1
         sLog.outError( "MOEP: %s (0x%.4X)",
@@ -184,7 +360,10 @@ bool WorldSession::Update(uint32 /*diff*/)
         }
         else
         {
-            OpcodeHandler& opHandle = opcodeTable[packet->GetOpcode()];
+            uint16 opcode = packet->GetOpcode();
+            uint64 startTime = sOpcodeProfiler.IsEnabled() ? OpcodeProfiler::GetTimeUs() : 0;
+
+            OpcodeHandler& opHandle = opcodeTable[opcode];
             switch (opHandle.status)
             {
                 case STATUS_LOGGEDIN:
@@ -216,9 +395,22 @@ bool WorldSession::Update(uint32 /*diff*/)
                         packet->GetOpcode());
                     break;
             }
+
+            if(startTime)
+                sOpcodeProfiler.AddHandled(opcode, startTime);
         }
 
-        delete packet;
+        packet->Release();
+    }
+
+    ///- Kick flooding client, delayed packets can only grow
+    uint32 maxPending = sWorld.getConfig(CONFIG_SESSION_MAX_PENDING_PACKETS);
+    if (maxPending && m_recvPendingCount > maxPending && m_Socket && !m_Socket->IsClosed())
+    {
+        sLog.outError("SESSION: account %u (%s, player %s) kicked for packet flood: %u received packets delayed, first %s (0x%.4X)",
+            GetAccountId(), GetRemoteAddress().c_str(), GetPlayerName(), m_recvPendingCount,
+            LookupOpcodeName(m_recvPending->GetOpcode()), m_recvPending->GetOpcode());
+        KickPlayer();
     }
 
     ///- If necessary, log the player out
@@ -24,6 +24,7 @@
 #define __WORLDSESSION_H
 
 #include "Common.h"
+#include "ReceivedPacketPool.h"
 
 class MailItemsInfo;
 struct ItemPrototype;
@@ -44,6 +45,21 @@ class CharacterHandler;
 
 #define CHECK_PACKET_SIZE(P,S) if((P).size() < (S)) return SizeError((P),(S));
 
+/// Opcode classes with limited per session receive rate
+enum PacketRateClass
+{
+    PACKET_RATE_NONE        = 0,                            // not limited
+    PACKET_RATE_QUERY       = 1,                            // template, name and status queries
+    PACKET_RATE_SEARCH      = 2,                            // who, auction house lists, inspect and other server side searches
+    PACKET_RATE_CHAT        = 3,                            // chat messages and emotes
+    PACKET_RATE_MOVEMENT    = 4                             // player movement
+};
+
+#define MAX_PACKET_RATE_CLASS 5
+
+// max packets per second of class rate limit, token counts (1/1000 of packet) for max burst fit in uint32
+#define MAX_PACKET_RATE 10000
+
 enum PartyOperation
 {
     PARTY_OP_INVITE = 0,
@@ -113,8 +129,11 @@ class MANGOS_DLL_SPEC WorldSession
         void LogoutPlayer(bool Save);
         void KickPlayer();
 
-        void QueuePacket(WorldPacket* new_packet);
+        void QueuePacket(ReceivedWorldPacket* new_packet);
+        bool ProcessPacketInPlace(WorldPacket& packet);
         bool Update(uint32 diff);
+
+        static PacketRateClass GetPacketRateClass(uint16 opcode);
         
         /// Handle the authentication waiting queue (to be completed)
         void SendAuthWaitQue(uint32 position);
@@ -621,6 +640,10 @@ class MANGOS_DLL_SPEC WorldSession
         // private trade methods
         void moveItems(Item* myItems[], Item* hisItems[]);
 
+        // packet rate limits
+        void UpdatePacketRateTokens(uint32 diff);
+        bool ConsumePacketRateToken(uint16 opcode);
+
         // logging helper
         void logUnexpectedOpcode(WorldPacket *packet, const char * reason);
 
@@ -640,7 +663,14 @@ class MANGOS_DLL_SPEC WorldSession
         int m_sessionDbLocaleIndex;
         uint32 m_latency;
 
-        ZThread::LockedQueue<WorldPacket*,ZThread::FastMutex> _recvQueue;
+        ReceivedPacketQueue _recvQueue;                     // pushed by network thread, processed in Update by batches
+
+        ReceivedWorldPacket* m_recvPending;                 // taken from _recvQueue but delayed by rate limit or update budget
+        ReceivedWorldPacket* m_recvPendingTail;
+        uint32 m_recvPendingCount;
+        uint32 m_packetRateTokens[MAX_PACKET_RATE_CLASS];   // in 1/1000 of packet, world thread only
+        uint32 m_inPlaceQueryTokens;                        // for queries handled in network thread, network thread only
+        uint32 m_inPlaceQueryTime;
 };
 #endif
 /// @}
@@ -32,6 +32,7 @@
 #include "Util.h"
 #include "World.h"
 #include "WorldPacket.h"
+#include "ReceivedPacketPool.h"
 #include "SharedDefines.h"
 #include "ByteBuffer.h"
 #include "AddonHandler.h"
@@ -70,12 +71,18 @@ struct ClientPktHeader
 WorldSocket::WorldSocket (void) :
 WorldHandler (),
 m_Session (0),
+m_PacketPool (0),
+m_NetStats (0),
 m_RecvWPct (0),
 m_RecvPct (),
 m_Header (sizeof (ClientPktHeader)),
 m_OutBuffer (0),
 m_OutBufferSize (65536),
 m_OutActive (false),
+m_FlushThreshold (0),
+m_FlushMaxDelay (0),
+m_OutBufferGeneration (0),
+m_OutBufferTime (0),
 m_Seed (static_cast<uint32> (rand32 ())),
 m_OverSpeedPings (0),
 m_LastPingTime (ACE_Time_Value::zero)
@@ -86,7 +93,7 @@ m_LastPingTime (ACE_Time_Value::zero)
 WorldSocket::~WorldSocket (void)
 {
     if (m_RecvWPct)
-        delete m_RecvWPct;
+        m_RecvWPct->Release ();
 
     if (m_OutBuffer)
         m_OutBuffer->release ();
@@ -158,6 +165,13 @@ int WorldSocket::SendPacket (const WorldPacket& pct)
         sWorldLog.Log ("\n\n");
     }
 
+    // first not sent packet, flush in Update () after this tick or delay
+    if (m_OutBuffer->length () == 0 && m_PacketQueue.is_empty ())
+    {
+        m_OutBufferGeneration = sWorldSocketMgr->GetFlushGeneration ();
+        m_OutBufferTime = getMSTime ();
+    }
+
     if (iSendPacket (pct) == -1)
     {
         WorldPacket* npct;
@@ -253,6 +267,9 @@ int WorldSocket::handle_input (ACE_HANDLE)
     if (this->closing_)
         return -1;
 
+    // answers of packets handled in this thread are sent at once
+    const size_t out_len = m_OutBuffer->length ();
+
     switch (this->handle_input_missing_data ())
     {
         case -1 :
@@ -260,7 +277,7 @@ int WorldSocket::handle_input (ACE_HANDLE)
             if ((errno == EWOULDBLOCK) ||
                 (errno == EAGAIN))
             {
-                return this->Update (); // interesting line ,isnt it ?
+                return this->Update (m_OutBuffer->length () != out_len); // interesting line ,isnt it ?
             }
 
             DEBUG_LOG ("WorldSocket::handle_input: Peer error closing connection errno = %s", ACE_OS::strerror (errno));
@@ -278,7 +295,7 @@ int WorldSocket::handle_input (ACE_HANDLE)
         case 1:
             return 1;
         default:
-            return this->Update (); // another interesting line ;)
+            return this->Update (m_OutBuffer->length () != out_len); // another interesting line ;)
     }
 
     ACE_NOTREACHED(return -1);
@@ -301,6 +318,13 @@ int WorldSocket::handle_output (ACE_HANDLE)
 #else
     ssize_t n = this->peer ().send (m_OutBuffer->rd_ptr (), send_len);
 #endif // MSG_NOSIGNAL
+
+    if (m_NetStats)
+    {
+        ++m_NetStats->sendCalls;
+        if (n > 0)
+            m_NetStats->sentBytes += n;
+    }
           
     if (n == 0)
         return -1;
@@ -355,12 +379,21 @@ int WorldSocket::handle_close (ACE_HANDLE h, ACE_Reactor_Mask)
     return 0;
 }
 
-int WorldSocket::Update (void)
+int WorldSocket::Update (bool force)
 {
     if (this->closing_)
         return -1;
 
-    if (m_OutActive || m_OutBuffer->length () == 0)
+    const size_t out_len = m_OutBuffer->length ();
+
+    if (m_OutActive || out_len == 0)
+        return 0;
+
+    // coalesce packets of the world tick in one send
+    if (!force &&
+        out_len < m_FlushThreshold &&
+        m_OutBufferGeneration == sWorldSocketMgr->GetFlushGeneration () &&
+        getMSTimeDiff (m_OutBufferTime, getMSTime ()) < m_FlushMaxDelay)
         return 0;
 
     return this->handle_output (this->get_handle ());
@@ -398,7 +431,9 @@ int WorldSocket::handle_input_header (void)
 
     header.size -= 4;
 
-    ACE_NEW_RETURN (m_RecvWPct, WorldPacket ((uint16) header.cmd, header.size), -1);
+    ACE_ASSERT (m_PacketPool);
+
+    m_RecvWPct = m_PacketPool->Acquire ((uint16) header.cmd, header.size);
 
     if(header.size > 0)
     {
@@ -457,6 +492,13 @@ int WorldSocket::handle_input_missing_data (void)
     const ssize_t n = this->peer ().recv (message_block.wr_ptr (),
                                           recv_size);
 
+    if (m_NetStats)
+    {
+        ++m_NetStats->recvCalls;
+        if (n > 0)
+            m_NetStats->receivedBytes += n;
+    }
+
     if (n <= 0)
         return n;
 
@@ -564,12 +606,12 @@ int WorldSocket::schedule_wakeup_output (GuardType& g)
     return 0;
 }
 
-int WorldSocket::ProcessIncoming (WorldPacket* new_pct)
+int WorldSocket::ProcessIncoming (ReceivedWorldPacket* new_pct)
 {
     ACE_ASSERT (new_pct);
   
     // manage memory ;)
-    ACE_Auto_Ptr<WorldPacket> aptr (new_pct);
+    ReceivedPacketHolder aptr (new_pct);
 
     const ACE_UINT16 opcode = new_pct->GetOpcode ();
 
@@ -622,6 +664,10 @@ int WorldSocket::ProcessIncoming (WorldPacket* new_pct)
 
         if (m_Session != NULL)
         {
+            // thread-safe opcodes handled at once, session can't be deleted while m_SessionLock held
+            if (m_Session->ProcessPacketInPlace (*new_pct))
+                return 0;
+
             // OK ,give the packet to WorldSession
             aptr.release ();
             // WARNINIG here we call it with locks held.
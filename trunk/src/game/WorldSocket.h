@@ -46,10 +46,21 @@
 class ACE_Message_Block;
 class WorldPacket;
 class WorldSession;
+class ReceivedWorldPacket;
+class ReceivedPacketPool;
 
 /// Handler that can communicate over stream sockets.
 typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
 
+/// Socket syscall counters of one network thread, written only by that thread.
+struct WorldSocketStats
+{
+  uint64 sendCalls;
+  uint64 sentBytes;
+  uint64 recvCalls;
+  uint64 receivedBytes;
+};
+
 /**
  * WorldSocket.
  * 
@@ -64,12 +75,16 @@ typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
  * does realy a lot of small-size writes to it, and it doesn't 
  * scale well to allocate memory for every. When something is 
  * writen to the output buffer the socket is not immideately 
- * activated for output (again for the same reason), there 
- * is 10ms celling (thats why there is Update() method). 
- * This concept is simmilar to TCP_CORK, but TCP_CORK 
- * usses 200ms celling. As result overhead generated by 
- * sending packets from "producer" threads is minimal, 
- * and doing a lot of writes with small size is tollerated.
+ * activated for output (again for the same reason), packets 
+ * built in one world tick are sent with one send () after 
+ * the tick ends (see WorldSocketMgr::FlushOutput), when 
+ * Network.FlushThreshold bytes are buffered, after 
+ * Network.FlushMaxDelay ms, or at once when they answer 
+ * packets handled in the network thread (thats why there 
+ * is Update() method). This concept is simmilar to TCP_CORK. 
+ * As result overhead generated by sending packets from 
+ * "producer" threads is minimal, and doing a lot of writes 
+ * with small size is tollerated.
  * 
  * The calls to Upate () method are managed by WorldSocketMgr
  * and ReactorRunnable.
@@ -146,7 +161,8 @@ protected:
                             ACE_Reactor_Mask = ACE_Event_Handler::ALL_EVENTS_MASK);
 
   /// Called by WorldSocketMgr/ReactorRunnable.
-  int Update (void);
+  /// @param force send buffered output even if flush conditions not met
+  int Update (bool force = false);
 
 private:
   /// Helper functions for processing incoming data.
@@ -160,8 +176,8 @@ private:
   int schedule_wakeup_output (GuardType& g);
 
   /// process one incoming packet.
-  /// @param new_pct received packet ,note that you need to delete it. 
-  int ProcessIncoming (WorldPacket* new_pct);
+  /// @param new_pct received packet ,note that you need to release it. 
+  int ProcessIncoming (ReceivedWorldPacket* new_pct);
 
   /// Called by ProcessIncoming() on CMSG_AUTH_SESSION.
   int HandleAuthSession (WorldPacket& recvPacket);
@@ -198,8 +214,14 @@ private:
   /// Session to which recieved packets are routed
   WorldSession* m_Session;
 
+  /// Pool of the network thread handling this socket, set by ReactorRunnable.
+  ReceivedPacketPool* m_PacketPool;
+
+  /// Counters of the network thread handling this socket, set by ReactorRunnable.
+  WorldSocketStats* m_NetStats;
+
   /// here are stored the fragmens of the recieved data
-  WorldPacket* m_RecvWPct;
+  ReceivedWorldPacket* m_RecvWPct;
 
   /// This block actually refers to m_RecvWPct contents,
   /// which alows easy and safe writing to it. 
@@ -225,6 +247,16 @@ private:
   /// True if the socket is registered with the reactor for output
   bool m_OutActive;
 
+  /// Send buffered output before world tick end if this many bytes buffered (0 send at each Update).
+  size_t m_FlushThreshold;
+
+  /// Send buffered output before world tick end if it waits this many ms.
+  uint32 m_FlushMaxDelay;
+
+  /// World tick (WorldSocketMgr flush generation) and time in ms when output buffer got data.
+  uint32 m_OutBufferGeneration;
+  uint32 m_OutBufferTime;
+
   uint32 m_Seed;
 };
 
@@ -43,6 +43,8 @@
 #include "Config/ConfigEnv.h"
 #include "Database/DatabaseEnv.h"
 #include "WorldSocket.h"
+#include "ReceivedPacketPool.h"
+#include "Timer.h"
 
 /** 
  * This is a helper class to WorldSocketMgr ,that manages 
@@ -56,8 +58,14 @@ public:
   ReactorRunnable () :
   m_ThreadId (-1),
   m_Connections (0),
-  m_Reactor (0)
+  m_Reactor (0),
+  m_PacketPool (new ReceivedPacketPool),
+  m_LastSecondTime (getMSTime ())
   {
+    memset (&m_Stats, 0, sizeof (m_Stats));
+    memset (&m_LastSecondStats, 0, sizeof (m_LastSecondStats));
+    memset (&m_LastSecondStart, 0, sizeof (m_LastSecondStart));
+
     ACE_Reactor_Impl* imp = 0;
 
 #if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
@@ -118,6 +126,8 @@ public:
     ++m_Connections;
     sock->AddReference();
     sock->reactor (m_Reactor);
+    sock->m_PacketPool = m_PacketPool;
+    sock->m_NetStats = &m_Stats;
     m_NewSockets.insert (sock);
 
     return 0;
@@ -127,6 +137,14 @@ public:
   {
     return m_Reactor;
   }
+
+  // read by other threads, values can be not exact
+  void
+  GetStats (WorldSocketStats& total, WorldSocketStats& lastSecond)
+  {
+    total = m_Stats;
+    lastSecond = m_LastSecondStats;
+  }
   
 protected:
   
@@ -190,6 +208,8 @@ protected:
             else
               i++;
           }
+
+        UpdateLastSecondStats ();
       }
 
     WorldDatabase.ThreadEnd ();
@@ -199,6 +219,24 @@ protected:
     return 0;
   }
 
+  void
+  UpdateLastSecondStats ()
+  {
+    uint32 now = getMSTime ();
+
+    if (getMSTimeDiff (m_LastSecondTime, now) < 1000)
+      return;
+
+    m_LastSecondTime = now;
+
+    m_LastSecondStats.sendCalls = m_Stats.sendCalls - m_LastSecondStart.sendCalls;
+    m_LastSecondStats.sentBytes = m_Stats.sentBytes - m_LastSecondStart.sentBytes;
+    m_LastSecondStats.recvCalls = m_Stats.recvCalls - m_LastSecondStart.recvCalls;
+    m_LastSecondStats.receivedBytes = m_Stats.receivedBytes - m_LastSecondStart.receivedBytes;
+
+    m_LastSecondStart = m_Stats;
+  }
+
 private:
   typedef ACE_Atomic_Op<ACE_SYNCH_MUTEX, long> AtomicInt;
   typedef std::set<WorldSocket*> SocketSet;
@@ -211,6 +249,15 @@ private:
 
   SocketSet m_NewSockets;
   ACE_Thread_Mutex m_NewSockets_Lock;
+
+  // not deleted: sessions can release received packets after network stop
+  ReceivedPacketPool* m_PacketPool;
+
+  // socket syscall counters, written by this thread only
+  WorldSocketStats m_Stats;
+  WorldSocketStats m_LastSecondStats;
+  WorldSocketStats m_LastSecondStart;
+  uint32 m_LastSecondTime;
 };
 
 
@@ -221,6 +268,9 @@ m_NetThreads (0),
 m_SockOutKBuff (-1),
 m_SockOutUBuff (65536),
 m_UseNoDelay (true),
+m_FlushThreshold (8192),
+m_FlushMaxDelay (50),
+m_FlushGeneration (0),
 m_Acceptor (0) {}
 
 WorldSocketMgr::~WorldSocketMgr ()
@@ -261,6 +311,17 @@ WorldSocketMgr::StartReactiveIO (ACE_UINT16 port, const char* address)
       return -1;
     }
 
+  // 0 means send at each network thread update (every 10ms at most)
+  m_FlushThreshold = sConfig.GetIntDefault ("Network.FlushThreshold", 8192);
+
+  if (m_FlushThreshold < 0)
+    m_FlushThreshold = 0;
+
+  m_FlushMaxDelay = sConfig.GetIntDefault ("Network.FlushMaxDelay", 50);
+
+  if (m_FlushMaxDelay < 0)
+    m_FlushMaxDelay = 0;
+
   WorldSocket::Acceptor *acc = new WorldSocket::Acceptor;
   m_Acceptor = acc;
 
@@ -348,6 +409,8 @@ WorldSocketMgr::OnSocketOpen (WorldSocket* sock)
       }
   
   sock->m_OutBufferSize = static_cast<size_t> (m_SockOutUBuff);
+  sock->m_FlushThreshold = static_cast<size_t> (m_FlushThreshold);
+  sock->m_FlushMaxDelay = static_cast<uint32> (m_FlushMaxDelay);
 
   // we skip the Acceptor Thread
   size_t min = 1;
@@ -363,6 +426,16 @@ WorldSocketMgr::OnSocketOpen (WorldSocket* sock)
   return 0;
 }
 
+void
+WorldSocketMgr::GetNetThreadStats (size_t thread, long& connections, WorldSocketStats& total, WorldSocketStats& lastSecond)
+{
+  // we skip the Acceptor Thread
+  ACE_ASSERT (thread + 1 < m_NetThreadsCount);
+
+  connections = m_NetThreads[thread + 1].Connections ();
+  m_NetThreads[thread + 1].GetStats (total, lastSecond);
+}
+
 WorldSocketMgr*
 WorldSocketMgr::Instance ()
 {
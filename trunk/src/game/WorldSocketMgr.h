@@ -29,7 +29,10 @@
 #include <ace/Singleton.h>
 #include <ace/Thread_Mutex.h>
 
+#include "Common.h"
+
 class WorldSocket;
+struct WorldSocketStats;
 class ReactorRunnable;
 class ACE_Event_Handler;
 
@@ -51,6 +54,18 @@ public:
   
   /// Make this class singleton .
   static WorldSocketMgr* Instance ();
+
+  /// Called by world thread at tick end, sockets send packets built in the tick .
+  void FlushOutput () { ++m_FlushGeneration; }
+
+  /// Changed at each FlushOutput .
+  uint32 GetFlushGeneration () const { return m_FlushGeneration; }
+
+  /// Number of network threads handling sockets (acceptor thread not counted) .
+  size_t GetNetThreadsCount () const { return m_NetThreadsCount ? m_NetThreadsCount - 1 : 0; }
+
+  /// Connections, totals and last second socket syscall counters of network thread .
+  void GetNetThreadStats (size_t thread, long& connections, WorldSocketStats& total, WorldSocketStats& lastSecond);
   
 private:
   int OnSocketOpen(WorldSocket* sock);
@@ -67,6 +82,10 @@ private:
   int m_SockOutKBuff;
   int m_SockOutUBuff;
   bool m_UseNoDelay;
+  int m_FlushThreshold;
+  int m_FlushMaxDelay;
+
+  volatile uint32 m_FlushGeneration;
   
   ACE_Event_Handler* m_Acceptor;
 };
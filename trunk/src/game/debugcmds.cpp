@@ -30,6 +30,7 @@
 #include "GossipDef.h"
 #include "Language.h"
 #include "MapManager.h"
+#include "SpellMgr.h"
 #include <fstream>
 
 bool ChatHandler::HandleDebugInArcCommand(const char* /*args*/)
@@ -272,6 +273,115 @@ bool ChatHandler::HandleGetLootRecipient(const char* args)
     return true;
 }
 
+bool ChatHandler::HandleDebugLoSCacheCommand(const char* /*args*/)
+{
+    Map const* map = m_session->GetPlayer()->GetMap();
+    LineOfSightCache const& cache = map->GetLineOfSightCache();
+
+    if(!cache.IsEnabled())
+    {
+        SendSysMessage("LoS cache is disabled.");
+        return true;
+    }
+
+    uint64 hits = cache.GetHits();
+    uint64 total = hits + cache.GetMisses();
+    PSendSysMessage("LoS cache for map %u instance %u: %u/%u entries used", map->GetId(), m_session->GetPlayer()->GetInstanceId(), cache.GetUsedCount(), cache.GetSize());
+    PSendSysMessage("Lookups: " I64FMTD " hits: " I64FMTD " (%.1f%%)", total, hits, total ? float(hits) * 100.0f / float(total) : 0.0f);
+    return true;
+}
+
+bool ChatHandler::HandleDebugStatUpdatesCommand(const char* /*args*/)
+{
+    uint64 requests = Unit::GetStatUpdateRequestCount();
+    uint64 updates = Unit::GetStatUpdateCount();
+    uint64 avoided = requests > updates ? requests - updates : 0;
+    PSendSysMessage("Stat recalculations requested: " I64FMTD " done: " I64FMTD, requests, updates);
+    PSendSysMessage("Avoided by deferred stat updates: " I64FMTD " (%.1f%%)", avoided, requests ? float(avoided) * 100.0f / float(requests) : 0.0f);
+    return true;
+}
+
+// one spell per class, cast in turn by the simulated raid members
+static uint32 const auraBenchRotation[] = { 133, 686, 116, 585, 403, 5176, 3044, 1752, 78, 635 };
+#define AURA_BENCH_RAID_SIZE 25
+#define AURA_BENCH_MAX_ROTATIONS 10000
+
+static void RunAuraBenchRotations(Player* caster, Unit* target, uint32 rotations)
+{
+    uint32 count = sizeof(auraBenchRotation)/sizeof(auraBenchRotation[0]);
+    for(uint32 r = 0; r < rotations; ++r)
+    {
+        for(uint32 member = 0; member < AURA_BENCH_RAID_SIZE; ++member)
+        {
+            SpellEntry const* spellInfo = sSpellStore.LookupEntry(auraBenchRotation[(r + member) % count]);
+            if(!spellInfo)
+                continue;
+
+            uint32 damage = 1000;
+            switch(spellInfo->DmgClass)
+            {
+                case SPELL_DAMAGE_CLASS_MELEE:
+                    caster->MeleeDamageBonus(target, &damage, BASE_ATTACK, spellInfo);
+                    damage += uint32(caster->GetUnitCriticalChance(BASE_ATTACK, target));
+                    break;
+                case SPELL_DAMAGE_CLASS_RANGED:
+                    caster->MeleeDamageBonus(target, &damage, RANGED_ATTACK, spellInfo);
+                    damage += uint32(caster->GetUnitCriticalChance(RANGED_ATTACK, target));
+                    break;
+                default:
+                    if(IsPositiveSpell(spellInfo->Id))
+                        damage = caster->SpellHealingBonus(spellInfo, damage, SPELL_DIRECT_DAMAGE, caster);
+                    else
+                        damage = caster->SpellDamageBonus(target, spellInfo, damage, SPELL_DIRECT_DAMAGE);
+                    if(caster->isSpellCrit(target, spellInfo, GetSpellSchoolMask(spellInfo), BASE_ATTACK))
+                        damage = caster->SpellCriticalBonus(spellInfo, damage, target);
+                    break;
+            }
+        }
+    }
+}
+
+bool ChatHandler::HandleDebugAuraBenchCommand(const char* args)
+{
+    Unit* target = getSelectedUnit();
+    if(!target)
+    {
+        SendSysMessage(LANG_SELECT_CHAR_OR_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    uint32 rotations = *args ? atoi((char*)args) : 1000;
+    if(!rotations)
+        rotations = 1000;
+    // run in world thread, limit stall of all players
+    if(rotations > AURA_BENCH_MAX_ROTATIONS)
+        rotations = AURA_BENCH_MAX_ROTATIONS;
+
+    // damage formulas of a raid hitting the selected target, with own auras of caster and target,
+    // spell mod charges used by formulas restored after each run, so caster's real casts not affected
+    Player* caster = m_session->GetPlayer();
+    SpellModChargesBackup charges;
+    caster->SaveSpellModCharges(charges);
+
+    AuraModifierCache::SetEnabled(false);
+    uint32 start = getMSTime();
+    RunAuraBenchRotations(caster, target, rotations);
+    uint32 uncachedTime = getMSTimeDiff(start, getMSTime());
+    caster->RestoreSpellModCharges(charges);
+
+    AuraModifierCache::SetEnabled(true);
+    start = getMSTime();
+    RunAuraBenchRotations(caster, target, rotations);
+    uint32 cachedTime = getMSTimeDiff(start, getMSTime());
+    caster->RestoreSpellModCharges(charges);
+
+    PSendSysMessage("%u rotations of %u raid members against %s (%u auras), caster has %u auras",
+        rotations, AURA_BENCH_RAID_SIZE, target->GetName(), uint32(target->GetAuras().size()), uint32(caster->GetAuras().size()));
+    PSendSysMessage("Uncached aura totals: %u ms, cached aura totals: %u ms", uncachedTime, cachedTime);
+    return true;
+}
+
 bool ChatHandler::HandleSendQuestInvalidMsgCommand(const char* args)
 {
     uint32 msg = atol((char*)args);
@@ -28,16 +28,24 @@
 #include "RealmList.h"
 #include "AuthSocket.h"
 #include "AuthCodes.h"
+#include "AuthWorkerPool.h"
+#include "zthread/Thread.h"
+#include "zthread/Guard.h"
 #include <openssl/md5.h>
 #include "Auth/Sha1.h"
 //#include "Util.h" -- for commented utf8ToUpperOnlyLatin
 
 extern RealmList m_realmList;
+extern AuthWorkerPool m_authWorkerPool;
 
 extern DatabaseType dbRealmServer;
 
 #define ChunkSize 2048
 
+// input buffer must hold largest command (challenge with account name), output one several patch chunks
+#define AUTH_IN_BUFFER_SIZE  4096
+#define AUTH_OUT_BUFFER_SIZE (8*ChunkSize)
+
 enum eAuthCmd
 {
     //AUTH_NO_CMD                 = 0xFF,
@@ -166,6 +174,7 @@ class PatcherRunnable: public ZThread::Runnable
 {
     public:
         PatcherRunnable(class AuthSocket *);
+        ~PatcherRunnable();
         void run();
 
     private:
@@ -210,11 +219,15 @@ const AuthHandler table[] =
 Patcher PatchesCache;
 
 /// Constructor - set the N and g values for SRP6
-AuthSocket::AuthSocket(ISocketHandler &h) : TcpSocket(h)
+AuthSocket::AuthSocket() : m_port(0), m_inBuffer(AUTH_IN_BUFFER_SIZE), m_outBuffer(AUTH_OUT_BUFFER_SIZE),
+m_outActive(false), m_closeAfterSend(false)
 {
+    reference_counting_policy().value(ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
+
     N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
     g.SetDword(7);
     _authed = false;
+    _accountId = 0;
     pPatch=NULL;
 
     _accountSecurityLevel = SEC_PLAYER;
@@ -225,37 +238,223 @@ AuthSocket::~AuthSocket()
 {
     if(pPatch)
         fclose(pPatch);
+
+    closing_ = true;
+    peer().close();
 }
 
 /// Accept the connection and set the s random value for SRP6
-void AuthSocket::OnAccept()
+int AuthSocket::open(void*)
 {
+    ACE_INET_Addr remote_addr;
+    if(peer().get_remote_addr(remote_addr) == -1)
+    {
+        sLog.outError("AuthSocket::open: peer().get_remote_addr errno = %s", ACE_OS::strerror(errno));
+        return -1;
+    }
+
+    m_address = remote_addr.get_host_addr();
+    m_port = remote_addr.get_port_number();
+
     sLog.outBasic("Accepting connection from '%s:%d'",
         GetRemoteAddress().c_str(), GetRemotePort());
 
     s.SetRand(s_BYTE_SIZE * 8);
+
+    if(reactor()->register_handler(this, ACE_Event_Handler::READ_MASK) == -1)
+    {
+        sLog.outError("AuthSocket::open: unable to register client handler errno = %s", ACE_OS::strerror(errno));
+        return -1;
+    }
+
+    // reactor takes care of the socket from now on
+    remove_reference();
+    return 0;
+}
+
+/// Read data from the client and pass socket to worker thread for handle it
+int AuthSocket::handle_input(ACE_HANDLE)
+{
+    if(closing_)
+        return -1;
+
+    m_inBuffer.crunch();
+    if(m_inBuffer.space() == 0)
+    {
+        sLog.outError("AuthSocket::handle_input: client '%s' sent too long or unknown command", GetRemoteAddress().c_str());
+        return -1;
+    }
+
+    ssize_t n = peer().recv(m_inBuffer.wr_ptr(), m_inBuffer.space());
+    if(n == 0)
+        return -1;                                          // peer closed connection
+    if(n < 0)
+        return (errno == EWOULDBLOCK || errno == EAGAIN) ? 0 : -1;
+
+    m_inBuffer.wr_ptr(n);
+
+    // stop reading until worker handle received commands, worker enable it again
+    if(reactor()->cancel_wakeup(this, ACE_Event_Handler::READ_MASK) == -1)
+        return -1;
+
+    return m_authWorkerPool.Queue(this);
+}
+
+/// Send queued data, close connection if requested and all data sent
+int AuthSocket::handle_output(ACE_HANDLE)
+{
+    GuardType guard(m_outBufferLock);
+
+    if(closing_)
+        return -1;
+
+    size_t send_len = m_outBuffer.length();
+    if(send_len == 0)
+        return m_closeAfterSend ? -1 : cancel_wakeup_output(guard);
+
+#ifdef MSG_NOSIGNAL
+    ssize_t n = peer().send(m_outBuffer.rd_ptr(), send_len, MSG_NOSIGNAL);
+#else
+    ssize_t n = peer().send(m_outBuffer.rd_ptr(), send_len);
+#endif
+
+    if(n == 0)
+        return -1;
+    if(n < 0)
+        return (errno == EWOULDBLOCK || errno == EAGAIN) ? 0 : -1;
+
+    m_outBuffer.rd_ptr(n);
+    m_outBuffer.crunch();
+
+    if(m_outBuffer.length() == 0 && m_closeAfterSend)
+        return -1;
+
+    return 0;
+}
+
+int AuthSocket::handle_close(ACE_HANDLE, ACE_Reactor_Mask)
+{
+    {
+        GuardType guard(m_outBufferLock);
+
+        closing_ = true;
+    }
+
+    // closed by one event handler, remove other still registered events too
+    reactor()->remove_handler(this, ACE_Event_Handler::ALL_EVENTS_MASK | ACE_Event_Handler::DONT_CALL);
+    return 0;
+}
+
+int AuthSocket::cancel_wakeup_output(GuardType& g)
+{
+    if(!m_outActive)
+        return 0;
+
+    m_outActive = false;
+
+    g.release();
+
+    if(reactor()->cancel_wakeup(this, ACE_Event_Handler::WRITE_MASK) == -1)
+    {
+        sLog.outError("AuthSocket::cancel_wakeup_output");
+        return -1;
+    }
+    return 0;
+}
+
+int AuthSocket::schedule_wakeup_output(GuardType& g)
+{
+    if(m_outActive)
+        return 0;
+
+    m_outActive = true;
+
+    g.release();
+
+    if(reactor()->schedule_wakeup(this, ACE_Event_Handler::WRITE_MASK) == -1)
+    {
+        sLog.outError("AuthSocket::schedule_wakeup_output");
+        return -1;
+    }
+    return 0;
+}
+
+bool AuthSocket::Recv(char* buf, size_t len)
+{
+    if(!RecvSoft(buf, len))
+        return false;
+
+    m_inBuffer.rd_ptr(len);
+    return true;
+}
+
+bool AuthSocket::RecvSoft(char* buf, size_t len)
+{
+    if(m_inBuffer.length() < len)
+        return false;
+
+    memcpy(buf, m_inBuffer.rd_ptr(), len);
+    return true;
+}
+
+void AuthSocket::RecvSkip(size_t len)
+{
+    m_inBuffer.rd_ptr(std::min(len, m_inBuffer.length()));
+}
+
+bool AuthSocket::SendBuf(const char* buf, size_t len)
+{
+    GuardType guard(m_outBufferLock);
+
+    if(closing_)
+        return false;
+
+    m_outBuffer.crunch();
+    if(m_outBuffer.space() < len)
+    {
+        sLog.outError("AuthSocket::SendBuf: output buffer overflow for '%s', closing connection", GetRemoteAddress().c_str());
+        closing_ = true;
+        peer().close_writer();
+        return false;
+    }
+
+    m_outBuffer.copy(buf, len);
+
+    return schedule_wakeup_output(guard) != -1;
+}
+
+/// Closed or closing after send, flags changed by reactor and worker threads under m_outBufferLock
+bool AuthSocket::IsClosed() const
+{
+    GuardType guard(m_outBufferLock);
+    return closing_ || m_closeAfterSend;
+}
+
+void AuthSocket::CloseSocket()
+{
+    GuardType guard(m_outBufferLock);
+
+    if(closing_ || m_closeAfterSend)
+        return;
+
+    m_closeAfterSend = true;
+
+    // handle_output close connection after all data sent
+    m_outActive = false;
+    schedule_wakeup_output(guard);
 }
 
 /// Read the packet from the client
 void AuthSocket::OnRead()
 {
-    ///- Read the packet
-    TcpSocket::OnRead();
     uint8 _cmd;
     while (1)
     {
-        if (!ibuf.GetLength())
+        if (!RecvLength())
             return;
 
         ///- Get the command out of it
-        ibuf.SoftRead((char *)&_cmd, 1);                    // UQ1: No longer exists in new net code ???
-        //ibuf.Read((char *)&_cmd, 1);
-        /*char *command = (char *)malloc(1);
-
-        ibuf.Read(command, 1);
-
-        _cmd = (uint8)command;*/
-        //      assert(0);
+        RecvSoft((char *)&_cmd, 1);
         size_t i;
 
         ///- Circle through known commands and call the correct command handler
@@ -265,11 +464,11 @@ void AuthSocket::OnRead()
                 (table[i].status == STATUS_CONNECTED ||
                 (_authed && table[i].status == STATUS_AUTHED)))
             {
-                DEBUG_LOG("[Auth] got data for cmd %u ibuf length %u", (uint32)_cmd, ibuf.GetLength());
+                DEBUG_LOG("[Auth] got data for cmd %u recv length %u", (uint32)_cmd, RecvLength());
 
                 if (!(*this.*table[i].handler)())
                 {
-                    DEBUG_LOG("Command handler failed for cmd %u ibuf length %u", (uint32)_cmd, ibuf.GetLength());
+                    DEBUG_LOG("Command handler failed for cmd %u recv length %u", (uint32)_cmd, RecvLength());
                     return;
                 }
                 break;
@@ -319,22 +518,28 @@ void AuthSocket::_SetVSFields(std::string rI)
 bool AuthSocket::_HandleLogonChallenge()
 {
     DEBUG_LOG("Entering _HandleLogonChallenge");
-    if (ibuf.GetLength() < sizeof(sAuthLogonChallenge_C))
+    if (RecvLength() < sizeof(sAuthLogonChallenge_C))
         return false;
 
-    ///- Read the first 4 bytes (header) to get the length of the remaining of the packet
+    ///- Peek the first 4 bytes (header) to get the length of the remaining of the packet
     std::vector<uint8> buf;
     buf.resize(4);
 
-    ibuf.Read((char *)&buf[0], 4);
+    RecvSoft((char *)&buf[0], 4);
 
     EndianConvert(*((uint16*)(buf[0])));
     uint16 remaining = ((sAuthLogonChallenge_C *)&buf[0])->size;
     DEBUG_LOG("[AuthChallenge] got header, body is %#04x bytes", remaining);
 
-    if ((remaining < sizeof(sAuthLogonChallenge_C) - buf.size()) || (ibuf.GetLength() < remaining))
+    if (remaining < sizeof(sAuthLogonChallenge_C) - buf.size())
         return false;
 
+    ///- Wait for the full packet before consume the header
+    if (RecvLength() < buf.size() + remaining)
+        return false;
+
+    RecvSkip(buf.size());
+
     //No big fear of memory outage (size is int16, i.e. < 65536)
     buf.resize(remaining + buf.size() + 1);
     buf[buf.size() - 1] = 0;
@@ -351,7 +556,7 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->ip);
 
     ///- Read the remaining of the packet
-    ibuf.Read((char *)&buf[4], remaining);
+    Recv((char *)&buf[4], remaining);
     DEBUG_LOG("[AuthChallenge] got full packet, %#04x bytes", ch->size);
     DEBUG_LOG("[AuthChallenge] name(%d): '%s'", ch->I_len, ch->I);
 
@@ -450,8 +655,9 @@ bool AuthSocket::_HandleLogonChallenge()
                     else
                     {
                         ///- Get the password from the account table, upper it, and make the SRP6 calculation
-                        std::string rI = (*result)[0].GetCppString();
-                        _SetVSFields(rI);
+                        _shaPassHash = (*result)[0].GetCppString();
+                        _accountId = (*result)[1].GetUInt32();
+                        _SetVSFields(_shaPassHash);
 
                         b.SetRand(19 * 8);
                         BigNumber gmod=g.ModExp(b, N);
@@ -553,11 +759,11 @@ bool AuthSocket::_HandleLogonProof()
 {
     DEBUG_LOG("Entering _HandleLogonProof");
     ///- Read the packet
-    if (ibuf.GetLength() < sizeof(sAuthLogonProof_C))
+    if (RecvLength() < sizeof(sAuthLogonProof_C))
         return false;
 
     sAuthLogonProof_C lp;
-    ibuf.Read((char *)&lp, sizeof(sAuthLogonProof_C));
+    Recv((char *)&lp, sizeof(sAuthLogonProof_C));
 
     ///- Continue the SRP6 calculation based on data received from the client
     BigNumber A;
@@ -654,6 +860,9 @@ bool AuthSocket::_HandleLogonProof()
 
         SendBuf((char *)&proof, sizeof(proof));
 
+        ///- Refresh cached amounts of characters for realm list requests
+        m_realmList.LoadAccountCharacters(_accountId);
+
         ///- Set _authed to true!
         _authed = true;
     }
@@ -708,63 +917,22 @@ bool AuthSocket::_HandleLogonProof()
 bool AuthSocket::_HandleRealmList()
 {
     DEBUG_LOG("Entering _HandleRealmList");
-    if (ibuf.GetLength() < 5)
+    if (RecvLength() < 5)
         return false;
 
-    ibuf.Remove(5);
+    RecvSkip(5);
 
-    ///- Get the user id (else close the connection)
-    // No SQL injection (escaped user name)
-
-    QueryResult *result = dbRealmServer.PQuery("SELECT id,sha_pass_hash FROM account WHERE username = '%s'",_safelogin.c_str());
-    if(!result)
-    {
-        sLog.outError("[ERROR] user %s tried to login and we cannot find him in the database.",_login.c_str());
-        SetCloseAndDelete();
-        return false;
-    }
-
-    uint32 id = (*result)[0].GetUInt32();
-    std::string rI = (*result)[1].GetCppString();
-    delete result;
-
-    ///- Update realm list if need
-    m_realmList.UpdateIfNeed();
-
-    ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
+    ///- Fill prebuilt realm list for the account, characters normally cached at logon proof
     ByteBuffer pkt;
-    pkt << (uint32) 0;
-    pkt << (uint16) m_realmList.size();
-    RealmList::RealmMap::const_iterator i;
-    for( i = m_realmList.begin(); i != m_realmList.end(); i++ )
+    if(!m_realmList.BuildRealmListPacket(pkt, _accountId, _accountSecurityLevel))
     {
-        uint8 AmountOfCharacters;
-
-        // No SQL injection. id of realm is controlled by the database.
-        result = dbRealmServer.PQuery( "SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'",i->second.m_ID,id);
-        if( result )
+        m_realmList.LoadAccountCharacters(_accountId);
+        if(!m_realmList.BuildRealmListPacket(pkt, _accountId, _accountSecurityLevel))
         {
-            Field *fields = result->Fetch();
-            AmountOfCharacters = fields[0].GetUInt8();
-            delete result;
+            CloseSocket();
+            return false;
         }
-        else
-            AmountOfCharacters = 0;
-
-        uint8 lock = (i->second.allowedSecurityLevel > _accountSecurityLevel) ? 1 : 0;
-
-        pkt << i->second.icon;                             // realm type
-        pkt << lock;                                       // if 1, then realm locked
-        pkt << i->second.color;                            // if 2, then realm is offline
-        pkt << i->first;
-        pkt << i->second.address;
-        pkt << i->second.populationLevel;
-        pkt << AmountOfCharacters;
-        pkt << i->second.timezone;                          // realm category
-        pkt << (uint8) 0x2C;                                // unk, may be realm number/id?
     }
-    pkt << (uint8) 0x10;
-    pkt << (uint8) 0x00;
 
     ByteBuffer hdr;
     hdr << (uint8) REALM_LIST;
@@ -774,7 +942,7 @@ bool AuthSocket::_HandleRealmList()
     SendBuf((char const*)hdr.contents(), hdr.size());
 
     // Set check field before possible relogin to realm
-    _SetVSFields(rI);
+    _SetVSFields(_shaPassHash);
     return true;
 }
 
@@ -783,7 +951,7 @@ bool AuthSocket::_HandleXferResume()
 {
     DEBUG_LOG("Entering _HandleXferResume");
     ///- Check packet length and patch existence
-    if (ibuf.GetLength()<9 || !pPatch)
+    if (RecvLength()<9 || !pPatch)
     {
         sLog.outError("Error while resuming patch transfer (wrong packet)");
         return false;
@@ -791,8 +959,8 @@ bool AuthSocket::_HandleXferResume()
 
     ///- Launch a PatcherRunnable thread starting at given patch file offset
     uint64 start;
-    ibuf.Remove(1);
-    ibuf.Read((char*)&start,sizeof(start));
+    RecvSkip(1);
+    Recv((char*)&start,sizeof(start));
     fseek(pPatch,start,0);
 
     ZThread::Thread u(new PatcherRunnable(this));
@@ -805,10 +973,10 @@ bool AuthSocket::_HandleXferCancel()
     DEBUG_LOG("Entering _HandleXferCancel");
 
     ///- Close and delete the socket
-    ibuf.Remove(1);                                         //clear input buffer
+    RecvSkip(1);                                            //clear input buffer
 
     //ZThread::Thread::sleep(15);
-    SetCloseAndDelete();
+    CloseSocket();
 
     return true;
 }
@@ -826,7 +994,7 @@ bool AuthSocket::_HandleXferAccept()
     }
 
     ///- Launch a PatcherRunnable thread, starting at the begining of the patch file
-    ibuf.Remove(1);                                         //clear input buffer
+    RecvSkip(1);                                            //clear input buffer
     fseek(pPatch,0,0);
 
     ZThread::Thread u(new PatcherRunnable(this));
@@ -837,12 +1005,20 @@ bool AuthSocket::_HandleXferAccept()
 /// Check if there is lag on the connection to the client
 bool AuthSocket::IsLag()
 {
-    return (TCP_BUFSIZE_READ-GetOutputLength()< 2*ChunkSize);
+    GuardType guard(m_outBufferLock);
+
+    return m_outBuffer.size() - m_outBuffer.length() < 2*ChunkSize;
 }
 
 PatcherRunnable::PatcherRunnable(class AuthSocket * as)
 {
     mySocket=as;
+    mySocket->add_reference();                              // socket kept while patch sent
+}
+
+PatcherRunnable::~PatcherRunnable()
+{
+    mySocket->remove_reference();
 }
 
 /// Send content of patch file to the client
@@ -851,10 +1027,10 @@ void PatcherRunnable::run()
     XFER_DATA_STRUCT xfdata;
     xfdata.opcode = XFER_DATA;
 
-    while(!feof(mySocket->pPatch) && mySocket->Ready())
+    while(!feof(mySocket->pPatch) && !mySocket->IsClosed())
     {
         ///- Wait until output buffer is reasonably empty
-        while(mySocket->Ready() && mySocket->IsLag())
+        while(!mySocket->IsClosed() && mySocket->IsLag())
         {
             ZThread::Thread::sleep(1);
         }
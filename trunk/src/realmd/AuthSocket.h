@@ -23,25 +23,46 @@
 #ifndef _AUTHSOCKET_H
 #define _AUTHSOCKET_H
 
+#include <ace/Synch_Traits.h>
+#include <ace/Svc_Handler.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/SOCK_Acceptor.h>
+#include <ace/Acceptor.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Guard_T.h>
+#include <ace/Message_Block.h>
+
 #include "Common.h"
 #include "Auth/BigNumber.h"
-#include "sockets/TcpSocket.h"
-#include "sockets/SocketHandler.h"
-#include "sockets/ListenSocket.h"
-#include "sockets/Utility.h"
-#include "sockets/Parse.h"
-#include "sockets/Socket.h"
-
-/// Handle login commands
-class AuthSocket: public TcpSocket
+
+typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> AuthSocketHandler;
+
+/**
+ * Handle login commands
+ *
+ * Socket I/O is done by reactor thread, received commands are handled by AuthWorkerPool thread
+ * (SRP6 math and account queries). Reading is disabled while commands are handled, so input
+ * buffer is used by one thread at time. Output buffer is locked, can be filled from any thread.
+ */
+class AuthSocket: public AuthSocketHandler
 {
     public:
+        typedef ACE_Acceptor<AuthSocket, ACE_SOCK_ACCEPTOR> Acceptor;
+        typedef ACE_Thread_Mutex LockType;
+        typedef ACE_Guard<LockType> GuardType;
+
         const static int s_BYTE_SIZE = 32;
 
-        AuthSocket(ISocketHandler& h);
-        ~AuthSocket();
+        AuthSocket();
+        virtual ~AuthSocket();
+
+        /// things called by ACE framework
+        virtual int open(void*);
+        virtual int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE);
+        virtual int handle_output(ACE_HANDLE = ACE_INVALID_HANDLE);
+        virtual int handle_close(ACE_HANDLE = ACE_INVALID_HANDLE, ACE_Reactor_Mask = ACE_Event_Handler::ALL_EVENTS_MASK);
 
-        void OnAccept();
+        /// Handle received commands, called by AuthWorkerPool thread
         void OnRead();
 
         bool _HandleLogonChallenge();
@@ -58,7 +79,26 @@ class AuthSocket: public TcpSocket
         FILE *pPatch;
         bool IsLag();
 
+        /// received data access, only from thread handling commands
+        size_t RecvLength() const { return m_inBuffer.length(); }
+        bool Recv(char* buf, size_t len);
+        bool RecvSoft(char* buf, size_t len);
+        void RecvSkip(size_t len);
+
+        /// queue data to send, can be called from any thread
+        bool SendBuf(const char* buf, size_t len);
+
+        /// close connection after queued data sent
+        void CloseSocket();
+        bool IsClosed() const;
+
+        const std::string& GetRemoteAddress() const { return m_address; }
+        uint16 GetRemotePort() const { return m_port; }
+
     private:
+        /// Mark/unmark socket for output, release the guard for m_outBufferLock
+        int cancel_wakeup_output(GuardType& g);
+        int schedule_wakeup_output(GuardType& g);
 
         BigNumber N, s, g, v;
         BigNumber b, B;
@@ -68,8 +108,19 @@ class AuthSocket: public TcpSocket
 
         std::string _login;
         std::string _safelogin;
+        uint32 _accountId;
+        std::string _shaPassHash;
         uint8 _localization;
         AccountTypes _accountSecurityLevel;
+
+        std::string m_address;
+        uint16 m_port;
+
+        ACE_Message_Block m_inBuffer;
+        ACE_Message_Block m_outBuffer;
+        mutable LockType m_outBufferLock;
+        bool m_outActive;
+        bool m_closeAfterSend;
 };
 #endif
 /// @}
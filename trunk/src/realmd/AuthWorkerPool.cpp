@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "AuthWorkerPool.h"
+#include "AuthSocket.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+
+#include <ace/Reactor.h>
+
+extern DatabaseType dbRealmServer;
+
+int AuthWorkerPool::Start(int threads)
+{
+    return activate(THR_NEW_LWP | THR_JOINABLE, threads);
+}
+
+void AuthWorkerPool::Stop()
+{
+    // wake up waiting threads, queued sockets are dropped
+    msg_queue()->deactivate();
+    wait();
+
+    ACE_Message_Block* mb;
+    ACE_Time_Value noWait = ACE_Time_Value::zero;
+    msg_queue()->activate();
+    while(getq(mb, &noWait) != -1)
+    {
+        reinterpret_cast<AuthSocket*>(mb->base())->remove_reference();
+        mb->release();
+    }
+}
+
+int AuthWorkerPool::Queue(AuthSocket* sock)
+{
+    // block refers to socket, not owns it; reference held until handled
+    sock->add_reference();
+
+    ACE_Message_Block* mb = new ACE_Message_Block(reinterpret_cast<char*>(sock), sizeof(AuthSocket*));
+    if(putq(mb) == -1)
+    {
+        mb->release();
+        sock->remove_reference();
+        return -1;
+    }
+    return 0;
+}
+
+int AuthWorkerPool::svc()
+{
+    DEBUG_LOG("Auth worker thread starting");
+
+    dbRealmServer.ThreadStart();
+
+    ACE_Message_Block* mb;
+    while(getq(mb) != -1)
+    {
+        AuthSocket* sock = reinterpret_cast<AuthSocket*>(mb->base());
+        mb->release();
+
+        if(!sock->IsClosed())
+        {
+            sock->OnRead();
+
+            // continue reading, closed socket already removed from reactor
+            if(!sock->IsClosed())
+                sock->reactor()->schedule_wakeup(sock, ACE_Event_Handler::READ_MASK);
+        }
+
+        sock->remove_reference();
+    }
+
+    dbRealmServer.ThreadEnd();
+
+    DEBUG_LOG("Auth worker thread exiting");
+    return 0;
+}
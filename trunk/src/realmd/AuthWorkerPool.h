@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef _AUTHWORKERPOOL_H
+#define _AUTHWORKERPOOL_H
+
+#include <ace/Task.h>
+
+#include "Common.h"
+
+class AuthSocket;
+
+/// Threads handling received login commands (SRP6 math and account database queries) out of reactor thread
+class AuthWorkerPool : protected ACE_Task<ACE_MT_SYNCH>
+{
+    public:
+        AuthWorkerPool() {}
+
+        int Start(int threads);
+        void Stop();
+
+        /// Handle received data of socket in worker thread, socket reading must be disabled until handled
+        int Queue(AuthSocket* sock);
+
+    protected:
+        virtual int svc();
+};
+#endif
+/// @}
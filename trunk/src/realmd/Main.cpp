@@ -26,11 +26,17 @@
 
 #include "Config/ConfigEnv.h"
 #include "Log.h"
-#include "sockets/ListenSocket.h"
 #include "AuthSocket.h"
+#include "AuthWorkerPool.h"
 #include "SystemConfig.h"
 #include "Util.h"
 
+#include <ace/ACE.h>
+#include <ace/Reactor.h>
+#include <ace/Reactor_Impl.h>
+#include <ace/TP_Reactor.h>
+#include <ace/Dev_Poll_Reactor.h>
+
 #ifdef WIN32
 #include "ServiceWin32.h"
 char serviceName[] = "realmd";
@@ -51,6 +57,7 @@ void HookSignals();
 
 bool stopEvent = false;                                     ///< Setting it to true stops the server
 RealmList m_realmList;                                      ///< Holds the list of realms for this server
+AuthWorkerPool m_authWorkerPool;                            ///< Threads handling client commands
 
 DatabaseType dbRealmServer;                                 ///< Accessor to the realm server database
 
@@ -180,18 +187,41 @@ extern int main(int argc, char **argv)
     }
 
     ///- Launch the listening network socket
-    port_t rmport = sConfig.GetIntDefault( "RealmServerPort", DEFAULT_REALMSERVER_PORT );
+    uint16 rmport = sConfig.GetIntDefault( "RealmServerPort", DEFAULT_REALMSERVER_PORT );
     std::string bind_ip = sConfig.GetStringDefault("BindIP", "0.0.0.0");
 
-    SocketHandler h;
-    ListenSocket<AuthSocket> authListenSocket(h);
-    if ( authListenSocket.Bind(bind_ip.c_str(),rmport))
+    ///- Allow as many client connections as system permits
+    ACE::set_handle_limit(-1);
+
+    ///- Use epoll (or /dev/poll) reactor if available, one thread dispatch all socket events
+    ACE_Reactor_Impl* reactorImpl;
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+    reactorImpl = new ACE_Dev_Poll_Reactor();
+    reactorImpl->restart(1);
+#else
+    reactorImpl = new ACE_TP_Reactor();
+#endif
+    reactorImpl->max_notify_iterations(128);
+    ACE_Reactor reactor(reactorImpl, 1);
+
+    AuthSocket::Acceptor authAcceptor;
+    ACE_INET_Addr bind_addr(rmport, bind_ip.c_str());
+    if (authAcceptor.open(bind_addr, &reactor, ACE_NONBLOCK) == -1)
     {
         sLog.outError( "MaNGOS realmd can not bind to %s:%d",bind_ip.c_str(), rmport );
         return 1;
     }
 
-    h.Add(&authListenSocket);
+    ///- Start threads handling client commands (SRP6 calculations and database queries)
+    int workerThreads = sConfig.GetIntDefault("AuthWorkerThreads", 2);
+    if (workerThreads < 1)
+        workerThreads = 1;
+
+    if (m_authWorkerPool.Start(workerThreads) == -1)
+    {
+        sLog.outError("MaNGOS realmd can not start %d auth worker threads", workerThreads);
+        return 1;
+    }
 
     ///- Catch termination signals
     HookSignals();
@@ -246,8 +276,11 @@ extern int main(int argc, char **argv)
     ///- Wait for termination signal
     while (!stopEvent)
     {
+        ACE_Time_Value interval(0, 100000);
+        reactor.handle_events(interval);
 
-        h.Select(0, 100000);
+        ///- Refresh realms and prebuilt realm list out of auth worker threads
+        m_realmList.UpdateIfNeed();
 
         if( (++loopCounter) == numLoops )
         {
@@ -261,6 +294,10 @@ extern int main(int argc, char **argv)
 #endif
     }
 
+    ///- Stop accept new connections and wait for workers finish current command, not handled queued commands dropped
+    authAcceptor.close();
+    m_authWorkerPool.Stop();
+
     ///- Wait for the delay thread to exit
     dbRealmServer.HaltDelayThread();
 
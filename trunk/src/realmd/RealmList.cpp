@@ -24,12 +24,16 @@
 #include "RealmList.h"
 #include "Policies/SingletonImp.h"
 #include "Database/DatabaseEnv.h"
+#include "zthread/Guard.h"
 
 INSTANTIATE_SINGLETON_1( RealmList );
 
 extern DatabaseType dbRealmServer;
 
-RealmList::RealmList( ) : m_UpdateInterval(0), m_NextUpdateTime(time(NULL))
+// cached amounts of characters of account not used (logged in or realm list requested) for this time are removed
+#define ACCOUNT_CHARACTERS_CACHE_TIME (30*MINUTE)
+
+RealmList::RealmList( ) : m_UpdateInterval(0), m_NextUpdateTime(time(NULL)), m_NextCacheCleanupTime(time(NULL) + MINUTE)
 {
 }
 
@@ -39,13 +43,14 @@ void RealmList::Initialize(uint32 updateInterval)
     m_UpdateInterval = updateInterval;
 
     ///- Get the content of the realmlist table in the database
-    UpdateRealms(true);
+    UpdateRealms(m_realms, true);
+    BuildRealmListBody();
 }
 
-void RealmList::UpdateRealm( uint32 ID, std::string name, std::string address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu)
+void RealmList::UpdateRealm(RealmMap& realms, uint32 ID, std::string name, std::string address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu)
 {
     ///- Create new if not exist or update existed
-    Realm& realm = m_realms[name];
+    Realm& realm = realms[name];
 
     realm.m_ID      = ID;
     realm.name      = name;
@@ -63,20 +68,27 @@ void RealmList::UpdateRealm( uint32 ID, std::string name, std::string address, u
 
 void RealmList::UpdateIfNeed()
 {
+    if(m_NextCacheCleanupTime <= time(NULL))
+    {
+        m_NextCacheCleanupTime = time(NULL) + MINUTE;
+        RemoveUnusedAccountCharacters();
+    }
+
     // maybe disabled or updated recently
     if(!m_UpdateInterval || m_NextUpdateTime > time(NULL))
         return;
 
     m_NextUpdateTime = time(NULL) + m_UpdateInterval;
 
-    // Clears Realm list
-    m_realms.clear();
+    // Get the content of the realmlist table in the database, realm list requests use old body until rebuilt
+    RealmMap realms;
+    UpdateRealms(realms, false);
+    m_realms.swap(realms);
 
-    // Get the content of the realmlist table in the database
-    UpdateRealms(false);
+    BuildRealmListBody();
 }
 
-void RealmList::UpdateRealms(bool init)
+void RealmList::UpdateRealms(RealmMap& realms, bool init)
 {
     sLog.outDetail("Updating Realm List...");
 
@@ -91,10 +103,105 @@ void RealmList::UpdateRealms(bool init)
 
             uint8 allowedSecurityLevel = fields[7].GetUInt8();
 
-            UpdateRealm(fields[0].GetUInt32(), fields[1].GetCppString(),fields[2].GetCppString(),fields[3].GetUInt32(),fields[4].GetUInt8(), fields[5].GetUInt8(), fields[6].GetUInt8(), (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), fields[8].GetFloat() );
+            UpdateRealm(realms, fields[0].GetUInt32(), fields[1].GetCppString(),fields[2].GetCppString(),fields[3].GetUInt32(),fields[4].GetUInt8(), fields[5].GetUInt8(), fields[6].GetUInt8(), (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), fields[8].GetFloat() );
             if(init)
                 sLog.outString("Added realm \"%s\".", fields[1].GetString());
         } while( result->NextRow() );
         delete result;
     }
 }
+
+/// Serialize realms to realm list body, lock and amount of characters fields are filled per account
+void RealmList::BuildRealmListBody()
+{
+    ByteBuffer pkt;
+    std::vector<RealmListEntryPos> entries;
+    entries.reserve(m_realms.size());
+
+    pkt << (uint32) 0;
+    pkt << (uint16) m_realms.size();
+    for(RealmMap::const_iterator i = m_realms.begin(); i != m_realms.end(); ++i)
+    {
+        RealmListEntryPos entry;
+        entry.realmId = i->second.m_ID;
+        entry.allowedSecurityLevel = i->second.allowedSecurityLevel;
+
+        pkt << i->second.icon;                              // realm type
+        entry.lockPos = pkt.wpos();
+        pkt << (uint8) 0;                                   // if 1, then realm locked
+        pkt << i->second.color;                             // if 2, then realm is offline
+        pkt << i->first;
+        pkt << i->second.address;
+        pkt << i->second.populationLevel;
+        entry.charactersPos = pkt.wpos();
+        pkt << (uint8) 0;                                   // amount of characters
+        pkt << i->second.timezone;                          // realm category
+        pkt << (uint8) 0x2C;                                // unk, may be realm number/id?
+
+        entries.push_back(entry);
+    }
+    pkt << (uint8) 0x10;
+    pkt << (uint8) 0x00;
+
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+    m_realmListBody = pkt;
+    m_realmListEntries.swap(entries);
+}
+
+void RealmList::LoadAccountCharacters(uint32 accountId)
+{
+    AccountCharacters account;
+    account.lastUse = time(NULL);
+
+    QueryResult *result = dbRealmServer.PQuery("SELECT realmid, numchars FROM realmcharacters WHERE acctid = '%u'", accountId);
+    if(result)
+    {
+        do
+        {
+            Field *fields = result->Fetch();
+            account.characters[fields[0].GetUInt32()] = fields[1].GetUInt8();
+        } while( result->NextRow() );
+        delete result;
+    }
+
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+    m_accountCharacters[accountId] = account;
+}
+
+bool RealmList::BuildRealmListPacket(ByteBuffer& pkt, uint32 accountId, AccountTypes accountSecurityLevel)
+{
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    AccountCharactersMap::iterator account = m_accountCharacters.find(accountId);
+    if(account == m_accountCharacters.end())
+        return false;
+
+    account->second.lastUse = time(NULL);
+
+    pkt = m_realmListBody;
+    for(std::vector<RealmListEntryPos>::const_iterator i = m_realmListEntries.begin(); i != m_realmListEntries.end(); ++i)
+    {
+        uint8 lock = (i->allowedSecurityLevel > accountSecurityLevel) ? 1 : 0;
+        pkt.put<uint8>(i->lockPos, lock);
+
+        RealmCharacters::const_iterator chars = account->second.characters.find(i->realmId);
+        if(chars != account->second.characters.end())
+            pkt.put<uint8>(i->charactersPos, chars->second);
+    }
+    return true;
+}
+
+void RealmList::RemoveUnusedAccountCharacters()
+{
+    time_t expireTime = time(NULL) - ACCOUNT_CHARACTERS_CACHE_TIME;
+
+    ZThread::Guard<ZThread::FastMutex> guard(m_lock);
+
+    for(AccountCharactersMap::iterator i = m_accountCharacters.begin(); i != m_accountCharacters.end();)
+    {
+        if(i->second.lastUse < expireTime)
+            m_accountCharacters.erase(i++);
+        else
+            ++i;
+    }
+}
@@ -24,6 +24,8 @@
 #define _REALMLIST_H
 
 #include "Common.h"
+#include "ByteBuffer.h"
+#include "zthread/FastMutex.h"
 
 /// Storage object for a realm
 struct Realm
@@ -38,11 +40,35 @@ struct Realm
     float populationLevel;
 };
 
+/// Place of account dependent fields of a realm in prebuilt realm list body
+struct RealmListEntryPos
+{
+    uint32 realmId;
+    AccountTypes allowedSecurityLevel;
+    size_t lockPos;
+    size_t charactersPos;
+};
+
 /// Storage object for the list of realms on the server
+/**
+ * Realm list body is prebuilt at each realms update, and realm list requests only fill lock and
+ * amount of characters fields for the account. Amounts of characters are cached per account,
+ * loaded at login and expire when the account is not used for a while.
+ *
+ * Realms update runs in the main thread, built packets are requested by auth worker threads.
+ */
 class RealmList
 {
     public:
         typedef std::map<std::string, Realm> RealmMap;
+        typedef std::map<uint32, uint8> RealmCharacters;    // realm id -> amount of characters
+
+        struct AccountCharacters
+        {
+            RealmCharacters characters;
+            time_t lastUse;
+        };
+        typedef std::map<uint32, AccountCharacters> AccountCharactersMap;
 
         RealmList();
         ~RealmList() {}
@@ -54,13 +80,27 @@ class RealmList
         RealmMap::const_iterator begin() const { return m_realms.begin(); }
         RealmMap::const_iterator end() const { return m_realms.end(); }
         uint32 size() const { return m_realms.size(); }
+
+        /// Load amounts of characters of the account on realms (at login), replace cached
+        void LoadAccountCharacters(uint32 accountId);
+
+        /// Build realm list body for the account, false if its characters not cached
+        bool BuildRealmListPacket(ByteBuffer& pkt, uint32 accountId, AccountTypes accountSecurityLevel);
     private:
-        void UpdateRealms(bool init);
-        void UpdateRealm( uint32 ID, std::string name, std::string address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu);
+        void UpdateRealms(RealmMap& realms, bool init);
+        void UpdateRealm(RealmMap& realms, uint32 ID, std::string name, std::string address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu);
+        void BuildRealmListBody();
+        void RemoveUnusedAccountCharacters();
     private:
-        RealmMap m_realms;                                  ///< Internal map of realms
+        RealmMap m_realms;                                  ///< Internal map of realms, main thread only
         uint32   m_UpdateInterval;
         time_t   m_NextUpdateTime;
+        time_t   m_NextCacheCleanupTime;
+
+        ByteBuffer m_realmListBody;                         ///< Realm list body with empty account dependent fields
+        std::vector<RealmListEntryPos> m_realmListEntries;
+        AccountCharactersMap m_accountCharacters;
+        ZThread::FastMutex m_lock;                          ///< Guard built body and characters cache
 };
 #endif
 /// @}
@@ -575,6 +575,27 @@ public:
             }
         }
 
+        /** Appends all members that intersect the box.
+            Box only version, does not need a (not linked) Sphere. */
+        void getIntersectingMembers(
+            const AABox&        box,
+            Array<T>&           members) const {
+
+            for (int v = 0; v < boundsArray.size(); ++v) {
+                if (boundsArray[v].intersects(box)) {
+                    members.append(valueArray[v]->value);
+                }
+            }
+
+            if ((child[0] != NULL) && (box.low()[splitAxis] < splitLocation)) {
+                child[0]->getIntersectingMembers(box, members);
+            }
+
+            if ((child[1] != NULL) && (box.high()[splitAxis] > splitLocation)) {
+                child[1]->getIntersectingMembers(box, members);
+            }
+        }
+
         /**
          Recurse through the tree, assigning splitBounds fields.
          */
@@ -1423,7 +1444,7 @@ public:
         if (root == NULL) {
             return;
         }
-        root->getIntersectingMembers(box, Sphere(Vector3::zero(), 0), members, false);
+        root->getIntersectingMembers(box, members);
     }
 
 
@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "FlatBVH.h"
+#include "ModelContainer.h"
+
+#include <algorithm>
+
+#ifdef VMAP_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+using namespace G3D;
+
+namespace VMAP
+{
+    //=====================================================
+
+    struct FlatBVH::BuildTriangle
+    {
+        FlatBVHTriangle iTri;
+        Vector3 iLo;
+        Vector3 iHi;
+        Vector3 iCentroid;
+    };
+
+    struct CentroidLess
+    {
+        int iAxis;
+        CentroidLess(int pAxis) : iAxis(pAxis) {}
+        bool operator()(const FlatBVH::BuildTriangle& a, const FlatBVH::BuildTriangle& b) const;
+    };
+
+    //=====================================================
+
+    static bool isFinite(const Vector3& v)
+    {
+        return v.x < inf() && v.x > -inf() && v.y < inf() && v.y > -inf() && v.z < inf() && v.z > -inf();
+    }
+
+    //=====================================================
+
+    void FlatBVH::build(const ModelContainer& pContainer)
+    {
+        iNodes.clear();
+        iLeafs.clear();
+        iTriangles.clear();
+
+        BuildTriangleList tris;
+        for(unsigned int i=0; i<pContainer.getNSubModel(); ++i)
+        {
+            const SubModel& sm = pContainer.getSubModel(i);
+            const Vector3& base = sm.getBasePosition();
+            for(unsigned int j=0; j<sm.getNTriangles(); ++j)
+            {
+                const TriangleBox& tb = sm.getTriangle(j);
+                Vector3 v0 = tb.vertex(0).getVector3() + base;
+                Vector3 v1 = tb.vertex(1).getVector3() + base;
+                Vector3 v2 = tb.vertex(2).getVector3() + base;
+
+                // saturated fix point values can never be hit, don't let them blow up the bounds
+                if(!isFinite(v0) || !isFinite(v1) || !isFinite(v2))
+                    continue;
+
+                BuildTriangle bt;
+                Vector3 e1 = v1 - v0;
+                Vector3 e2 = v2 - v0;
+                for(int k=0; k<3; ++k)
+                {
+                    bt.iTri.iV0[k] = v0[k];
+                    bt.iTri.iE1[k] = e1[k];
+                    bt.iTri.iE2[k] = e2[k];
+                }
+                bt.iLo = v0.min(v1).min(v2);
+                bt.iHi = v0.max(v1).max(v2);
+                bt.iCentroid = (bt.iLo + bt.iHi) * 0.5f;
+                tris.push_back(bt);
+            }
+        }
+
+        if(tris.empty())
+            return;
+
+        buildNode(tris, 0, (int)tris.size(), 0);
+
+        for(size_t i=0; i<tris.size(); ++i)
+            iTriangles.append(tris[i].iTri);
+    }
+
+    //=====================================================
+    // split the range at the centroid median along the longest axis, return split position
+
+    int FlatBVH::splitRange(BuildTriangleList& pTris, int pStart, int pEnd)
+    {
+        Vector3 lo = pTris[pStart].iCentroid;
+        Vector3 hi = lo;
+        for(int i=pStart+1; i<pEnd; ++i)
+        {
+            lo = lo.min(pTris[i].iCentroid);
+            hi = hi.max(pTris[i].iCentroid);
+        }
+        Vector3 extent = hi - lo;
+        int axis = 0;
+        if(extent.y > extent[axis]) axis = 1;
+        if(extent.z > extent[axis]) axis = 2;
+
+        int mid = pStart + (pEnd - pStart) / 2;
+        std::nth_element(pTris.begin() + pStart, pTris.begin() + mid, pTris.begin() + pEnd, CentroidLess(axis));
+        return mid;
+    }
+
+    //=====================================================
+
+    int FlatBVH::buildChild(BuildTriangleList& pTris, int pStart, int pEnd, int pDepth, FlatBVHNode& pNode, int pSlot)
+    {
+        Vector3 lo = pTris[pStart].iLo;
+        Vector3 hi = pTris[pStart].iHi;
+        for(int i=pStart+1; i<pEnd; ++i)
+        {
+            lo = lo.min(pTris[i].iLo);
+            hi = hi.max(pTris[i].iHi);
+        }
+        pNode.iMinX[pSlot] = lo.x; pNode.iMinY[pSlot] = lo.y; pNode.iMinZ[pSlot] = lo.z;
+        pNode.iMaxX[pSlot] = hi.x; pNode.iMaxY[pSlot] = hi.y; pNode.iMaxZ[pSlot] = hi.z;
+
+        if(pEnd - pStart <= FLATBVH_LEAF_SIZE || pDepth >= FLATBVH_MAX_DEPTH-1)
+        {
+            FlatBVHLeaf leaf;
+            leaf.iStart = pStart;
+            leaf.iCount = pEnd - pStart;
+            iLeafs.append(leaf);
+            return ~(iLeafs.size()-1);
+        }
+        return buildNode(pTris, pStart, pEnd, pDepth+1);
+    }
+
+    //=====================================================
+    // nodes are stored in depth first order, so a parent is always in front of its children
+
+    int FlatBVH::buildNode(BuildTriangleList& pTris, int pStart, int pEnd, int pDepth)
+    {
+        int nodeIndex = iNodes.size();
+        iNodes.resize(nodeIndex+1);
+
+        FlatBVHNode node;
+        for(int i=0; i<FLATBVH_WIDTH; ++i)
+        {
+            node.iChild[i] = FLATBVH_EMPTY_CHILD;
+            node.iMinX[i] = node.iMinY[i] = node.iMinZ[i] = inf();
+            node.iMaxX[i] = node.iMaxY[i] = node.iMaxZ[i] = -inf();
+        }
+
+        int ranges[FLATBVH_WIDTH+1];
+        int nRanges = 1;
+        ranges[0] = pStart;
+        ranges[1] = pEnd;
+
+        // binary split the biggest range until we have 4 ranges or all are small enough for leafs
+        while(nRanges < FLATBVH_WIDTH)
+        {
+            int biggest = -1;
+            for(int i=0; i<nRanges; ++i)
+                if(ranges[i+1] - ranges[i] > FLATBVH_LEAF_SIZE && (biggest < 0 || ranges[i+1] - ranges[i] > ranges[biggest+1] - ranges[biggest]))
+                    biggest = i;
+            if(biggest < 0)
+                break;
+
+            int split = splitRange(pTris, ranges[biggest], ranges[biggest+1]);
+            for(int i=nRanges; i>biggest; --i)
+                ranges[i+1] = ranges[i];
+            ranges[biggest+1] = split;
+            ++nRanges;
+        }
+
+        for(int i=0; i<nRanges; ++i)
+            node.iChild[i] = buildChild(pTris, ranges[i], ranges[i+1], pDepth, node, i);
+
+        iNodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    //=====================================================
+    // two sided Moeller-Trumbore test against all triangles of a leaf
+
+    bool FlatBVH::intersectLeaf(const FlatBVHLeaf& pLeaf, const Vector3& pOrigin, const Vector3& pDir, float& pMaxDist, bool pStopAtFirstHit) const
+    {
+        bool hit = false;
+        for(unsigned int i=pLeaf.iStart; i<pLeaf.iStart+pLeaf.iCount; ++i)
+        {
+            const FlatBVHTriangle& tri = iTriangles[i];
+            const Vector3 e1(tri.iE1[0], tri.iE1[1], tri.iE1[2]);
+            const Vector3 e2(tri.iE2[0], tri.iE2[1], tri.iE2[2]);
+
+            Vector3 p = pDir.cross(e2);
+            float det = e1.dot(p);
+            if(det > -1e-12f && det < 1e-12f)
+                continue;
+            float invDet = 1.0f / det;
+
+            Vector3 s = pOrigin - Vector3(tri.iV0[0], tri.iV0[1], tri.iV0[2]);
+            float u = s.dot(p) * invDet;
+            if(u < 0.0f || u > 1.0f)
+                continue;
+
+            Vector3 q = s.cross(e1);
+            float v = pDir.dot(q) * invDet;
+            if(v < 0.0f || u + v > 1.0f)
+                continue;
+
+            float t = e2.dot(q) * invDet;
+            if(t > 0.0f && t < pMaxDist)
+            {
+                pMaxDist = t;
+                hit = true;
+                if(pStopAtFirstHit)
+                    return true;
+            }
+        }
+        return hit;
+    }
+
+    //=====================================================
+
+    void FlatBVH::intersectRay(const Ray& pRay, float& pMaxDist, bool pStopAtFirstHit) const
+    {
+        if(iNodes.size() == 0)
+            return;
+
+        const Vector3& origin = pRay.origin;
+        const Vector3& dir = pRay.direction;
+
+        // avoid 0*inf in the slab test
+        float invDir[3];
+        for(int i=0; i<3; ++i)
+        {
+            float d = dir[i];
+            if(d > -1e-20f && d < 1e-20f)
+                d = d < 0.0f ? -1e-20f : 1e-20f;
+            invDir[i] = 1.0f / d;
+        }
+
+        int stack[FLATBVH_MAX_DEPTH * (FLATBVH_WIDTH-1) + 1];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+#ifdef VMAP_USE_SSE
+        const __m128 ox = _mm_set1_ps(origin.x);
+        const __m128 oy = _mm_set1_ps(origin.y);
+        const __m128 oz = _mm_set1_ps(origin.z);
+        const __m128 idx = _mm_set1_ps(invDir[0]);
+        const __m128 idy = _mm_set1_ps(invDir[1]);
+        const __m128 idz = _mm_set1_ps(invDir[2]);
+        const __m128 zero = _mm_setzero_ps();
+#endif
+
+        while(stackSize > 0)
+        {
+            const FlatBVHNode& node = iNodes[stack[--stackSize]];
+
+            int mask;
+#ifdef VMAP_USE_SSE
+            {
+                __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.iMinX), ox), idx);
+                __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.iMaxX), ox), idx);
+                __m128 tmin = _mm_min_ps(t0, t1);
+                __m128 tmax = _mm_max_ps(t0, t1);
+
+                t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.iMinY), oy), idy);
+                t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.iMaxY), oy), idy);
+                tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+                tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+
+                t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.iMinZ), oz), idz);
+                t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.iMaxZ), oz), idz);
+                tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+                tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+
+                tmin = _mm_max_ps(tmin, zero);
+                tmax = _mm_min_ps(tmax, _mm_set1_ps(pMaxDist));
+                mask = _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+            }
+#else
+            mask = 0;
+            for(int i=0; i<FLATBVH_WIDTH; ++i)
+            {
+                float t0 = (node.iMinX[i] - origin.x) * invDir[0];
+                float t1 = (node.iMaxX[i] - origin.x) * invDir[0];
+                float tmin = t0 < t1 ? t0 : t1;
+                float tmax = t0 < t1 ? t1 : t0;
+
+                t0 = (node.iMinY[i] - origin.y) * invDir[1];
+                t1 = (node.iMaxY[i] - origin.y) * invDir[1];
+                tmin = std::max(tmin, t0 < t1 ? t0 : t1);
+                tmax = std::min(tmax, t0 < t1 ? t1 : t0);
+
+                t0 = (node.iMinZ[i] - origin.z) * invDir[2];
+                t1 = (node.iMaxZ[i] - origin.z) * invDir[2];
+                tmin = std::max(tmin, t0 < t1 ? t0 : t1);
+                tmax = std::min(tmax, t0 < t1 ? t1 : t0);
+
+                if(std::max(tmin, 0.0f) <= std::min(tmax, pMaxDist))
+                    mask |= 1 << i;
+            }
+#endif
+
+            for(int i=0; i<FLATBVH_WIDTH; ++i)
+            {
+                if(!(mask & (1 << i)))
+                    continue;
+
+                int child = node.iChild[i];
+                if(child == FLATBVH_EMPTY_CHILD)
+                    continue;
+
+                if(child >= 0)
+                    stack[stackSize++] = child;
+                else if(intersectLeaf(iLeafs[~child], origin, dir, pMaxDist, pStopAtFirstHit) && pStopAtFirstHit)
+                    return;
+            }
+        }
+    }
+
+    //=====================================================
+
+    bool FlatBVH::writeChunk(FILE* wf) const
+    {
+        bool result = true;
+        unsigned int size = 3*sizeof(unsigned int) + iNodes.size()*sizeof(FlatBVHNode) + iLeafs.size()*sizeof(FlatBVHLeaf) + iTriangles.size()*sizeof(FlatBVHTriangle);
+        unsigned int val;
+
+        if(result && fwrite("BVH4",4,1,wf) != 1) result = false;
+        if(result && fwrite(&size,4,1,wf) != 1) result = false;
+
+        val = iNodes.size();
+        if(result && fwrite(&val,sizeof(unsigned int),1,wf) != 1) result = false;
+        if(result && val && fwrite(iNodes.getCArray(),sizeof(FlatBVHNode),val,wf) != val) result = false;
+
+        val = iLeafs.size();
+        if(result && fwrite(&val,sizeof(unsigned int),1,wf) != 1) result = false;
+        if(result && val && fwrite(iLeafs.getCArray(),sizeof(FlatBVHLeaf),val,wf) != val) result = false;
+
+        val = iTriangles.size();
+        if(result && fwrite(&val,sizeof(unsigned int),1,wf) != 1) result = false;
+        if(result && val && fwrite(iTriangles.getCArray(),sizeof(FlatBVHTriangle),val,wf) != val) result = false;
+
+        return result;
+    }
+
+    //=====================================================
+    // the chunk ident and size are already read by the caller
+
+    bool FlatBVH::readChunk(FILE* rf)
+    {
+        bool result = true;
+        unsigned int val;
+
+        if(result && fread(&val,sizeof(unsigned int),1,rf) != 1) result = false;
+        if(result) iNodes.resize(val);
+        if(result && val && fread(iNodes.getCArray(),sizeof(FlatBVHNode),val,rf) != val) result = false;
+
+        if(result && fread(&val,sizeof(unsigned int),1,rf) != 1) result = false;
+        if(result) iLeafs.resize(val);
+        if(result && val && fread(iLeafs.getCArray(),sizeof(FlatBVHLeaf),val,rf) != val) result = false;
+
+        if(result && fread(&val,sizeof(unsigned int),1,rf) != 1) result = false;
+        if(result) iTriangles.resize(val);
+        if(result && val && fread(iTriangles.getCArray(),sizeof(FlatBVHTriangle),val,rf) != val) result = false;
+
+        if(!result)
+        {
+            iNodes.clear();
+            iLeafs.clear();
+            iTriangles.clear();
+        }
+        return result;
+    }
+
+    //=====================================================
+
+    size_t FlatBVH::getMemUsage() const
+    {
+        return iNodes.size()*sizeof(FlatBVHNode) + iLeafs.size()*sizeof(FlatBVHLeaf) + iTriangles.size()*sizeof(FlatBVHTriangle) + sizeof(FlatBVH);
+    }
+
+    //=====================================================
+
+    bool CentroidLess::operator()(const FlatBVH::BuildTriangle& a, const FlatBVH::BuildTriangle& b) const
+    {
+        return a.iCentroid[iAxis] < b.iCentroid[iAxis];
+    }
+}
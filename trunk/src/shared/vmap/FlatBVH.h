@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2005-2008 MaNGOS <http://www.mangosproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _FLATBVH_H
+#define _FLATBVH_H
+
+#include <G3D/Vector3.h>
+#include <G3D/Ray.h>
+#include <G3D/Array.h>
+
+#include <stdio.h>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define VMAP_USE_SSE
+#endif
+
+namespace VMAP
+{
+    class ModelContainer;
+
+    /**
+    A 4-wide bounding volume hierarchy over all triangles of one ModelContainer.
+    Nodes, leaf ranges and triangles are stored in three contiguous arrays that are written and read
+    as binary blocks (chunk "BVH4" at the end of the .vmap file). Triangles are stored in absolute
+    coordinates, so no per SubModel base position handling is needed while traversing.
+    The child boxes of a node are stored as structure of arrays and tested against a ray at once (SSE if available).
+    */
+
+    //=====================================================
+
+    #define FLATBVH_WIDTH       4
+    #define FLATBVH_LEAF_SIZE   4
+    #define FLATBVH_MAX_DEPTH   64
+
+    // child reference: >= 0 inner node index, FLATBVH_EMPTY_CHILD unused slot, otherwise ~leafIndex
+    #define FLATBVH_EMPTY_CHILD ((int)0x80000000)
+
+    struct FlatBVHNode
+    {
+        float iMinX[FLATBVH_WIDTH];
+        float iMinY[FLATBVH_WIDTH];
+        float iMinZ[FLATBVH_WIDTH];
+        float iMaxX[FLATBVH_WIDTH];
+        float iMaxY[FLATBVH_WIDTH];
+        float iMaxZ[FLATBVH_WIDTH];
+        int iChild[FLATBVH_WIDTH];
+    };
+
+    struct FlatBVHLeaf
+    {
+        unsigned int iStart;
+        unsigned int iCount;
+    };
+
+    // vertex 0 and the two edges to vertex 1 and 2, ready for the Moeller-Trumbore test
+    struct FlatBVHTriangle
+    {
+        float iV0[3];
+        float iE1[3];
+        float iE2[3];
+    };
+
+    //=====================================================
+
+    class FlatBVH
+    {
+        public:
+            // triangle with its bounds, used only while building
+            struct BuildTriangle;
+        private:
+            G3D::Array<FlatBVHNode> iNodes;
+            G3D::Array<FlatBVHLeaf> iLeafs;
+            G3D::Array<FlatBVHTriangle> iTriangles;
+
+            typedef std::vector<BuildTriangle> BuildTriangleList;
+
+            int buildNode(BuildTriangleList& pTris, int pStart, int pEnd, int pDepth);
+            int buildChild(BuildTriangleList& pTris, int pStart, int pEnd, int pDepth, FlatBVHNode& pNode, int pSlot);
+            int splitRange(BuildTriangleList& pTris, int pStart, int pEnd);
+
+            bool intersectLeaf(const FlatBVHLeaf& pLeaf, const G3D::Vector3& pOrigin, const G3D::Vector3& pDir, float& pMaxDist, bool pStopAtFirstHit) const;
+        public:
+            FlatBVH() {}
+
+            /** collect all triangles of the container (in absolute coordinates) and build the tree */
+            void build(const ModelContainer& pContainer);
+
+            bool isEmpty() const { return iNodes.size() == 0; }
+
+            /** same semantic as ModelContainer::intersect: pMaxDist is reduced to the distance of the (first/closest) hit */
+            void intersectRay(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit) const;
+
+            bool writeChunk(FILE* wf) const;
+            bool readChunk(FILE* rf);
+
+            size_t getMemUsage() const;
+    };
+}
+#endif
@@ -40,6 +40,17 @@ namespace VMAP
     #define VMAP_INVALID_HEIGHT       -100000.0f            // for check
     #define VMAP_INVALID_HEIGHT_VALUE -200000.0f            // real assigned value in unknown height case
 
+    //===========================================================
+    /**
+    One line of sight test of a batch query, result is filled by the query.
+    */
+    struct LineOfSightQuery
+    {
+        float x1, y1, z1;
+        float x2, y2, z2;
+        bool result;
+    };
+
     //===========================================================
     class IVMapManager
     {
@@ -62,6 +73,11 @@ namespace VMAP
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z) = 0;
             /**
+            Batch version of isInLineOfSight for many queries on the same map.
+            The map tree is looked up once and the tree is traversed once for the bounds of all queries.
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, LineOfSightQuery* pQueries, unsigned int pCount) = 0;
+            /**
             test if we hit an object. return true if we hit one. rx,ry,rz will hold the hit position or the dest position, if no intersection was found
             return a position, that is pReduceDist closer to the origin
             */
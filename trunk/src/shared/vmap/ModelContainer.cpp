@@ -28,6 +28,8 @@ using namespace G3D;
 
 namespace VMAP
 {
+    bool ModelContainer::iUseFlatTree = true;
+
     //==========================================================
     /**
     Functions to use ModelContainer with a AABSPTree
@@ -44,6 +46,7 @@ namespace VMAP
 
         iNSubModel = pNSubModel;
         iSubModel = 0;
+        iFlatTree = 0;
         if(pNSubModel > 0) iSubModel = new SubModel[iNSubModel];
     }
 
@@ -161,6 +164,7 @@ namespace VMAP
         iNSubModel = nSubModels;
 
         iSubModel = new SubModel[iNSubModel];
+        iFlatTree = 0;
 
         int subModelPos,treeNodePos, trianglePos;
         subModelPos = treeNodePos = trianglePos = 0;
@@ -181,6 +185,21 @@ namespace VMAP
     {
         free();
         if(iSubModel != 0) delete [] iSubModel;
+        delete iFlatTree;
+    }
+
+    //==========================================================
+
+    void ModelContainer::buildFlatTree()
+    {
+        delete iFlatTree;
+        iFlatTree = new FlatBVH();
+        iFlatTree->build(*this);
+        if(iFlatTree->isEmpty())
+        {
+            delete iFlatTree;
+            iFlatTree = 0;
+        }
     }
     //==========================================================
 
@@ -232,6 +251,9 @@ namespace VMAP
             if(result && fwrite(&iNSubModel,sizeof(unsigned int),1,wf) != 1) result = false;
             if(result && fwrite(iSubModel,sizeof(SubModel),iNSubModel,wf) != iNSubModel) result = false;
 
+            // optional, older readers stop after SUBM
+            if(result && iFlatTree && !iFlatTree->writeChunk(wf)) result = false;
+
             fclose(wf);
         }
 
@@ -252,6 +274,8 @@ namespace VMAP
         if(rf)
         {
             free();
+            delete iFlatTree;
+            iFlatTree = 0;
 
             result = true;
             char magic[8];                          // Ignore the added magic header
@@ -310,6 +334,17 @@ namespace VMAP
                     iSubModel[i].setTreeNodeArray(getTreeNodes());
                 }
             }
+
+            //---- optional flattened BVH
+            if(result && fread(chunk,4,1,rf) == 1 && !strncmp(chunk,"BVH4",4) && fread(&size,4,1,rf) == 1)
+            {
+                iFlatTree = new FlatBVH();
+                if(!iFlatTree->readChunk(rf) || iFlatTree->isEmpty())
+                {
+                    delete iFlatTree;
+                    iFlatTree = 0;
+                }
+            }
             fclose(rf);
         }
         return result;
@@ -320,7 +355,7 @@ namespace VMAP
     size_t ModelContainer::getMemUsage()
     {
                                                             // BaseModel is included in ModelContainer
-        return(iNSubModel * sizeof(SubModel) + BaseModel::getMemUsage() + sizeof(ModelContainer) - sizeof(BaseModel));
+        return(iNSubModel * sizeof(SubModel) + BaseModel::getMemUsage() + sizeof(ModelContainer) - sizeof(BaseModel) + (iFlatTree ? iFlatTree->getMemUsage() : 0));
     }
 
     //=================================================================
@@ -335,6 +370,12 @@ namespace VMAP
 
     void ModelContainer::intersect(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit, G3D::Vector3& /*pOutLocation*/, G3D::Vector3& /*pOutNormal*/) const
     {
+        if(iFlatTree && iUseFlatTree)
+        {
+            iFlatTree->intersectRay(pRay, pMaxDist, pStopAtFirstHit);
+            return;
+        }
+
         IntersectionCallBack<SubModel> intersectCallback;
         NodeValueAccess<TreeNode, SubModel> vna = NodeValueAccess<TreeNode, SubModel>(getTreeNodes(), iSubModel);
         Ray relativeRay = Ray::fromOriginAndDirection(pRay.origin - getBasePosition(), pRay.direction);
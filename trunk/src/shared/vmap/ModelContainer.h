@@ -31,6 +31,7 @@
 #include "VMapTools.h"
 #include "SubModel.h"
 #include "BaseModel.h"
+#include "FlatBVH.h"
 
 namespace VMAP
 {
@@ -41,6 +42,7 @@ namespace VMAP
     The tree nodes are used for the BSP-Tree of SubModels as well as for the BSP-Tree of triangles within one SubModel.
     The references are done by indexes within these static arrays.
     Therefore we are able to just load a binary block and do not need to mess around with memory allocation and pointers.
+    If the file contains a flattened BVH of all triangles (created by the TileAssembler) it is used for the ray queries instead.
     */
 
     //=====================================================
@@ -51,12 +53,15 @@ namespace VMAP
             unsigned int iNSubModel;
             SubModel *iSubModel;
             G3D::AABox iBox;
+            FlatBVH* iFlatTree;
+
+            static bool iUseFlatTree;
 
             ModelContainer (const ModelContainer& c): BaseModel(c) {}
             ModelContainer& operator=(const ModelContainer& ) {}
 
         public:
-            ModelContainer() : BaseModel() { iNSubModel =0; iSubModel = 0; };
+            ModelContainer() : BaseModel() { iNSubModel =0; iSubModel = 0; iFlatTree = 0; };
 
             // for the mainnode
             ModelContainer(unsigned int pNTriangles, unsigned int pNNodes, unsigned int pNSubModel);
@@ -83,6 +88,14 @@ namespace VMAP
 
             bool writeFile(const char *filename);
 
+            // create the flattened BVH, it is stored by writeFile()
+            void buildFlatTree();
+            bool hasFlatTree() const { return iFlatTree != 0; }
+
+            // use the flattened BVH if loaded (default), used for benchmarking the old BSP-Tree
+            static void setUseFlatTree(bool pValue) { iUseFlatTree = pValue; }
+            static bool isUseFlatTree() { return iUseFlatTree; }
+
             bool readFile(const char *filename);
 
             size_t getMemUsage();
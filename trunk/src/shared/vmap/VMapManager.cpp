@@ -19,6 +19,10 @@
 #include "VMapManager.h"
 #include "VMapDefinitions.h"
 
+#ifdef VMAP_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 using namespace G3D;
 
 namespace VMAP
@@ -472,6 +476,51 @@ namespace VMAP
         return(height);
     }
 
+    //=========================================================
+
+    void VMapManager::isInLineOfSight(unsigned int pMapId, LineOfSightQuery* pQueries, unsigned int pCount)
+    {
+        for(unsigned int i=0; i<pCount; ++i)
+            pQueries[i].result = true;
+
+        if(pCount == 0 || !isLineOfSightCalcEnabled() || !iInstanceMapTrees.containsKey(pMapId))
+            return;
+
+        MapTree* mapTree = iInstanceMapTrees.get(pMapId);
+
+        Array<Vector3> pos1, pos2;
+        Array<unsigned int> index;
+        for(unsigned int i=0; i<pCount; ++i)
+        {
+            Vector3 p1 = convertPositionToInternalRep(pQueries[i].x1, pQueries[i].y1, pQueries[i].z1);
+            Vector3 p2 = convertPositionToInternalRep(pQueries[i].x2, pQueries[i].y2, pQueries[i].z2);
+            if(p1 != p2)
+            {
+                pos1.append(p1);
+                pos2.append(p2);
+                index.append(i);
+            }
+        }
+
+        if(index.size() == 0)
+            return;
+
+        Array<bool> results;
+        results.resize(index.size());
+        mapTree->isInLineOfSight(pos1.getCArray(), pos2.getCArray(), results.getCArray(), index.size());
+
+        for(int i=0; i<index.size(); ++i)
+        {
+            LineOfSightQuery& q = pQueries[index[i]];
+            q.result = results[i];
+#ifdef _VMAP_LOG_DEBUG
+            Command c = Command();
+            c.fillTestVisCmd(pMapId,Vector3(q.x1,q.y1,q.z1),Vector3(q.x2,q.y2,q.z2),q.result);
+            iCommandLogger.appendCmd(c);
+#endif
+        }
+    }
+
     //=========================================================
     /**
     used for debugging
@@ -648,6 +697,171 @@ namespace VMAP
         return(height);
     }
 
+    //=========================================================
+    // Batch queries: the tree is traversed once for the bounds of all rays, then the rays are tested
+    // in packets of 4 against the bounding boxes of the found ModelContainers and only the rays that
+    // hit a box are traced through the container.
+
+    #define RAY_PACKET_SIZE 4
+
+    struct RayPacket
+    {
+        float iOrgX[RAY_PACKET_SIZE], iOrgY[RAY_PACKET_SIZE], iOrgZ[RAY_PACKET_SIZE];
+        float iInvDirX[RAY_PACKET_SIZE], iInvDirY[RAY_PACKET_SIZE], iInvDirZ[RAY_PACKET_SIZE];
+        float iMaxDist[RAY_PACKET_SIZE];
+    };
+
+    static float safeInverse(float d)
+    {
+        // avoid 0*inf in the slab test
+        if(d > -1e-20f && d < 1e-20f)
+            d = d < 0.0f ? -1e-20f : 1e-20f;
+        return 1.0f / d;
+    }
+
+    // bit i set if ray i of the packet can hit the box within its max dist
+    static int rayPacketBoxMask(const RayPacket& pPacket, const AABox& pBox)
+    {
+        const Vector3& lo = pBox.low();
+        const Vector3& hi = pBox.high();
+#ifdef VMAP_USE_SSE
+        __m128 ox = _mm_loadu_ps(pPacket.iOrgX);
+        __m128 idx = _mm_loadu_ps(pPacket.iInvDirX);
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(lo.x), ox), idx);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(hi.x), ox), idx);
+        __m128 tmin = _mm_min_ps(t0, t1);
+        __m128 tmax = _mm_max_ps(t0, t1);
+
+        __m128 oy = _mm_loadu_ps(pPacket.iOrgY);
+        __m128 idy = _mm_loadu_ps(pPacket.iInvDirY);
+        t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(lo.y), oy), idy);
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(hi.y), oy), idy);
+        tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+        tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+
+        __m128 oz = _mm_loadu_ps(pPacket.iOrgZ);
+        __m128 idz = _mm_loadu_ps(pPacket.iInvDirZ);
+        t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(lo.z), oz), idz);
+        t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(hi.z), oz), idz);
+        tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+        tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+
+        tmin = _mm_max_ps(tmin, _mm_setzero_ps());
+        tmax = _mm_min_ps(tmax, _mm_loadu_ps(pPacket.iMaxDist));
+        return _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+#else
+        int mask = 0;
+        for(int i=0; i<RAY_PACKET_SIZE; ++i)
+        {
+            float t0 = (lo.x - pPacket.iOrgX[i]) * pPacket.iInvDirX[i];
+            float t1 = (hi.x - pPacket.iOrgX[i]) * pPacket.iInvDirX[i];
+            float tmin = t0 < t1 ? t0 : t1;
+            float tmax = t0 < t1 ? t1 : t0;
+
+            t0 = (lo.y - pPacket.iOrgY[i]) * pPacket.iInvDirY[i];
+            t1 = (hi.y - pPacket.iOrgY[i]) * pPacket.iInvDirY[i];
+            tmin = G3D::max(tmin, t0 < t1 ? t0 : t1);
+            tmax = G3D::min(tmax, t0 < t1 ? t1 : t0);
+
+            t0 = (lo.z - pPacket.iOrgZ[i]) * pPacket.iInvDirZ[i];
+            t1 = (hi.z - pPacket.iOrgZ[i]) * pPacket.iInvDirZ[i];
+            tmin = G3D::max(tmin, t0 < t1 ? t0 : t1);
+            tmax = G3D::min(tmax, t0 < t1 ? t1 : t0);
+
+            if(G3D::max(tmin, 0.0f) <= G3D::min(tmax, pPacket.iMaxDist[i]))
+                mask |= 1 << i;
+        }
+        return mask;
+#endif
+    }
+
+    //=========================================================
+    /**
+    pDists holds the max distance of each ray and is reduced to the distance of the (first/closest) hit
+    */
+    void MapTree::getIntersectionTimes(const Ray* pRays, float* pDists, unsigned int pCount, bool pStopAtFirstHit)
+    {
+        if(pCount == 0)
+            return;
+
+        Vector3 lo = pRays[0].origin;
+        Vector3 hi = pRays[0].origin;
+        for(unsigned int i=0; i<pCount; ++i)
+        {
+            Vector3 end = pRays[i].origin + pRays[i].direction * pDists[i];
+            lo = lo.min(pRays[i].origin.min(end));
+            hi = hi.max(pRays[i].origin.max(end));
+        }
+
+        Array<ModelContainer *> containers;
+        iTree->getIntersectingMembers(AABox(lo, hi), containers);
+        if(containers.size() == 0)
+            return;
+
+        IntersectionCallBack<ModelContainer> intersectionCallBack;
+        for(unsigned int start=0; start<pCount; start+=RAY_PACKET_SIZE)
+        {
+            unsigned int count = G3D::min((unsigned int)RAY_PACKET_SIZE, pCount - start);
+            int active = (1 << count) - 1;
+
+            RayPacket packet;
+            for(unsigned int i=0; i<RAY_PACKET_SIZE; ++i)
+            {
+                // unused lanes repeat the first ray, they are masked out by active
+                const Ray& ray = pRays[start + (i < count ? i : 0)];
+                packet.iOrgX[i] = ray.origin.x;
+                packet.iOrgY[i] = ray.origin.y;
+                packet.iOrgZ[i] = ray.origin.z;
+                packet.iInvDirX[i] = safeInverse(ray.direction.x);
+                packet.iInvDirY[i] = safeInverse(ray.direction.y);
+                packet.iInvDirZ[i] = safeInverse(ray.direction.z);
+                packet.iMaxDist[i] = pDists[start + (i < count ? i : 0)];
+            }
+
+            for(int c=0; c<containers.size() && active; ++c)
+            {
+                int mask = rayPacketBoxMask(packet, containers[c]->getAABoxBounds()) & active;
+                for(unsigned int i=0; mask && i<count; ++i)
+                {
+                    if(!(mask & (1 << i)))
+                        continue;
+                    mask &= ~(1 << i);
+
+                    float t = pDists[start + i];
+                    intersectionCallBack(pRays[start + i], containers[c], pStopAtFirstHit, t);
+                    if(t > 0 && t < pDists[start + i])
+                    {
+                        pDists[start + i] = t;
+                        packet.iMaxDist[i] = t;
+                        if(pStopAtFirstHit)
+                            active &= ~(1 << i);
+                    }
+                }
+            }
+        }
+    }
+
+    //=========================================================
+
+    void MapTree::isInLineOfSight(const Vector3* pPos1, const Vector3* pPos2, bool* pResults, unsigned int pCount)
+    {
+        Array<Ray> rays;
+        Array<float> dists, maxDists;
+        rays.resize(pCount);
+        dists.resize(pCount);
+        maxDists.resize(pCount);
+        for(unsigned int i=0; i<pCount; ++i)
+        {
+            maxDists[i] = dists[i] = abs((pPos2[i] - pPos1[i]).magnitude());
+            rays[i] = Ray::fromOriginAndDirection(pPos1[i], (pPos2[i] - pPos1[i])/maxDists[i]);
+        }
+
+        getIntersectionTimes(rays.getCArray(), dists.getCArray(), pCount, true);
+
+        for(unsigned int i=0; i<pCount; ++i)
+            pResults[i] = !(dists[i] < maxDists[i]);
+    }
+
     //=========================================================
 
     bool MapTree::PrepareTree()
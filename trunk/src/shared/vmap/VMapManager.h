@@ -88,6 +88,7 @@ namespace VMAP
 
         private:
             float getIntersectionTime(const G3D::Ray& pRay, float pMaxDist, bool pStopAtFirstHit);
+            void getIntersectionTimes(const G3D::Ray* pRays, float* pDists, unsigned int pCount, bool pStopAtFirstHit);
             bool isAlreadyLoaded(const std::string& pName) { return(iLoadedModelContainer.containsKey(pName)); }
             void setLoadedMapTile(unsigned int pTileIdent) { iLoadedMapTiles.set(pTileIdent, true); }
             void removeLoadedMapTile(unsigned int pTileIdent) { iLoadedMapTiles.remove(pTileIdent); }
@@ -104,6 +105,7 @@ namespace VMAP
             bool isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2);
             bool getObjectHitPos(const G3D::Vector3& pos1, const G3D::Vector3& pos2, G3D::Vector3& pResultHitPos, float pModifyDist);
             float getHeight(const G3D::Vector3& pPos);
+            void isInLineOfSight(const G3D::Vector3* pPos1, const G3D::Vector3* pPos2, bool* pResults, unsigned int pCount);
 
             bool PrepareTree();
             bool loadMap(const std::string& pDirFileName, unsigned int pMapTileIdent);
@@ -165,6 +167,8 @@ namespace VMAP
             bool getObjectHitPos(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float pModifyDist);
             float getHeight(unsigned int pMapId, float x, float y, float z);
 
+            void isInLineOfSight(unsigned int pMapId, LineOfSightQuery* pQueries, unsigned int pCount);
+
             bool processCommand(char *pCommand);            // for debug and extensions
 
             void preventMapsFromBeingUsed(const char* pMapIdString);